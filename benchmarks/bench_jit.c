@@ -0,0 +1,99 @@
+/**
+ * @file bench_jit.c
+ * @brief Compiled kernels against iirdsp_process_buffer()
+ *
+ * Streams one channel through Butterworth low-pass cascades of 1 to 8
+ * sections with iirdsp_process_buffer() and with the JIT kernel for the
+ * host (and, where available, the SSE2 and FMA variants), and reports
+ * samples per second.
+ *
+ * Usage: bench_jit [samples]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "iirdsp.h"
+#include "jit.h"
+
+#define FS 50000.0
+#define CHUNK 4096
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double rate(iirdsp_process_fn fn, const iirdsp_filter_t* proto, const iirdsp_real* x,
+                   iirdsp_real* y, int N, iirdsp_real* checksum)
+{
+    iirdsp_filter_t f = *proto;
+    double t0 = now_seconds();
+
+    for (int n = 0; n < N; n += CHUNK) {
+        fn(&f, x + n, y + n, N - n < CHUNK ? N - n : CHUNK);
+    }
+    *checksum += y[N - 1];
+    return N / (now_seconds() - t0) * 1e-6;
+}
+
+int main(int argc, char** argv)
+{
+    static const unsigned variants[] = { 0, IIRDSP_JIT_NO_AVX, IIRDSP_JIT_FMA };
+    int N = argc > 1 ? atoi(argv[1]) : 5000000;
+    iirdsp_real* x;
+    iirdsp_real* y;
+    iirdsp_real checksum = 0.0;
+
+    if (N <= 0) {
+        fprintf(stderr, "usage: bench_jit [samples]\n");
+        return 1;
+    }
+    x = (iirdsp_real*)malloc((size_t)N * sizeof(iirdsp_real));
+    y = (iirdsp_real*)malloc((size_t)N * sizeof(iirdsp_real));
+    if (x == NULL || y == NULL) {
+        return 1;
+    }
+    for (int n = 0; n < N; n++) {
+        x[n] = (iirdsp_real)(sin(0.003 * n) + 0.1 * sin(1.3 * n));
+    }
+
+    printf("%d samples, Msamples/s\n", N);
+    printf("%9s %14s", "sections", "process_buffer");
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        iirdsp_filter_t f;
+        iirdsp_jit_t* j;
+
+        butter_lowpass_init(&f, 2, 1000.0, FS);
+        j = iirdsp_jit_create(&f, variants[v]);
+        printf(" %10s", j != NULL ? iirdsp_jit_isa(j) : "-");
+        iirdsp_jit_destroy(j);
+    }
+    printf("\n");
+
+    for (int s = 1; s <= IIRDSP_MAX_SECTIONS; s++) {
+        iirdsp_filter_t f;
+
+        butter_lowpass_init(&f, 2 * s, 1000.0, FS);
+        printf("%9d %14.1f", s, rate(iirdsp_process_buffer, &f, x, y, N, &checksum));
+        for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+            iirdsp_jit_t* j = iirdsp_jit_create(&f, variants[v]);
+            if (j == NULL) {
+                return 1;
+            }
+            printf(" %10.1f", rate(iirdsp_jit_function(j), &f, x, y, N, &checksum));
+            iirdsp_jit_destroy(j);
+        }
+        printf("\n");
+    }
+    printf("(checksum %g)\n", (double)checksum);
+
+    free(x);
+    free(y);
+    return 0;
+}
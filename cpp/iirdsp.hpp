@@ -49,6 +49,21 @@ public:
         iirdsp_process_buffer(&filter_, x, y, N);
     }
 
+    /**
+     * Process a buffer with the wavefront (section-per-lane) kernel
+     */
+    void process_buffer_wavefront(const iirdsp_real* x, iirdsp_real* y, int N) {
+        iirdsp_process_buffer_wavefront(&filter_, x, y, N);
+    }
+
+    /**
+     * Process a buffer section-major over cache-sized tiles
+     */
+    void process_buffer_tiled(const iirdsp_real* x, iirdsp_real* y, int N,
+                              int tile = IIRDSP_TILE_DEFAULT) {
+        iirdsp_process_buffer_tiled(&filter_, x, y, N, tile);
+    }
+
     /**
      * Process a std::vector
      */
@@ -0,0 +1,813 @@
+/**
+ * @file iirdsp_async.hpp
+ * @brief C++20 coroutine pipeline on top of the C++ wrappers
+ *
+ * Streams are written as chains of coroutine stages connected by bounded
+ * channels:
+ *
+ *     source --Channel<Block>--> stage --Channel<Block>--> ... --> sink
+ *
+ * Every stage runs on a small ThreadPool. A stage that waits on a full or
+ * empty channel suspends instead of blocking a thread, so one pool serves
+ * any number of streams and a slow sink throttles its source
+ * (backpressure). Blocking I/O (file and descriptor reads and writes)
+ * runs on separate I/O threads via ThreadPool::io(), so filtering
+ * continues on the compute threads while reads wait.
+ *
+ * Stages close their input and output channels when they finish,
+ * including on an exception, so a failure anywhere ends the whole chain
+ * instead of leaving neighbours suspended. TaskGroup rethrows the first
+ * exception from wait().
+ *
+ * Requires C++20. Desktop-only, like iirdsp.hpp.
+ */
+
+#ifndef IIRDSP_ASYNC_HPP
+#define IIRDSP_ASYNC_HPP
+
+#if __cplusplus < 202002L || !defined(__cpp_impl_coroutine)
+#error "iirdsp_async.hpp requires C++20 coroutines"
+#endif
+
+#include "iirdsp.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#define IIRDSP_ASYNC_POSIX 1
+#endif
+
+namespace iirdsp {
+namespace async {
+
+/**
+ * Unit of data passed between stages
+ */
+using Block = std::vector<iirdsp_real>;
+
+/**
+ * Compute threads that resume coroutines, plus I/O threads for blocking
+ * calls
+ *
+ * Must outlive every coroutine scheduled on it: wait on the TaskGroup
+ * before destroying the pool.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param workers Compute threads (0 = hardware concurrency)
+     * @param io_threads Threads for blocking I/O calls
+     */
+    explicit ThreadPool(unsigned workers = 0, unsigned io_threads = 1) {
+        if (workers == 0) {
+            workers = std::thread::hardware_concurrency();
+        }
+        if (workers == 0) {
+            workers = 1;
+        }
+        if (io_threads == 0) {
+            io_threads = 1;
+        }
+        for (unsigned i = 0; i < workers; i++) {
+            threads_.emplace_back([this] { run(compute_); });
+        }
+        for (unsigned i = 0; i < io_threads; i++) {
+            threads_.emplace_back([this] { run(io_); });
+        }
+    }
+
+    ~ThreadPool() {
+        compute_.stop();
+        io_.stop();
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Resume a coroutine on a compute thread
+     */
+    void post(std::coroutine_handle<> h) {
+        compute_.push([h] { h.resume(); });
+    }
+
+    /**
+     * Awaitable that moves the awaiting coroutine onto a compute thread
+     */
+    auto schedule() {
+        struct Awaiter {
+            ThreadPool& pool;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { pool.post(h); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    /**
+     * Awaitable that runs fn() on an I/O thread and resumes the awaiting
+     * coroutine on a compute thread with its result (or exception)
+     */
+    template <class F>
+    auto io(F fn) {
+        using R = std::invoke_result_t<F&>;
+
+        struct Awaiter {
+            ThreadPool& pool;
+            F fn;
+            std::conditional_t<std::is_void_v<R>, bool, std::optional<R>> result{};
+            std::exception_ptr error;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) {
+                pool.io_.push([this, h] {
+                    try {
+                        if constexpr (std::is_void_v<R>) {
+                            fn();
+                        } else {
+                            result.emplace(fn());
+                        }
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    pool.post(h);
+                });
+            }
+            R await_resume() {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                if constexpr (!std::is_void_v<R>) {
+                    return std::move(*result);
+                }
+            }
+        };
+        return Awaiter{*this, std::move(fn), {}, {}};
+    }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> items;
+        bool stopping = false;
+
+        void push(std::function<void()> fn) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                items.push_back(std::move(fn));
+            }
+            cv.notify_one();
+        }
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stopping = true;
+            }
+            cv.notify_all();
+        }
+    };
+
+    static void run(Queue& q) {
+        for (;;) {
+            std::function<void()> fn;
+            {
+                std::unique_lock<std::mutex> lock(q.m);
+                q.cv.wait(lock, [&q] { return q.stopping || !q.items.empty(); });
+                if (q.items.empty()) {
+                    return;
+                }
+                fn = std::move(q.items.front());
+                q.items.pop_front();
+            }
+            fn();
+        }
+    }
+
+    Queue compute_;
+    Queue io_;
+    std::vector<std::thread> threads_;
+};
+
+namespace detail {
+
+template <class T>
+struct TaskPromise;
+
+}  /* namespace detail */
+
+/**
+ * Lazily started coroutine returning T
+ *
+ * Starts when awaited and resumes its awaiter when done (symmetric
+ * transfer). Exceptions propagate to the awaiter.
+ */
+template <class T = void>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    explicit Task(handle_type h) : h_(h) {}
+    Task(Task&& other) noexcept : h_(std::exchange(other.h_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (h_) {
+                h_.destroy();
+            }
+            h_ = std::exchange(other.h_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (h_) {
+            h_.destroy();
+        }
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            handle_type h;
+            bool await_ready() const noexcept { return !h || h.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                h.promise().continuation = caller;
+                return h;
+            }
+            T await_resume() { return h.promise().result(); }
+        };
+        return Awaiter{h_};
+    }
+
+private:
+    handle_type h_;
+};
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <class T>
+struct TaskPromise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() { return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this)); }
+    template <class U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase {
+    Task<void> get_return_object() { return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this)); }
+    void return_void() noexcept {}
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+/* Fire-and-forget coroutine used by TaskGroup; frees itself when done */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+}  /* namespace detail */
+
+/**
+ * Runs a set of tasks on a pool and waits for all of them
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool_(pool) {}
+
+    ~TaskGroup() {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [this] { return pending_ == 0; });
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * Start a task on the pool
+     */
+    void spawn(Task<void> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            pending_++;
+        }
+        run(std::move(task));
+    }
+
+    /**
+     * Block until every spawned task has finished
+     *
+     * @throws The first exception any task threw
+     */
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [this] { return pending_ == 0; });
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+private:
+    detail::Detached run(Task<void> task) {
+        std::exception_ptr error;
+
+        co_await pool_.schedule();
+        try {
+            co_await std::move(task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        finish(error);
+    }
+
+    void finish(std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(m_);
+        if (error && !error_) {
+            error_ = error;
+        }
+        pending_--;
+        cv_.notify_all();
+    }
+
+    ThreadPool& pool_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::size_t pending_ = 0;
+    std::exception_ptr error_;
+};
+
+/**
+ * Bounded multi-producer, multi-consumer channel between stages
+ *
+ * push() suspends while the channel is full; pop() suspends while it is
+ * empty. Suspended coroutines are resumed on the pool.
+ */
+template <class T>
+class Channel {
+public:
+    /**
+     * @param pool Pool that resumes waiting coroutines
+     * @param capacity Items buffered before push() suspends (at least 1)
+     */
+    Channel(ThreadPool& pool, std::size_t capacity) : pool_(pool), capacity_(capacity > 0 ? capacity : 1) {}
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    /**
+     * Awaitable push
+     *
+     * @return co_await yields false if the channel was closed (the value
+     *         is dropped)
+     */
+    auto push(T value) {
+        struct Awaiter {
+            Channel& ch;
+            T value;
+            bool ok = false;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> h) {
+                std::lock_guard<std::mutex> lock(ch.m_);
+                if (ch.closed_) {
+                    return false;
+                }
+                ok = true;
+                if (!ch.poppers_.empty()) {
+                    PopWaiter w = ch.poppers_.front();
+                    ch.poppers_.pop_front();
+                    w.slot->emplace(std::move(value));
+                    ch.pool_.post(w.h);
+                    return false;
+                }
+                if (ch.items_.size() < ch.capacity_) {
+                    ch.items_.push_back(std::move(value));
+                    return false;
+                }
+                ok = false;
+                ch.pushers_.push_back(PushWaiter{h, &value, &ok});
+                return true;
+            }
+            bool await_resume() const noexcept { return ok; }
+        };
+        return Awaiter{*this, std::move(value), false};
+    }
+
+    /**
+     * Awaitable pop
+     *
+     * @return co_await yields the next item, or std::nullopt once the
+     *         channel is closed and drained
+     */
+    auto pop() {
+        struct Awaiter {
+            Channel& ch;
+            std::optional<T> slot;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> h) {
+                std::lock_guard<std::mutex> lock(ch.m_);
+                if (!ch.items_.empty()) {
+                    slot.emplace(std::move(ch.items_.front()));
+                    ch.items_.pop_front();
+                    if (!ch.pushers_.empty()) {
+                        PushWaiter w = ch.pushers_.front();
+                        ch.pushers_.pop_front();
+                        ch.items_.push_back(std::move(*w.value));
+                        *w.ok = true;
+                        ch.pool_.post(w.h);
+                    }
+                    return false;
+                }
+                if (ch.closed_) {
+                    return false;
+                }
+                ch.poppers_.push_back(PopWaiter{h, &slot});
+                return true;
+            }
+            std::optional<T> await_resume() { return std::move(slot); }
+        };
+        return Awaiter{*this, std::nullopt};
+    }
+
+    /**
+     * Close the channel: pending and later pops drain the buffered items
+     * and then yield std::nullopt; pending and later pushes yield false
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(m_);
+        closed_ = true;
+        for (auto& w : poppers_) {
+            pool_.post(w.h);
+        }
+        for (auto& w : pushers_) {
+            pool_.post(w.h);
+        }
+        poppers_.clear();
+        pushers_.clear();
+    }
+
+private:
+    struct PushWaiter {
+        std::coroutine_handle<> h;
+        T* value;
+        bool* ok;
+    };
+    struct PopWaiter {
+        std::coroutine_handle<> h;
+        std::optional<T>* slot;
+    };
+
+    ThreadPool& pool_;
+    std::size_t capacity_;
+    std::mutex m_;
+    std::deque<T> items_;
+    std::deque<PushWaiter> pushers_;
+    std::deque<PopWaiter> poppers_;
+    bool closed_ = false;
+};
+
+/**
+ * Sample ring filled by non-coroutine code (an acquisition callback or
+ * driver thread) and read by a coroutine
+ *
+ * write() never blocks: it accepts what fits, so backpressure shows up as
+ * a short write. read() suspends until enough samples arrive.
+ */
+class RingBuffer {
+public:
+    RingBuffer(ThreadPool& pool, std::size_t capacity) : pool_(pool), data_(capacity > 0 ? capacity : 1) {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    /**
+     * Append samples from any thread
+     *
+     * @return Number of samples accepted
+     */
+    std::size_t write(const iirdsp_real* x, std::size_t n) {
+        std::coroutine_handle<> wake;
+        std::size_t accepted;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            accepted = std::min(n, data_.size() - count_);
+            for (std::size_t i = 0; i < accepted; i++) {
+                data_[(head_ + count_ + i) % data_.size()] = x[i];
+            }
+            count_ += accepted;
+            wake = take_reader();
+        }
+        if (wake) {
+            pool_.post(wake);
+        }
+        return accepted;
+    }
+
+    /**
+     * End of stream: the reader gets the remaining samples, then 0
+     */
+    void close() {
+        std::coroutine_handle<> wake;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            closed_ = true;
+            wake = take_reader();
+        }
+        if (wake) {
+            pool_.post(wake);
+        }
+    }
+
+    /**
+     * Awaitable read of up to n samples (one reader at a time)
+     *
+     * @return co_await yields n, or fewer only at the end of the stream
+     */
+    auto read(iirdsp_real* dst, std::size_t n) {
+        struct Awaiter {
+            RingBuffer& ring;
+            iirdsp_real* dst;
+            std::size_t n;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> h) {
+                std::lock_guard<std::mutex> lock(ring.m_);
+                if (ring.count_ >= n || ring.closed_) {
+                    return false;
+                }
+                ring.reader_ = h;
+                ring.want_ = n;
+                return true;
+            }
+            std::size_t await_resume() {
+                std::lock_guard<std::mutex> lock(ring.m_);
+                std::size_t got = std::min(n, ring.count_);
+                for (std::size_t i = 0; i < got; i++) {
+                    dst[i] = ring.data_[(ring.head_ + i) % ring.data_.size()];
+                }
+                ring.head_ = (ring.head_ + got) % ring.data_.size();
+                ring.count_ -= got;
+                return got;
+            }
+        };
+        return Awaiter{*this, dst, std::min(n, data_.size())};
+    }
+
+private:
+    std::coroutine_handle<> take_reader() {
+        if (reader_ && (count_ >= want_ || closed_)) {
+            return std::exchange(reader_, {});
+        }
+        return {};
+    }
+
+    ThreadPool& pool_;
+    std::vector<iirdsp_real> data_;
+    std::mutex m_;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::size_t want_ = 0;
+    std::coroutine_handle<> reader_;
+    bool closed_ = false;
+};
+
+namespace detail {
+
+/* Closes a channel when a stage exits, normally or by exception */
+template <class T>
+struct CloseOnExit {
+    Channel<T>& ch;
+    ~CloseOnExit() { ch.close(); }
+};
+
+}  /* namespace detail */
+
+/**
+ * Source: raw native-endian iirdsp_real samples from a file
+ *
+ * @param block Samples per block (the last block may be shorter)
+ * @throws std::runtime_error if the file cannot be opened or read
+ */
+inline Task<void> file_source(ThreadPool& pool, std::string path, std::size_t block, Channel<Block>& out) {
+    detail::CloseOnExit<Block> guard{out};
+    std::FILE* fp = co_await pool.io([&path] { return std::fopen(path.c_str(), "rb"); });
+
+    if (fp == nullptr) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    for (;;) {
+        Block b(block);
+        std::size_t got = co_await pool.io([&] { return std::fread(b.data(), sizeof(iirdsp_real), block, fp); });
+        if (got == 0) {
+            break;
+        }
+        b.resize(got);
+        if (!co_await out.push(std::move(b))) {
+            break;
+        }
+    }
+    bool failed = std::ferror(fp) != 0;
+    std::fclose(fp);
+    if (failed) {
+        throw std::runtime_error("Failed to read " + path);
+    }
+}
+
+/**
+ * Source: blocks of up to block samples from a RingBuffer
+ */
+inline Task<void> ring_source(RingBuffer& ring, std::size_t block, Channel<Block>& out) {
+    detail::CloseOnExit<Block> guard{out};
+
+    for (;;) {
+        Block b(block);
+        std::size_t got = co_await ring.read(b.data(), block);
+        if (got == 0) {
+            break;
+        }
+        b.resize(got);
+        if (!co_await out.push(std::move(b))) {
+            break;
+        }
+    }
+}
+
+#ifdef IIRDSP_ASYNC_POSIX
+/**
+ * Source: samples arriving on a socket, pipe or other descriptor
+ *
+ * Emits whatever whole samples each read() returns, up to block samples
+ * per block, until end of file. The descriptor is not closed.
+ *
+ * @throws std::runtime_error on a read error
+ */
+inline Task<void> fd_source(ThreadPool& pool, int fd, std::size_t block, Channel<Block>& out) {
+    detail::CloseOnExit<Block> guard{out};
+    std::vector<char> bytes(block * sizeof(iirdsp_real));
+    std::size_t carry = 0;
+
+    for (;;) {
+        ssize_t n = co_await pool.io([&] {
+            ssize_t r;
+            do {
+                r = ::read(fd, bytes.data() + carry, bytes.size() - carry);
+            } while (r < 0 && errno == EINTR);
+            if (r < 0) {
+                throw std::runtime_error(std::string("read failed: ") + std::strerror(errno));
+            }
+            return r;
+        });
+        if (n == 0) {
+            break;
+        }
+        std::size_t have = carry + (std::size_t)n;
+        std::size_t samples = have / sizeof(iirdsp_real);
+        if (samples == 0) {
+            carry = have;
+            continue;
+        }
+        Block b(samples);
+        std::memcpy(b.data(), bytes.data(), samples * sizeof(iirdsp_real));
+        carry = have - samples * sizeof(iirdsp_real);
+        std::memmove(bytes.data(), bytes.data() + samples * sizeof(iirdsp_real), carry);
+        if (!co_await out.push(std::move(b))) {
+            break;
+        }
+    }
+}
+#endif
+
+/**
+ * Stage: apply fn(Block&) to every block in place
+ *
+ * For decoding, scaling, or any other per-block step.
+ */
+template <class F>
+Task<void> transform_stage(Channel<Block>& in, Channel<Block>& out, F fn) {
+    detail::CloseOnExit<Block> close_in{in};
+    detail::CloseOnExit<Block> close_out{out};
+
+    while (auto b = co_await in.pop()) {
+        fn(*b);
+        if (!co_await out.push(std::move(*b))) {
+            break;
+        }
+    }
+}
+
+/**
+ * Stage: stream blocks through a filter, keeping its state across blocks
+ *
+ * The filter must outlive the stage and not be used elsewhere meanwhile.
+ */
+inline Task<void> filter_stage(Filter& filter, Channel<Block>& in, Channel<Block>& out) {
+    detail::CloseOnExit<Block> close_in{in};
+    detail::CloseOnExit<Block> close_out{out};
+
+    while (auto b = co_await in.pop()) {
+        filter.process_buffer(b->data(), b->data(), (int)b->size());
+        if (!co_await out.push(std::move(*b))) {
+            break;
+        }
+    }
+}
+
+/**
+ * Sink: append every block to a vector
+ */
+inline Task<void> collect_sink(Channel<Block>& in, std::vector<iirdsp_real>& out) {
+    detail::CloseOnExit<Block> guard{in};
+
+    while (auto b = co_await in.pop()) {
+        out.insert(out.end(), b->begin(), b->end());
+    }
+}
+
+/**
+ * Sink: write raw iirdsp_real samples to a file
+ *
+ * @throws std::runtime_error if the file cannot be created or written
+ */
+inline Task<void> file_sink(ThreadPool& pool, std::string path, Channel<Block>& in) {
+    detail::CloseOnExit<Block> guard{in};
+    std::FILE* fp = co_await pool.io([&path] { return std::fopen(path.c_str(), "wb"); });
+
+    if (fp == nullptr) {
+        throw std::runtime_error("Failed to create " + path);
+    }
+    bool ok = true;
+    while (auto b = co_await in.pop()) {
+        ok = co_await pool.io([&] { return std::fwrite(b->data(), sizeof(iirdsp_real), b->size(), fp); }) ==
+             b->size();
+        if (!ok) {
+            break;
+        }
+    }
+    ok = std::fclose(fp) == 0 && ok;
+    if (!ok) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
+
+}  /* namespace async */
+}  /* namespace iirdsp */
+
+#endif /* IIRDSP_ASYNC_HPP */
@@ -83,16 +83,21 @@ int main(void)
     }
     printf("✓ Notch filter (50 Hz, Q=30)\n\n");
 
-    /* Apply zero-phase filtering (filtfilt) */
+    /* Apply zero-phase filtering (filtfilt), accumulating RMS on the way */
     printf("Applying filters...\n");
 
-    iirdsp_filtfilt(&pqrst_filter, ecg_raw, pqrst, N_samples);
+    iirdsp_stats_t st_pqrst, st_baseline, st_emg;
+    iirdsp_stats_init(&st_pqrst, IIRDSP_STAT_SUM_SQ);
+    iirdsp_stats_init(&st_baseline, IIRDSP_STAT_SUM_SQ);
+    iirdsp_stats_init(&st_emg, IIRDSP_STAT_SUM_SQ);
+
+    iirdsp_filtfilt_stats(&pqrst_filter, ecg_raw, pqrst, N_samples, &st_pqrst);
     printf("✓ PQRST extraction complete\n");
 
-    iirdsp_filtfilt(&baseline_filter, ecg_raw, baseline, N_samples);
+    iirdsp_filtfilt_stats(&baseline_filter, ecg_raw, baseline, N_samples, &st_baseline);
     printf("✓ Baseline extraction complete\n");
 
-    iirdsp_filtfilt(&emg_filter, ecg_raw, emg, N_samples);
+    iirdsp_filtfilt_stats(&emg_filter, ecg_raw, emg, N_samples, &st_emg);
     printf("✓ EMG extraction complete\n");
 
     iirdsp_filtfilt(&notch_filter, ecg_raw, powerline, N_samples);
@@ -104,18 +109,16 @@ int main(void)
         printf("%.3f, %.6f, %.6f\n", n / Fs, ecg_raw[n], pqrst[n]);
     }
 
-    /* Compute RMS of each filtered signal */
-    iirdsp_real rms_raw = 0.0, rms_pqrst = 0.0, rms_baseline = 0.0, rms_emg = 0.0;
+    /* RMS of the filtered signals was accumulated during filtering */
+    iirdsp_real rms_raw = 0.0;
     for (int n = 0; n < N_samples; n++) {
-        rms_raw     += ecg_raw[n] * ecg_raw[n];
-        rms_pqrst   += pqrst[n] * pqrst[n];
-        rms_baseline += baseline[n] * baseline[n];
-        rms_emg     += emg[n] * emg[n];
+        rms_raw += ecg_raw[n] * ecg_raw[n];
     }
-    rms_raw       = sqrt(rms_raw / N_samples);
-    rms_pqrst     = sqrt(rms_pqrst / N_samples);
-    rms_baseline  = sqrt(rms_baseline / N_samples);
-    rms_emg       = sqrt(rms_emg / N_samples);
+    rms_raw = sqrt(rms_raw / N_samples);
+
+    iirdsp_real rms_pqrst    = iirdsp_stats_rms(&st_pqrst);
+    iirdsp_real rms_baseline = iirdsp_stats_rms(&st_baseline);
+    iirdsp_real rms_emg      = iirdsp_stats_rms(&st_emg);
 
     printf("\nSignal RMS values:\n");
     printf("Raw ECG:      %.6f\n", rms_raw);
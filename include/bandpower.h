@@ -0,0 +1,156 @@
+/**
+ * @file bandpower.h
+ * @brief Multi-band power features from a filter bank in one pass
+ */
+
+#ifndef IIRDSP_BANDPOWER_H
+#define IIRDSP_BANDPOWER_H
+
+#include "config.h"
+#include "sos.h"
+#include "multi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of bands per extractor
+ */
+#ifndef IIRDSP_BANDPOWER_MAX_BANDS
+#define IIRDSP_BANDPOWER_MAX_BANDS 8
+#endif
+
+/**
+ * Lane groups needed to hold IIRDSP_BANDPOWER_MAX_BANDS bands
+ */
+#define IIRDSP_BANDPOWER_GROUPS \
+    ((IIRDSP_BANDPOWER_MAX_BANDS + IIRDSP_LANES - 1) / IIRDSP_LANES)
+
+/**
+ * Frequency band edges (Hz)
+ *
+ * low_hz <= 0 designs a low-pass at high_hz instead of a band-pass.
+ */
+typedef struct {
+    iirdsp_real low_hz;
+    iirdsp_real high_hz;
+} iirdsp_band_t;
+
+/**
+ * Band power extractor for one channel
+ *
+ * The band filters of a channel sit in the SIMD lanes of one or more lane
+ * groups, so every input sample is read once and broadcast to all bands.
+ * Band outputs are squared and summed as they are produced; only one
+ * mean-power value per band and frame is ever written.
+ */
+typedef struct {
+    iirdsp_lanes_t groups[IIRDSP_BANDPOWER_GROUPS];
+    iirdsp_real acc[IIRDSP_BANDPOWER_GROUPS][IIRDSP_LANES]; /* Frame sums */
+    int num_bands;
+    int num_groups;
+    int hop;       /* Samples per output frame */
+    int pos;       /* Samples accumulated in the current frame */
+} iirdsp_bandpower_t;
+
+/**
+ * Initialize an extractor with Butterworth band filters
+ *
+ * @param bp Extractor to initialize
+ * @param bands Band edges (num_bands entries)
+ * @param num_bands Number of bands (1..IIRDSP_BANDPOWER_MAX_BANDS)
+ * @param order Butterworth prototype order of every band filter
+ * @param fs_hz Sampling frequency (Hz)
+ * @param frame_hz Output feature rate (Hz); the frame is the nearest whole
+ *                 number of samples
+ * @return 0 on success, -1 on invalid arguments, -2 if a band filter
+ *         cannot be designed
+ */
+int iirdsp_bandpower_init(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_band_t* bands,
+    int num_bands,
+    int order,
+    iirdsp_real fs_hz,
+    iirdsp_real frame_hz
+);
+
+/**
+ * Initialize an extractor with caller-designed band filters
+ *
+ * The filters are copied, including their state.
+ *
+ * @param bp Extractor to initialize
+ * @param filters One cascade per band (num_bands entries)
+ * @param num_bands Number of bands (1..IIRDSP_BANDPOWER_MAX_BANDS)
+ * @param hop Samples per output frame (>= 1)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_bandpower_init_filters(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_filter_t* filters,
+    int num_bands,
+    int hop
+);
+
+/**
+ * Clear filter state and the partial frame
+ *
+ * @param bp Extractor
+ */
+void iirdsp_bandpower_reset(iirdsp_bandpower_t* bp);
+
+/**
+ * Feed samples and collect completed frames
+ *
+ * A partial frame carries over to the next call. Frame k yields
+ * features[k * num_bands + b], the mean squared output of band b.
+ *
+ * @param bp Extractor
+ * @param x Input samples (length N)
+ * @param N Number of samples
+ * @param features Output features (max_frames * num_bands)
+ * @param max_frames Capacity of features in frames; further completed
+ *                   frames are dropped
+ * @return Number of frames written
+ */
+int iirdsp_bandpower_process(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_real* features,
+    int max_frames
+);
+
+/**
+ * Feed a multi-channel block, one extractor per channel
+ *
+ * All extractors must share num_bands and hop and have seen the same
+ * number of samples, so their frames line up. Frame k of channel c
+ * yields features[(k * channels + c) * num_bands + b].
+ *
+ * @param bp Extractors (channels entries)
+ * @param channels Number of channels C
+ * @param x Input samples (channels * N, laid out per layout)
+ * @param N Samples per channel
+ * @param layout IIRDSP_LAYOUT_PLANAR or IIRDSP_LAYOUT_INTERLEAVED
+ * @param features Output features (max_frames * channels * num_bands)
+ * @param max_frames Capacity of features in frames
+ * @return Number of frames written, or -1 on invalid arguments
+ */
+int iirdsp_bandpower_process_multi(
+    iirdsp_bandpower_t* bp,
+    int channels,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_layout_t layout,
+    iirdsp_real* features,
+    int max_frames
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_BANDPOWER_H */
@@ -28,4 +28,64 @@ typedef double iirdsp_real;
  */
 #define IIRDSP_MAX_SECTIONS 8
 
+/**
+ * Number of channels processed side by side in multi-channel kernels
+ * Matches one 256-bit SIMD register of iirdsp_real (AVX); narrower targets
+ * simply split each lane group across several registers.
+ */
+#ifndef IIRDSP_LANES
+#ifdef IIRDSP_USE_FLOAT
+#define IIRDSP_LANES 8
+#else
+#define IIRDSP_LANES 4
+#endif
+#endif
+
+/**
+ * Default tile length (samples) for section-major tiled processing
+ * Sized so one tile of iirdsp_real stays resident in a 32 KiB L1 data cache.
+ * Use iirdsp_tile_autotune() to pick a value for the host at runtime.
+ */
+#ifndef IIRDSP_TILE_DEFAULT
+#define IIRDSP_TILE_DEFAULT 2048
+#endif
+
+/**
+ * Cache sizes (bytes) assumed by iirdsp_tiling_choose() when the caller
+ * passes 0: a typical 32 KiB L1 data cache and 1 MiB private L2
+ */
+#ifndef IIRDSP_L1_BYTES
+#define IIRDSP_L1_BYTES 32768
+#endif
+
+#ifndef IIRDSP_L2_BYTES
+#define IIRDSP_L2_BYTES 1048576
+#endif
+
+/**
+ * Cache-line size (bytes) that shared and per-object data is aligned and
+ * padded to, so objects owned by different threads never share a line
+ */
+#ifndef IIRDSP_CACHE_LINE
+#define IIRDSP_CACHE_LINE 64
+#endif
+
+/**
+ * Large-buffer streaming threshold (samples)
+ * Buffers at least this long are written with non-temporal stores so the
+ * output does not evict the cache or pay read-for-ownership traffic.
+ * The default (4 Mi samples) is well beyond any last-level cache.
+ * Define as 0 to disable automatic selection.
+ */
+#ifndef IIRDSP_STREAM_THRESHOLD
+#define IIRDSP_STREAM_THRESHOLD (1 << 22)
+#endif
+
+/**
+ * Software prefetch distance (samples) used by the streaming path
+ */
+#ifndef IIRDSP_PREFETCH_DISTANCE
+#define IIRDSP_PREFETCH_DISTANCE 512
+#endif
+
 #endif /* IIRDSP_CONFIG_H */
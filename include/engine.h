@@ -0,0 +1,174 @@
+/**
+ * @file engine.h
+ * @brief Multi-tenant stream engine: per-stream state keyed by ID, packet
+ *        coalescing and SIMD-lane scheduling
+ *
+ * Host-only: allocates its tables at creation. Links against iirdsp_host;
+ * not available in EMBEDDED_BUILD configurations.
+ */
+
+#ifndef IIRDSP_ENGINE_H
+#define IIRDSP_ENGINE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of distinct coefficient sets per engine
+ */
+#ifndef IIRDSP_ENGINE_MAX_COEFFS
+#define IIRDSP_ENGINE_MAX_COEFFS 64
+#endif
+
+/**
+ * Receives the filtered output of one stream
+ *
+ * Called from iirdsp_engine_run() with every sample that stream had
+ * pending, in order. y is only valid during the call, and the sink must
+ * not call back into the engine.
+ *
+ * @param user User pointer given to iirdsp_engine_create()
+ * @param stream_id Stream the samples belong to
+ * @param y Filtered samples
+ * @param n Number of samples
+ */
+typedef void (*iirdsp_sink_fn)(void* user, uint64_t stream_id, const iirdsp_real* y, int n);
+
+/**
+ * Engine counters
+ */
+typedef struct {
+    long runs;            /* iirdsp_engine_run() calls */
+    long packets;         /* Packets ingested */
+    long lane_samples;    /* Samples filtered in SIMD lanes */
+    long scalar_samples;  /* Samples filtered one stream at a time */
+} iirdsp_engine_stats_t;
+
+/**
+ * Opaque stream engine
+ *
+ * An engine is used from one thread at a time; the gateway thread that
+ * ingests packets also calls iirdsp_engine_run(), or the caller
+ * serializes access.
+ */
+typedef struct iirdsp_engine iirdsp_engine_t;
+
+/**
+ * Create an engine
+ *
+ * All memory is allocated here: stream records, the ID hash table, and
+ * per-stream pending buffers of max_pending samples.
+ *
+ * @param max_streams Maximum number of open streams
+ * @param max_pending Samples a stream can queue between runs
+ * @param sink Output callback
+ * @param user Passed to sink
+ * @return New engine, or NULL on invalid arguments or allocation failure
+ */
+iirdsp_engine_t* iirdsp_engine_create(
+    int max_streams,
+    int max_pending,
+    iirdsp_sink_fn sink,
+    void* user
+);
+
+/**
+ * Free an engine; pending samples are discarded
+ *
+ * @param e Engine, or NULL
+ */
+void iirdsp_engine_destroy(iirdsp_engine_t* e);
+
+/**
+ * Register a coefficient set
+ *
+ * Streams opened on the same set are filtered together in SIMD lanes.
+ * Registering coefficients equal to an existing set returns that set.
+ * Every call takes a reference on the set, and every open stream holds
+ * one; the set's index is free for reuse once all are dropped.
+ *
+ * @param e Engine
+ * @param f Filter whose coefficients are copied (state is ignored)
+ * @return Coefficient set index (>= 0), or -1 if the table is full
+ */
+int iirdsp_engine_add_coeffs(iirdsp_engine_t* e, const iirdsp_filter_t* f);
+
+/**
+ * Drop a reference taken by iirdsp_engine_add_coeffs()
+ *
+ * Streams still open on the set keep it alive until they close, so a
+ * caller may release the set right after opening its streams.
+ *
+ * @param e Engine
+ * @param coeff_set Index from iirdsp_engine_add_coeffs()
+ * @return 0 on success, -1 if coeff_set is not a live set
+ */
+int iirdsp_engine_release_coeffs(iirdsp_engine_t* e, int coeff_set);
+
+/**
+ * Open a stream with zero state
+ *
+ * @param e Engine
+ * @param stream_id Caller-chosen stream ID
+ * @param coeff_set Index from iirdsp_engine_add_coeffs()
+ * @return 0 on success, -1 if the engine is full, -2 if the ID is already
+ *         open, -3 if coeff_set is invalid
+ */
+int iirdsp_engine_open(iirdsp_engine_t* e, uint64_t stream_id, int coeff_set);
+
+/**
+ * Close a stream; samples not yet run are discarded
+ *
+ * @param e Engine
+ * @param stream_id Stream to close
+ * @return 0 on success, -1 if the ID is not open
+ */
+int iirdsp_engine_close(iirdsp_engine_t* e, uint64_t stream_id);
+
+/**
+ * Queue a packet of input samples for a stream
+ *
+ * Only copies the samples; filtering happens in iirdsp_engine_run().
+ *
+ * @param e Engine
+ * @param stream_id Stream the packet belongs to
+ * @param x Samples
+ * @param n Number of samples
+ * @return 0 on success, -1 if the ID is not open, -2 if the packet does
+ *         not fit in the stream's pending buffer (nothing is queued; run
+ *         the engine and retry)
+ */
+int iirdsp_engine_ingest(iirdsp_engine_t* e, uint64_t stream_id, const iirdsp_real* x, int n);
+
+/**
+ * Filter every pending sample and deliver it to the sink
+ *
+ * Streams are grouped by coefficient set. Each group runs IIRDSP_LANES
+ * streams at a time in SIMD lanes; when a stream's coalesced packets are
+ * used up its lane is refilled with the next pending stream. The last
+ * stream of a group is finished alone. Calling this at a fixed interval
+ * bounds latency to that interval plus the run time.
+ *
+ * @param e Engine
+ * @return Number of samples filtered
+ */
+long iirdsp_engine_run(iirdsp_engine_t* e);
+
+/**
+ * Read the engine counters
+ *
+ * @param e Engine
+ * @param stats Receives the counters
+ */
+void iirdsp_engine_get_stats(const iirdsp_engine_t* e, iirdsp_engine_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_ENGINE_H */
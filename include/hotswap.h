@@ -0,0 +1,131 @@
+/**
+ * @file hotswap.h
+ * @brief Lock-free coefficient updates for a filter running on a
+ *        real-time thread
+ *
+ * A control thread designs new coefficients and publishes them with one
+ * atomic pointer exchange; the real-time thread picks the update up at
+ * the start of its next block. Neither side takes a lock, the real-time
+ * thread never allocates or frees, and it never sees a half-written
+ * coefficient set. Updates the real-time thread is done with are handed
+ * back to the control thread, which frees them in iirdsp_hotswap_reclaim().
+ *
+ * Host-only: links against iirdsp_host; not available in EMBEDDED_BUILD
+ * configurations.
+ */
+
+#ifndef IIRDSP_HOTSWAP_H
+#define IIRDSP_HOTSWAP_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * What happens to the filter state when new coefficients take effect
+ */
+typedef enum {
+    IIRDSP_SWAP_KEEP = 0,   /* Keep z1/z2; sections the old filter lacked start at zero */
+    IIRDSP_SWAP_RESET = 1,  /* Zero the state */
+    IIRDSP_SWAP_STEADY = 2  /* Steady state of the new filter for the last input sample */
+} iirdsp_swap_state_t;
+
+/**
+ * Opaque hot-swappable filter
+ */
+typedef struct iirdsp_hotswap iirdsp_hotswap_t;
+
+/**
+ * Create a hot-swappable filter
+ *
+ * @param initial Initial coefficients; its state is copied as well
+ * @return New filter, or NULL if initial has no sections or too many, or
+ *         on allocation failure
+ */
+iirdsp_hotswap_t* iirdsp_hotswap_create(const iirdsp_filter_t* initial);
+
+/**
+ * Free the filter and any update not yet reclaimed
+ *
+ * Neither thread may use the filter during or after this call.
+ *
+ * @param h Filter, or NULL
+ */
+void iirdsp_hotswap_destroy(iirdsp_hotswap_t* h);
+
+/**
+ * Publish new coefficients (control thread)
+ *
+ * Copies the coefficients, then exchanges them into the pending slot. If
+ * an earlier update was still pending, the real-time thread never sees
+ * it and it is freed here.
+ *
+ * With crossfade > 0 the real-time thread keeps running the old filter
+ * alongside the new one for that many samples and blends the outputs
+ * linearly, hiding the step a coefficient change causes. An update
+ * arriving during a crossfade starts a new fade from the filter that was
+ * fading in.
+ *
+ * @param h Filter
+ * @param coeffs New coefficients (state ignored)
+ * @param state How the new filter's state is initialized
+ * @param crossfade Crossfade length in samples, 0 for an immediate switch
+ * @return 0 on success, -1 for invalid arguments, -2 on allocation failure
+ */
+int iirdsp_hotswap_publish(
+    iirdsp_hotswap_t* h,
+    const iirdsp_filter_t* coeffs,
+    iirdsp_swap_state_t state,
+    int crossfade
+);
+
+/**
+ * Free updates the real-time thread has finished with (control thread)
+ *
+ * @param h Filter
+ * @return Number of updates freed
+ */
+int iirdsp_hotswap_reclaim(iirdsp_hotswap_t* h);
+
+/**
+ * Filter one block (real-time thread)
+ *
+ * Adopts the pending update, if any, before the first sample; the whole
+ * block then runs with one coefficient set (or one crossfade). Wait-free
+ * apart from handing the old update back, which is a single CAS that only
+ * retries if the control thread is reclaiming at that moment.
+ *
+ * @param h Filter
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ */
+void iirdsp_hotswap_process(iirdsp_hotswap_t* h, const iirdsp_real* x, iirdsp_real* y, int N);
+
+/**
+ * Filter the real-time thread is running (real-time thread)
+ *
+ * @param h Filter
+ * @return Active coefficients and state, valid until the next
+ *         iirdsp_hotswap_process() call
+ */
+const iirdsp_filter_t* iirdsp_hotswap_active(const iirdsp_hotswap_t* h);
+
+/**
+ * Number of updates the real-time thread has adopted (any thread)
+ *
+ * Lets the control thread see that a publish has taken effect.
+ *
+ * @param h Filter
+ * @return Adopted update count
+ */
+unsigned long iirdsp_hotswap_generation(const iirdsp_hotswap_t* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_HOTSWAP_H */
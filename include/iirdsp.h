@@ -13,6 +13,13 @@
 #include "sos.h"
 #include "butter.h"
 #include "notch.h"
+#include "multi.h"
+#include "stats.h"
+#include "qrs.h"
+#include "bandpower.h"
+#include "resample.h"
+#include "pipeline.h"
+#include "serialize.h"
 
 /**
  * iirdsp version string
@@ -0,0 +1,123 @@
+/**
+ * @file jit.h
+ * @brief Run-time compiled cascade kernels for fixed coefficient sets
+ *
+ * iirdsp_jit_create() emits x86-64 machine code for one filter: every
+ * section is unrolled into straight-line code, coefficients become
+ * constants (held in spare registers, otherwise in a literal pool next to
+ * the code), multiplies by 0 and 1 are removed, and section state stays in
+ * registers for the whole buffer. VEX (AVX) three-operand encodings are
+ * used when the CPU and OS support them, SSE2 otherwise.
+ *
+ * The compiled function has the iirdsp_process_buffer() signature. It
+ * reads and writes only the state (z1, z2) of the filter it is given, so
+ * call it with the filter it was compiled from (or a copy with the same
+ * coefficients). Without FMA its output matches iirdsp_process_buffer()
+ * exactly for finite input.
+ *
+ * Where code cannot be generated (other architectures, or a system that
+ * forbids executable mappings) iirdsp_jit_function() returns
+ * iirdsp_process_buffer itself, so callers need no second code path.
+ *
+ * Host-only: links against iirdsp_host; not available in EMBEDDED_BUILD
+ * configurations.
+ */
+
+#ifndef IIRDSP_JIT_H
+#define IIRDSP_JIT_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Never generate code; always use the scalar fallback
+ */
+#define IIRDSP_JIT_DISABLE 0x1u
+
+/**
+ * Use SSE2 encodings even if AVX is available
+ */
+#define IIRDSP_JIT_NO_AVX  0x2u
+
+/**
+ * Fuse multiply/add pairs when the CPU has FMA3 (faster, but rounds
+ * differently from iirdsp_process_buffer())
+ */
+#define IIRDSP_JIT_FMA     0x4u
+
+/**
+ * Signature shared by iirdsp_process_buffer() and compiled kernels
+ */
+typedef void (*iirdsp_process_fn)(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+);
+
+/**
+ * Opaque compiled kernel
+ */
+typedef struct iirdsp_jit iirdsp_jit_t;
+
+/**
+ * Compile a kernel for a filter's coefficients
+ *
+ * @param f Filter whose coefficients are baked in (not modified)
+ * @param flags IIRDSP_JIT_* flags
+ * @return New kernel (possibly the fallback), or NULL on invalid
+ *         arguments or allocation failure
+ */
+iirdsp_jit_t* iirdsp_jit_create(const iirdsp_filter_t* f, unsigned flags);
+
+/**
+ * Free a kernel; its function must no longer be called
+ *
+ * @param j Kernel, or NULL
+ */
+void iirdsp_jit_destroy(iirdsp_jit_t* j);
+
+/**
+ * Function to call for processing
+ *
+ * @param j Kernel
+ * @return Compiled code, or iirdsp_process_buffer when none was generated
+ */
+iirdsp_process_fn iirdsp_jit_function(const iirdsp_jit_t* j);
+
+/**
+ * Instruction set the kernel was generated for
+ *
+ * @param j Kernel
+ * @return "avx-fma", "avx", "sse2", or "none" for the fallback
+ */
+const char* iirdsp_jit_isa(const iirdsp_jit_t* j);
+
+/**
+ * Process a buffer with the kernel
+ *
+ * Same as iirdsp_jit_function(j)(f, x, y, N).
+ *
+ * @param j Kernel
+ * @param f Filter holding the state (same coefficients as compiled)
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ */
+void iirdsp_jit_process(
+    const iirdsp_jit_t* j,
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_JIT_H */
@@ -0,0 +1,209 @@
+/**
+ * @file multi.h
+ * @brief Multi-channel filtering with channels in SIMD lanes
+ */
+
+#ifndef IIRDSP_MULTI_H
+#define IIRDSP_MULTI_H
+
+#include <stddef.h>
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Sample layout of a multi-channel buffer with C channels of N samples
+ */
+typedef enum {
+    IIRDSP_LAYOUT_PLANAR = 0,      /* x[c * N + n] */
+    IIRDSP_LAYOUT_INTERLEAVED = 1  /* x[n * C + c] */
+} iirdsp_layout_t;
+
+/**
+ * A group of IIRDSP_LANES cascades in structure-of-arrays form
+ *
+ * Lane l of every array belongs to one channel, so the per-section update
+ * is a straight loop over lanes that maps onto SIMD registers. Channels
+ * with fewer sections are padded with identity sections, and unused lanes
+ * hold identity cascades.
+ */
+typedef struct {
+    iirdsp_real b0[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    iirdsp_real b1[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    iirdsp_real b2[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    iirdsp_real a1[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    iirdsp_real a2[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    iirdsp_real z1[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    iirdsp_real z2[IIRDSP_MAX_SECTIONS][IIRDSP_LANES];
+    int num_sections;  /* Maximum over the loaded filters */
+    int num_lanes;     /* Lanes holding a real channel */
+} iirdsp_lanes_t;
+
+/**
+ * Load coefficients and state of up to IIRDSP_LANES filters into lanes
+ *
+ * @param l Lane group to fill
+ * @param filters First filter
+ * @param stride Filter step between lanes: 0 shares filters[0] across all
+ *               lanes, 1 takes filters[0..count-1]
+ * @param count Number of lanes to fill (1..IIRDSP_LANES)
+ */
+void iirdsp_lanes_load(
+    iirdsp_lanes_t* l,
+    const iirdsp_filter_t* filters,
+    int stride,
+    int count
+);
+
+/**
+ * Copy lane state back into the filters it was loaded from
+ *
+ * @param l Lane group
+ * @param filters First filter (one per lane, filters[0..num_lanes-1])
+ */
+void iirdsp_lanes_store_state(const iirdsp_lanes_t* l, iirdsp_filter_t* filters);
+
+/**
+ * Zero the state of every lane
+ *
+ * @param l Lane group
+ */
+void iirdsp_lanes_reset(iirdsp_lanes_t* l);
+
+/**
+ * Filter N lane vectors
+ *
+ * x and y hold N groups of IIRDSP_LANES samples: x[n * IIRDSP_LANES + lane].
+ *
+ * @param l Lane group
+ * @param x Input lane vectors (length N * IIRDSP_LANES)
+ * @param y Output lane vectors (length N * IIRDSP_LANES), can alias x
+ * @param N Number of lane vectors
+ */
+void iirdsp_lanes_process(
+    iirdsp_lanes_t* l,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+);
+
+/**
+ * Workspace needed by iirdsp_filtfilt_multi()
+ *
+ * @param N Samples per channel
+ * @return Number of iirdsp_real elements
+ */
+size_t iirdsp_filtfilt_multi_work_size(int N);
+
+/**
+ * Zero-phase filtering of C channels in one call
+ *
+ * Channels are processed IIRDSP_LANES at a time with the forward and
+ * backward recursions running in SIMD lanes. Coefficients are either shared
+ * (num_filters == 1) or per channel (num_filters == channels). The filters
+ * are not modified: each pass starts from zero state, as in iirdsp_filtfilt().
+ *
+ * @param filters Filter coefficients (1 or channels entries)
+ * @param num_filters 1 for shared coefficients, or channels
+ * @param x Input samples (channels * N, laid out per layout)
+ * @param y Output samples (same layout), can alias x
+ * @param channels Number of channels C
+ * @param N Samples per channel
+ * @param layout IIRDSP_LAYOUT_PLANAR or IIRDSP_LAYOUT_INTERLEAVED
+ * @param work Workspace of iirdsp_filtfilt_multi_work_size(N) elements,
+ *             or NULL to allocate one internally for this call
+ * @return 0 on success, -1 on invalid arguments, -2 if allocation fails
+ */
+int iirdsp_filtfilt_multi(
+    const iirdsp_filter_t* filters,
+    int num_filters,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int channels,
+    int N,
+    iirdsp_layout_t layout,
+    iirdsp_real* work
+);
+
+/**
+ * Tile shape for iirdsp_process_multi()
+ */
+typedef struct {
+    int group_channels;  /* Channels per group (rounded up to IIRDSP_LANES) */
+    int tile_samples;    /* Samples per tile */
+} iirdsp_tiling_t;
+
+/**
+ * Pick a tile shape for a cache hierarchy
+ *
+ * A group is as many lane groups (iirdsp_lanes_t) as fit in half of L1.
+ * The tile length is chosen so the input and output it covers fit in a
+ * quarter of L2: for interleaved data that is the full rows of all
+ * channels, which every group reads while they are cached; for planar
+ * data only the group's own channels.
+ *
+ * @param channels Number of channels
+ * @param layout Sample layout
+ * @param l1_bytes L1 data cache size, 0 for IIRDSP_L1_BYTES
+ * @param l2_bytes L2 cache size, 0 for IIRDSP_L2_BYTES
+ * @return Tile shape
+ */
+iirdsp_tiling_t iirdsp_tiling_choose(
+    int channels,
+    iirdsp_layout_t layout,
+    size_t l1_bytes,
+    size_t l2_bytes
+);
+
+/**
+ * Workspace needed by iirdsp_process_multi()
+ *
+ * @param channels Number of channels
+ * @return Number of iirdsp_lanes_t elements
+ */
+size_t iirdsp_process_multi_work_size(int channels);
+
+/**
+ * Stateful filtering of C channels in time x channel tiles
+ *
+ * Each channel runs through its own filter, whose state carries over
+ * between calls, so a long record can be streamed in chunks. The state
+ * is loaded into lane groups once per call, and the record is cut into
+ * tiles of tile_samples samples by group_channels channels, filtered
+ * IIRDSP_LANES channels at a time. Interleaved records are walked one
+ * time tile at a time across all groups (the rows stay cached for the
+ * next group), planar records one group at a time across all time tiles
+ * (the group's state stays in L1). Output matches iirdsp_process_buffer()
+ * on each channel.
+ *
+ * @param filters One filter per channel (channels entries), updated
+ * @param x Input samples (channels * N, laid out per layout)
+ * @param y Output samples (same layout), can alias x
+ * @param channels Number of channels C
+ * @param N Samples per channel
+ * @param layout IIRDSP_LAYOUT_PLANAR or IIRDSP_LAYOUT_INTERLEAVED
+ * @param tiling Tile shape, or NULL for iirdsp_tiling_choose() with the
+ *               default cache sizes
+ * @param work Workspace of iirdsp_process_multi_work_size(channels) lane
+ *             groups, or NULL to allocate one internally for this call
+ * @return 0 on success, -1 on invalid arguments, -2 if allocation fails
+ */
+int iirdsp_process_multi(
+    iirdsp_filter_t* filters,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int channels,
+    int N,
+    iirdsp_layout_t layout,
+    const iirdsp_tiling_t* tiling,
+    iirdsp_lanes_t* work
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_MULTI_H */
@@ -0,0 +1,170 @@
+/**
+ * @file numa_bank.h
+ * @brief NUMA-aware multi-threaded filter bank
+ *
+ * Filters many independent channels (one iirdsp_filter_t each) on a pool
+ * of worker threads laid out by memory topology. The channels are split
+ * into one contiguous group per NUMA node, sized by the node's share of
+ * the workers, and every node gets:
+ *
+ *   - workers pinned to the node's CPUs,
+ *   - the group's filter state and sample buffers, allocated and first
+ *     touched by one of those workers so the pages land on that node,
+ *   - its own work queue of channel tasks, which the node's workers drain
+ *     before they steal from other nodes.
+ *
+ * Filter state therefore never crosses the interconnect during normal
+ * operation. With iirdsp_bank_run() the samples stay node-local as well;
+ * iirdsp_bank_process() works on caller buffers and only the state is
+ * guaranteed local.
+ *
+ * Topology is read from /sys/devices/system/node and restricted to the
+ * CPUs the process may run on; no libnuma is needed. Without sysfs
+ * information the bank behaves as a single node.
+ *
+ * Output is bit-identical to iirdsp_process_buffer() on each channel.
+ *
+ * Host-only: links against iirdsp_host; not available in EMBEDDED_BUILD
+ * configurations.
+ */
+
+#ifndef IIRDSP_NUMA_BANK_H
+#define IIRDSP_NUMA_BANK_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Do not pin workers to CPUs
+ */
+#define IIRDSP_BANK_NO_PIN       0x1u
+
+/**
+ * Allocate all state and buffers on the creating thread instead of on
+ * each node (the NUMA-oblivious baseline, for comparison)
+ */
+#define IIRDSP_BANK_CALLER_ALLOC 0x2u
+
+/**
+ * Bank options; a zeroed struct (or NULL) selects the defaults
+ */
+typedef struct {
+    int num_threads;  /**< Workers in total; 0 = one per usable CPU */
+    int num_nodes;    /**< 0 = detect; > 0 = split the usable CPUs into this
+                           many equal nodes (for testing without NUMA) */
+    unsigned flags;   /**< IIRDSP_BANK_* flags */
+} iirdsp_bank_config_t;
+
+/**
+ * Opaque filter bank
+ */
+typedef struct iirdsp_bank iirdsp_bank_t;
+
+/**
+ * Lay out the channels over the nodes and start the workers
+ *
+ * Returns after every node has allocated its state. The filters'
+ * coefficients and current state are copied.
+ *
+ * @param filters One filter per channel, or a single filter used for all
+ * @param num_filters channels, or 1
+ * @param channels Number of channels (> 0)
+ * @param block_size Samples per channel in the node-local buffers used by
+ *                   iirdsp_bank_run(); 0 for none
+ * @param config Options, or NULL for defaults
+ * @return New bank, or NULL on invalid arguments or if allocation or
+ *         thread creation fails
+ */
+iirdsp_bank_t* iirdsp_bank_create(
+    const iirdsp_filter_t* filters,
+    int num_filters,
+    int channels,
+    int block_size,
+    const iirdsp_bank_config_t* config
+);
+
+/**
+ * Stop the workers and free the bank
+ *
+ * @param b Bank, or NULL
+ */
+void iirdsp_bank_destroy(iirdsp_bank_t* b);
+
+/**
+ * Filter caller buffers
+ *
+ * Only one thread may call iirdsp_bank_process() or iirdsp_bank_run() at
+ * a time; the call returns when every channel is done.
+ *
+ * @param b Bank
+ * @param x Input, planar (channel c at x + c * N)
+ * @param y Output in the same layout, can alias x
+ * @param N Samples per channel
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_bank_process(iirdsp_bank_t* b, const iirdsp_real* x, iirdsp_real* y, int N);
+
+/**
+ * Node-local sample buffer of one channel
+ *
+ * Fill it with the next input block, call iirdsp_bank_run(), and read the
+ * output back from the same place.
+ *
+ * @param b Bank
+ * @param channel Channel index
+ * @return block_size samples, or NULL if the bank has no buffers or the
+ *         channel is out of range
+ */
+iirdsp_real* iirdsp_bank_buffer(iirdsp_bank_t* b, int channel);
+
+/**
+ * Filter the first N samples of every node-local buffer in place
+ *
+ * @param b Bank
+ * @param N Samples per channel (<= block_size)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_bank_run(iirdsp_bank_t* b, int N);
+
+/**
+ * Clear the state of every channel
+ *
+ * @param b Bank
+ */
+void iirdsp_bank_reset(iirdsp_bank_t* b);
+
+/**
+ * Number of nodes the bank spreads over
+ *
+ * @param b Bank
+ * @return Node count (>= 1)
+ */
+int iirdsp_bank_num_nodes(const iirdsp_bank_t* b);
+
+/**
+ * Number of worker threads
+ *
+ * @param b Bank
+ * @return Worker count (>= 1)
+ */
+int iirdsp_bank_num_threads(const iirdsp_bank_t* b);
+
+/**
+ * NUMA node holding a channel's state and buffer
+ *
+ * @param b Bank
+ * @param channel Channel index
+ * @return System node number (or emulated node index), -1 if the channel
+ *         is out of range
+ */
+int iirdsp_bank_node_of(const iirdsp_bank_t* b, int channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_NUMA_BANK_H */
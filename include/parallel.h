@@ -0,0 +1,56 @@
+/**
+ * @file parallel.h
+ * @brief Multi-threaded filtering on host systems
+ *
+ * Host-only: requires POSIX threads and links against iirdsp_host.
+ * Not available in EMBEDDED_BUILD configurations.
+ */
+
+#ifndef IIRDSP_PARALLEL_H
+#define IIRDSP_PARALLEL_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Error-bounded overlap-parallel filtering of one long buffer
+ *
+ * Splits the buffer into one chunk per thread. The first chunk starts from
+ * the filter's current state; every other chunk starts from zero state and
+ * is warmed up on the W = iirdsp_impulse_length(f, tol) input samples that
+ * precede it. For a filter starting from zero state, every output satisfies
+ *   |y[n] - y_sequential[n]| <= tol * max|x|
+ *
+ * On return the filter state is that of the last chunk, which carries the
+ * same error bound.
+ *
+ * Falls back to iirdsp_process_buffer() when a chunk would not be longer
+ * than the overlap, or when num_threads <= 1.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), must not alias x
+ * @param N Number of samples
+ * @param num_threads Number of chunks / threads (the caller's thread runs one)
+ * @param tol Error tolerance relative to the input amplitude, > 0
+ * @return 0 on success, -1 on invalid arguments, -2 if the filter is unstable
+ *         or its impulse length cannot be bounded
+ */
+int iirdsp_process_buffer_parallel(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    int num_threads,
+    iirdsp_real tol
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_PARALLEL_H */
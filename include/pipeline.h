@@ -0,0 +1,131 @@
+/**
+ * @file pipeline.h
+ * @brief Declarative filter pipelines compiled into one fused loop
+ *
+ * A pipeline is described as text, one stage per line (or separated by
+ * ';'), '#' starting a comment:
+ *
+ *   fs 500                  # input rate (Hz), must come first
+ *   notch 50 30             # f0_hz Q
+ *   bandpass 4 0.5 40       # order f_low_hz f_high_hz
+ *   lowpass 4 40            # order cutoff_hz
+ *   highpass 2 0.5          # order cutoff_hz
+ *   baseline 0.7            # subtract a 2nd-order low-pass at cutoff_hz
+ *   decimate 2              # anti-alias low-pass, keep every 2nd sample
+ *
+ * Stages after a decimate are designed for the reduced rate.
+ */
+
+#ifndef IIRDSP_PIPELINE_H
+#define IIRDSP_PIPELINE_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of compiled operations
+ */
+#ifndef IIRDSP_PIPELINE_MAX_OPS
+#define IIRDSP_PIPELINE_MAX_OPS 16
+#endif
+
+/**
+ * Butterworth order of the decimation anti-alias filter
+ * Its cutoff is 0.4 times the rate after decimation.
+ */
+#ifndef IIRDSP_DECIMATE_ORDER
+#define IIRDSP_DECIMATE_ORDER 8
+#endif
+
+/**
+ * Compiled operation kinds
+ */
+typedef enum {
+    IIRDSP_OP_CASCADE = 0,  /* v = filter(v) */
+    IIRDSP_OP_BASELINE,     /* v = v - filter(v), sharing v with the branch */
+    IIRDSP_OP_DECIMATE      /* Keep one sample in factor */
+} iirdsp_op_kind_t;
+
+/**
+ * One operation of a compiled pipeline
+ */
+typedef struct {
+    iirdsp_op_kind_t kind;
+    iirdsp_filter_t filter;  /* CASCADE / BASELINE */
+    int factor;              /* DECIMATE */
+    int phase;               /* DECIMATE: samples since the last kept one */
+} iirdsp_pipeline_op_t;
+
+/**
+ * A compiled pipeline
+ *
+ * Adjacent linear stages (notch, low/high/band-pass and decimation
+ * anti-alias filters) are merged into one SOS cascade of up to
+ * IIRDSP_MAX_SECTIONS sections. Every block then runs as one per-sample
+ * loop over the operation list, with no intermediate buffers.
+ */
+typedef struct {
+    iirdsp_pipeline_op_t ops[IIRDSP_PIPELINE_MAX_OPS];
+    int num_ops;
+    int num_stages;      /* Stages in the description */
+    iirdsp_real fs_in;   /* Input rate (Hz) */
+    iirdsp_real fs_out;  /* Output rate (Hz) */
+    int decimation;      /* fs_in / fs_out */
+} iirdsp_pipeline_t;
+
+/**
+ * Compile a pipeline description
+ *
+ * @param p Pipeline to build
+ * @param text Description (see file comment)
+ * @param error_line If not NULL, receives the 1-based line of the first
+ *                   error, or 0 on success
+ * @return 0 on success, -1 on a syntax error, -2 if a stage cannot be
+ *         designed, -3 if the pipeline exceeds IIRDSP_PIPELINE_MAX_OPS
+ */
+int iirdsp_pipeline_compile(iirdsp_pipeline_t* p, const char* text, int* error_line);
+
+/**
+ * Clear all filter state and decimation phases
+ *
+ * @param p Pipeline
+ */
+void iirdsp_pipeline_reset(iirdsp_pipeline_t* p);
+
+/**
+ * Upper bound on the outputs produced from N inputs
+ *
+ * @param p Pipeline
+ * @param N Number of input samples
+ * @return Maximum number of output samples
+ */
+int iirdsp_pipeline_max_output(const iirdsp_pipeline_t* p, int N);
+
+/**
+ * Run a block through the whole pipeline
+ *
+ * State and decimation phase carry across calls.
+ *
+ * @param p Pipeline
+ * @param x Input samples at fs_in (length N)
+ * @param N Number of input samples
+ * @param y Output samples at fs_out, can alias x; must hold
+ *          iirdsp_pipeline_max_output(p, N) samples
+ * @return Number of output samples written
+ */
+int iirdsp_pipeline_process(
+    iirdsp_pipeline_t* p,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_real* y
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_PIPELINE_H */
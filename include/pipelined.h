@@ -0,0 +1,119 @@
+/**
+ * @file pipelined.h
+ * @brief Pipeline-parallel execution of one long cascade
+ *
+ * A cascade too long for one core (several iirdsp_filter_t run back to
+ * back on one high-rate stream) is split into num_stages groups of
+ * consecutive sections. The calling thread runs the first group, and each
+ * other group runs on its own thread. Blocks of block_size samples pass
+ * from stage to stage through lock-free single-producer/single-consumer
+ * queues, so all stages work on different blocks at the same time and
+ * throughput scales with the number of stages.
+ *
+ * The price is latency: the output lags the input by
+ * (num_stages - 1) * block_size samples (see iirdsp_pipelined_latency()).
+ * Smaller blocks mean less latency but more hand-offs per sample.
+ *
+ * The output is bit-identical to running the filters one after the other
+ * with iirdsp_process_buffer(), delayed by the latency.
+ *
+ * Host-only: links against iirdsp_host; not available in EMBEDDED_BUILD
+ * configurations.
+ */
+
+#ifndef IIRDSP_PIPELINED_H
+#define IIRDSP_PIPELINED_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of stages
+ */
+#ifndef IIRDSP_PIPELINED_MAX_STAGES
+#define IIRDSP_PIPELINED_MAX_STAGES 16
+#endif
+
+/**
+ * Opaque pipelined cascade
+ */
+typedef struct iirdsp_pipelined iirdsp_pipelined_t;
+
+/**
+ * Split a cascade into stages and start the stage threads
+ *
+ * Sections are divided as evenly as possible; section counts differ by at
+ * most one between stages. The filters' coefficients and current state
+ * are copied.
+ *
+ * @param filters Cascade, in processing order
+ * @param num_filters Number of filters
+ * @param num_stages Number of stages (1..IIRDSP_PIPELINED_MAX_STAGES, at
+ *                   most the total number of sections); 1 runs everything
+ *                   on the calling thread with no latency
+ * @param block_size Samples per block handed between stages (> 0)
+ * @return New pipeline, or NULL on invalid arguments or if allocation or
+ *         thread creation fails
+ */
+iirdsp_pipelined_t* iirdsp_pipelined_create(
+    const iirdsp_filter_t* filters,
+    int num_filters,
+    int num_stages,
+    int block_size
+);
+
+/**
+ * Stop the stage threads and free the pipeline
+ *
+ * @param p Pipeline, or NULL
+ */
+void iirdsp_pipelined_destroy(iirdsp_pipelined_t* p);
+
+/**
+ * Delay of the output relative to the input
+ *
+ * @param p Pipeline
+ * @return Latency in samples: (num_stages - 1) * block_size
+ */
+int iirdsp_pipelined_latency(const iirdsp_pipelined_t* p);
+
+/**
+ * Stream samples through the pipeline
+ *
+ * Any N is accepted; a partial block is kept until later calls fill it.
+ * y[n] is the cascade output for the input sample latency samples before
+ * x[n] in the stream, or 0 while the stream is younger than the latency.
+ * Feed latency more samples (for example zeros) to flush the tail.
+ *
+ * Only one thread may call this at a time.
+ *
+ * @param p Pipeline
+ * @param x Input samples (length N)
+ * @param y Output samples (length N), can alias x
+ * @param N Number of samples
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_pipelined_process(
+    iirdsp_pipelined_t* p,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+);
+
+/**
+ * Wait for the blocks in flight, then clear all filter state and restart
+ * the stream (the next output is again latency samples behind)
+ *
+ * @param p Pipeline
+ */
+void iirdsp_pipelined_reset(iirdsp_pipelined_t* p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_PIPELINED_H */
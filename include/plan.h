@@ -0,0 +1,156 @@
+/**
+ * @file plan.h
+ * @brief Execution plans with measured kernel selection and wisdom files
+ *
+ * Host-only: measuring uses the process clock, wisdom is kept in a
+ * mutex-protected table and can be saved to files. Links against
+ * iirdsp_host; not available in EMBEDDED_BUILD configurations.
+ */
+
+#ifndef IIRDSP_PLAN_H
+#define IIRDSP_PLAN_H
+
+#include <stddef.h>
+#include "config.h"
+#include "sos.h"
+#include "multi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Buffer kernels a plan can choose from
+ *
+ * All produce the same output and final state; they differ only in speed.
+ */
+typedef enum {
+    IIRDSP_KERNEL_SCALAR = 0,  /* iirdsp_process_buffer(), per channel */
+    IIRDSP_KERNEL_WAVEFRONT,   /* iirdsp_process_buffer_wavefront(), per channel */
+    IIRDSP_KERNEL_TILED,       /* iirdsp_process_buffer_tiled(), per channel */
+    IIRDSP_KERNEL_STREAM,      /* iirdsp_process_buffer_stream(), per channel */
+    IIRDSP_KERNEL_LANES,       /* IIRDSP_LANES channels at a time in SIMD lanes */
+    IIRDSP_KERNEL_COUNT
+} iirdsp_kernel_t;
+
+/**
+ * Planning flags (combine with |)
+ */
+#define IIRDSP_PLAN_ESTIMATE    0x00u  /* Pick a kernel by heuristic */
+#define IIRDSP_PLAN_MEASURE     0x01u  /* Time every candidate kernel */
+#define IIRDSP_PLAN_WISDOM_ONLY 0x02u  /* Fail unless wisdom has an entry */
+#define IIRDSP_PLAN_INTERLEAVED 0x10u  /* x and y are interleaved, not planar */
+
+/**
+ * A filtering plan for a fixed channel count and block size
+ *
+ * The plan refers to the caller's filters, which keep their coefficients
+ * and state; executing the plan advances that state like the per-channel
+ * iirdsp_process_buffer() calls it replaces.
+ */
+typedef struct {
+    iirdsp_filter_t* filters;  /* One per channel, owned by the caller */
+    int channels;
+    int block_size;            /* Samples per channel per execute */
+    iirdsp_layout_t layout;
+    iirdsp_kernel_t kernel;    /* Chosen kernel */
+    int tile;                  /* Tile length for IIRDSP_KERNEL_TILED */
+    iirdsp_real* work;         /* Gather/lane workspace (NULL if unused) */
+} iirdsp_plan_t;
+
+/**
+ * Create a plan
+ *
+ * With IIRDSP_PLAN_MEASURE every applicable kernel is timed on a copy of
+ * the filters and the winner is recorded as wisdom; later plans with the
+ * same shape (section count, channels, block size, layout) reuse it
+ * without measuring. The filters are not modified.
+ *
+ * @param filters One filter per channel (channels entries)
+ * @param channels Number of channels (>= 1)
+ * @param block_size Samples per channel per execute (>= 1)
+ * @param flags IIRDSP_PLAN_* flags
+ * @return New plan, or NULL on invalid arguments, allocation failure, or
+ *         missing wisdom with IIRDSP_PLAN_WISDOM_ONLY
+ */
+iirdsp_plan_t* iirdsp_plan_create(
+    iirdsp_filter_t* filters,
+    int channels,
+    int block_size,
+    unsigned flags
+);
+
+/**
+ * Filter one block with the planned kernel
+ *
+ * @param p Plan
+ * @param x Input (channels * block_size samples, planar or interleaved)
+ * @param y Output in the same layout, can alias x
+ */
+void iirdsp_plan_execute(const iirdsp_plan_t* p, const iirdsp_real* x, iirdsp_real* y);
+
+/**
+ * Free a plan (the filters are not touched)
+ *
+ * @param p Plan, or NULL
+ */
+void iirdsp_plan_destroy(iirdsp_plan_t* p);
+
+/**
+ * Short name of a kernel, as used in wisdom text
+ *
+ * @param k Kernel
+ * @return Static string, or "unknown"
+ */
+const char* iirdsp_kernel_name(iirdsp_kernel_t k);
+
+/**
+ * Write the accumulated wisdom as text
+ *
+ * Follows snprintf(): at most size bytes including the terminator are
+ * written, and the full length is returned.
+ *
+ * @param buf Destination, or NULL with size 0 to query the length
+ * @param size Capacity of buf
+ * @return Length of the wisdom text, excluding the terminator
+ */
+int iirdsp_wisdom_export(char* buf, size_t size);
+
+/**
+ * Merge wisdom text into the table
+ *
+ * Wisdom from a build with a different precision or lane count is
+ * rejected as a whole.
+ *
+ * @param text Text produced by iirdsp_wisdom_export()
+ * @return Number of entries imported, or -1 if the text is malformed or
+ *         from an incompatible build
+ */
+int iirdsp_wisdom_import(const char* text);
+
+/**
+ * Save the wisdom table to a file
+ *
+ * @param path File to (over)write
+ * @return 0 on success, -1 on I/O error
+ */
+int iirdsp_wisdom_export_to_file(const char* path);
+
+/**
+ * Load wisdom from a file saved by iirdsp_wisdom_export_to_file()
+ *
+ * @param path File to read
+ * @return Number of entries imported, or -1 on I/O or format error
+ */
+int iirdsp_wisdom_import_from_file(const char* path);
+
+/**
+ * Discard all wisdom
+ */
+void iirdsp_wisdom_forget(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_PLAN_H */
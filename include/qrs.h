@@ -0,0 +1,154 @@
+/**
+ * @file qrs.h
+ * @brief Streaming Pan-Tompkins QRS detector built on the SOS engine
+ */
+
+#ifndef IIRDSP_QRS_H
+#define IIRDSP_QRS_H
+
+#include "config.h"
+#include "sos.h"
+#include "multi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Longest moving-window integrator (samples)
+ * The 150 ms window must fit, so the detector supports fs up to ~2 kHz.
+ */
+#ifndef IIRDSP_QRS_MAX_WINDOW
+#define IIRDSP_QRS_MAX_WINDOW 320
+#endif
+
+/**
+ * Adaptive threshold and peak-search state of one channel
+ */
+typedef struct {
+    long n;                  /* Samples seen since init */
+    long learn_until;        /* End of the threshold training period */
+    long refractory;         /* Minimum R-R distance (samples) */
+    long last_qrs;           /* Index of the last detected R peak */
+    iirdsp_real spki;        /* Running signal peak level */
+    iirdsp_real npki;        /* Running noise peak level */
+    iirdsp_real threshold;   /* npki + 0.25 * (spki - npki) */
+    iirdsp_real learn_max;   /* Training: largest integrated value */
+    iirdsp_real learn_sum;   /* Training: sum of integrated values */
+    iirdsp_real peak_val;    /* Current integrated-signal peak */
+    long peak_n;             /* Index of the current integrated-signal peak */
+    iirdsp_real bp_max;      /* Largest |band-pass| in the current peak */
+    long bp_max_n;           /* Index of that sample */
+    int rising;              /* Searching for a peak (1) or past one (0) */
+    long delay;              /* Band-pass group delay (samples) */
+} iirdsp_qrs_detect_t;
+
+/**
+ * Single-channel streaming QRS detector
+ *
+ * Band-pass (5-15 Hz Butterworth), derivative, squaring and 150 ms
+ * moving-window integration run fused in one per-sample loop with
+ * constant memory; R peaks are then picked by the adaptive Pan-Tompkins
+ * threshold on the integrated signal. The first 2 s train the thresholds
+ * and produce no detections.
+ */
+typedef struct {
+    iirdsp_filter_t bandpass;
+    iirdsp_real hist[4];                     /* Last 4 band-pass outputs */
+    iirdsp_real ring[IIRDSP_QRS_MAX_WINDOW]; /* Squared derivative window */
+    iirdsp_real sum;                         /* Sum over ring */
+    int window;                              /* Integrator length (samples) */
+    int pos;                                 /* Next ring slot */
+    iirdsp_qrs_detect_t det;
+} iirdsp_qrs_t;
+
+/**
+ * Detected R peak in a multi-channel bank
+ */
+typedef struct {
+    int channel;   /* Channel within the bank */
+    long index;    /* Sample index since init */
+} iirdsp_qrs_peak_t;
+
+/**
+ * Up to IIRDSP_LANES QRS detectors sharing one fused SIMD front end
+ *
+ * Band-pass, derivative, squaring and integration run with channels in
+ * SIMD lanes; only the threshold logic is per channel.
+ */
+typedef struct {
+    iirdsp_lanes_t bandpass;
+    iirdsp_real hist[4][IIRDSP_LANES];
+    iirdsp_real ring[IIRDSP_QRS_MAX_WINDOW][IIRDSP_LANES];
+    iirdsp_real sum[IIRDSP_LANES];
+    int window;
+    int pos;
+    int channels;
+    iirdsp_qrs_detect_t det[IIRDSP_LANES];
+} iirdsp_qrs_bank_t;
+
+/**
+ * Initialize a single-channel detector
+ *
+ * @param q Detector to initialize
+ * @param fs_hz Sampling frequency (Hz)
+ * @return 0 on success, -1 if fs_hz is outside the supported range
+ */
+int iirdsp_qrs_init(iirdsp_qrs_t* q, iirdsp_real fs_hz);
+
+/**
+ * Feed a block of raw ECG and collect detected R peaks
+ *
+ * Peaks are reported once confirmed, which is shortly after the QRS
+ * complex; indices are compensated for the band-pass delay.
+ *
+ * @param q Detector
+ * @param x Raw ECG samples (length N)
+ * @param N Number of samples
+ * @param peaks Output R-peak sample indices (since init)
+ * @param max_peaks Capacity of peaks; extra detections are dropped
+ * @return Number of peaks written
+ */
+int iirdsp_qrs_process(
+    iirdsp_qrs_t* q,
+    const iirdsp_real* x,
+    int N,
+    long* peaks,
+    int max_peaks
+);
+
+/**
+ * Initialize a multi-channel detector bank
+ *
+ * @param b Bank to initialize
+ * @param channels Number of channels (1..IIRDSP_LANES)
+ * @param fs_hz Sampling frequency (Hz)
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_qrs_bank_init(iirdsp_qrs_bank_t* b, int channels, iirdsp_real fs_hz);
+
+/**
+ * Feed a multi-channel block and collect detected R peaks
+ *
+ * @param b Bank
+ * @param x Raw samples for all bank channels (channels * N)
+ * @param N Samples per channel
+ * @param layout Layout of x (planar or interleaved)
+ * @param peaks Output peaks
+ * @param max_peaks Capacity of peaks; extra detections are dropped
+ * @return Number of peaks written
+ */
+int iirdsp_qrs_bank_process(
+    iirdsp_qrs_bank_t* b,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_layout_t layout,
+    iirdsp_qrs_peak_t* peaks,
+    int max_peaks
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_QRS_H */
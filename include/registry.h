@@ -0,0 +1,157 @@
+/**
+ * @file registry.h
+ * @brief Shared-memory registry of designed coefficient sets
+ *
+ * Pre-forked workers that all use the same filters can design each one
+ * once and share a single copy: the registry is a POSIX shared-memory
+ * segment holding an open-addressing table of designed filters keyed by
+ * a hash of their design spec. Lookups are lock-free (plain loads); an
+ * insert claims a slot with one CAS and publishes it with a release
+ * store, so readers never see a half-written entry. Workers that only
+ * read can map the segment read-only.
+ *
+ * The segment stores iirdsp_real values in the build's precision, so all
+ * processes sharing it must be built with the same IIRDSP_USE_FLOAT
+ * setting; opening a segment written by the other precision fails.
+ *
+ * Host-only: links against iirdsp_host; not available in EMBEDDED_BUILD
+ * configurations.
+ */
+
+#ifndef IIRDSP_REGISTRY_H
+#define IIRDSP_REGISTRY_H
+
+#include <stdint.h>
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Filter families a spec can describe
+ */
+typedef enum {
+    IIRDSP_SPEC_LOWPASS = 0,   /* butter_lowpass_init(order, f1) */
+    IIRDSP_SPEC_HIGHPASS = 1,  /* butter_highpass_init(order, f1) */
+    IIRDSP_SPEC_BANDPASS = 2,  /* butter_bandpass_init(order, f1, f2) */
+    IIRDSP_SPEC_NOTCH = 3      /* notch_filter_init(f1, Q = f2); order ignored */
+} iirdsp_spec_kind_t;
+
+/**
+ * Design parameters identifying one coefficient set
+ */
+typedef struct {
+    int kind;        /* iirdsp_spec_kind_t */
+    int order;
+    double f1;       /* Cutoff, low edge or notch frequency (Hz) */
+    double f2;       /* High edge (Hz) or notch Q; 0 otherwise */
+    double fs;       /* Sampling rate (Hz) */
+} iirdsp_spec_t;
+
+/**
+ * Opaque handle to a mapped registry
+ */
+typedef struct iirdsp_registry iirdsp_registry_t;
+
+/**
+ * Hash of a design spec
+ *
+ * @param spec Spec
+ * @return Non-zero 64-bit hash
+ */
+uint64_t iirdsp_spec_hash(const iirdsp_spec_t* spec);
+
+/**
+ * Design the filter a spec describes
+ *
+ * @param spec Spec
+ * @param f Filter to initialize
+ * @return 0 on success, -1 for an unknown kind, or the design function's
+ *         error code
+ */
+int iirdsp_spec_design(const iirdsp_spec_t* spec, iirdsp_filter_t* f);
+
+/**
+ * Create a new registry segment and map it read-write
+ *
+ * Fails if a segment with that name already exists; remove stale
+ * segments with iirdsp_registry_unlink() first. Typically called by the
+ * parent before forking workers.
+ *
+ * @param name Segment name, "/name" as for shm_open()
+ * @param capacity Maximum number of coefficient sets (rounded up to a
+ *                 power of two, at least 2x for probing)
+ * @return Handle, or NULL on failure
+ */
+iirdsp_registry_t* iirdsp_registry_create(const char* name, int capacity);
+
+/**
+ * Map an existing registry segment
+ *
+ * @param name Segment name
+ * @param writable Nonzero to allow iirdsp_registry_get() to insert
+ * @return Handle, or NULL if the segment is missing, not a registry, or
+ *         from a build with a different precision
+ */
+iirdsp_registry_t* iirdsp_registry_open(const char* name, int writable);
+
+/**
+ * Unmap a registry; the segment stays until unlinked
+ *
+ * @param r Handle, or NULL
+ */
+void iirdsp_registry_close(iirdsp_registry_t* r);
+
+/**
+ * Remove a registry segment name
+ *
+ * Processes that have it mapped keep using it.
+ *
+ * @param name Segment name
+ * @return 0 on success, -1 on failure
+ */
+int iirdsp_registry_unlink(const char* name);
+
+/**
+ * Find a designed coefficient set (lock-free)
+ *
+ * @param r Registry
+ * @param spec Spec
+ * @return Shared filter (coefficients, zero state) or NULL if absent.
+ *         The memory is shared and possibly read-only: copy it into a
+ *         private iirdsp_filter_t, or pass it to APIs that only read
+ *         coefficients (iirdsp_lanes_load(), iirdsp_engine_add_coeffs()).
+ */
+const iirdsp_filter_t* iirdsp_registry_lookup(const iirdsp_registry_t* r, const iirdsp_spec_t* spec);
+
+/**
+ * Find a coefficient set, designing and inserting it if absent
+ *
+ * When several processes ask for the same missing spec at once, one
+ * designs it and the others wait for it to be published. If the designing
+ * process dies first, a waiter takes the entry over and designs it; a
+ * waiter gives up (NULL) only if the designer is alive but does not finish
+ * within about a million scheduler yields.
+ *
+ * @param r Registry
+ * @param spec Spec
+ * @return Shared filter, or NULL if the design fails, the registry is
+ *         full, or it is absent and r is read-only
+ */
+const iirdsp_filter_t* iirdsp_registry_get(iirdsp_registry_t* r, const iirdsp_spec_t* spec);
+
+/**
+ * Number of coefficient sets in the registry
+ *
+ * @param r Registry
+ * @return Published entries
+ */
+int iirdsp_registry_count(const iirdsp_registry_t* r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_REGISTRY_H */
@@ -0,0 +1,100 @@
+/**
+ * @file resample.h
+ * @brief Rational sample-rate conversion with Butterworth anti-aliasing
+ */
+
+#ifndef IIRDSP_RESAMPLE_H
+#define IIRDSP_RESAMPLE_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Streaming L/M resampler
+ *
+ * The input is upsampled by L (zero insertion), low-pass filtered at the
+ * intermediate rate fs_in * L by a Butterworth cascade, and every M-th
+ * sample is kept, with L / M = fs_out / fs_in reduced by their gcd. The
+ * cascade runs at the intermediate rate, but inserted zeros skip the
+ * feed-forward terms of its first section and only kept samples are
+ * written. An optional post-filter at the output rate runs on each kept
+ * sample in the same loop, so no intermediate buffer is needed.
+ */
+typedef struct {
+    iirdsp_filter_t aa;     /* Anti-alias / anti-image low-pass */
+    iirdsp_filter_t post;   /* Output-rate cascade (valid if has_post) */
+    int has_post;
+    int up;                 /* L */
+    int down;               /* M */
+    int skip;               /* Intermediate samples until the next output */
+} iirdsp_resampler_t;
+
+/**
+ * Initialize a resampler
+ *
+ * @param r Resampler to initialize
+ * @param fs_in_hz Input rate (Hz, integer)
+ * @param fs_out_hz Output rate (Hz, integer)
+ * @param order Butterworth order of the anti-alias filter (0 for none,
+ *              only valid when L == M == 1)
+ * @param cutoff_hz Anti-alias cutoff (Hz), or <= 0 for 0.4 * the lower
+ *                  of the two rates
+ * @param post Cascade designed for fs_out_hz to apply after resampling,
+ *             or NULL; it is copied, including its state
+ * @return 0 on success, -1 on invalid arguments, -2 if the anti-alias
+ *         filter cannot be designed
+ */
+int iirdsp_resampler_init(
+    iirdsp_resampler_t* r,
+    int fs_in_hz,
+    int fs_out_hz,
+    int order,
+    iirdsp_real cutoff_hz,
+    const iirdsp_filter_t* post
+);
+
+/**
+ * Clear filter state and restart the output phase
+ *
+ * @param r Resampler
+ */
+void iirdsp_resampler_reset(iirdsp_resampler_t* r);
+
+/**
+ * Upper bound on the outputs produced from N inputs
+ *
+ * @param r Resampler
+ * @param N Number of input samples
+ * @return Maximum number of output samples
+ */
+int iirdsp_resampler_max_output(const iirdsp_resampler_t* r, int N);
+
+/**
+ * Resample a block
+ *
+ * Blocks may have any length; the output phase carries over, so splitting
+ * the input does not change the output.
+ *
+ * @param r Resampler
+ * @param x Input samples at fs_in (length N)
+ * @param N Number of input samples
+ * @param y Output samples at fs_out; must hold
+ *          iirdsp_resampler_max_output(r, N) samples and not alias x
+ * @return Number of output samples written
+ */
+int iirdsp_resampler_process(
+    iirdsp_resampler_t* r,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_real* y
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_RESAMPLE_H */
@@ -0,0 +1,144 @@
+/**
+ * @file serialize.h
+ * @brief Compact binary snapshots of filter coefficients and state
+ *
+ * A snapshot lets a stream continue on another thread, process or host
+ * exactly where it stopped, without a start-up transient. The format is
+ * versioned and byte-order independent: every value is an IEEE-754
+ * number stored little-endian, in the precision of the build that wrote
+ * it. Readers of either precision accept both.
+ *
+ * Single filter (8-byte header):
+ *   "IIRS", version, flags, num_sections, 0,
+ *   then per section [b0 b1 b2 a1 a2] if IIRDSP_SERIAL_COEFFS,
+ *   and [z1 z2] if IIRDSP_SERIAL_STATE.
+ *
+ * Bank (12-byte header):
+ *   "IIRB", version, flags, 0, 0, count (uint32),
+ *   then per filter num_sections (1 byte) and its sections as above.
+ *
+ * Flags bit 0 and 1 are the IIRDSP_SERIAL_* parts present; bit 2 marks
+ * 4-byte float values (8-byte double otherwise).
+ *
+ * Portable: works on caller buffers only, no allocation or I/O.
+ */
+
+#ifndef IIRDSP_SERIALIZE_H
+#define IIRDSP_SERIALIZE_H
+
+#include <stddef.h>
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Format version written by this library
+ */
+#define IIRDSP_SERIAL_VERSION 1
+
+/**
+ * Parts of a filter to serialize
+ */
+#define IIRDSP_SERIAL_COEFFS 0x1
+#define IIRDSP_SERIAL_STATE  0x2
+#define IIRDSP_SERIAL_ALL    (IIRDSP_SERIAL_COEFFS | IIRDSP_SERIAL_STATE)
+
+/**
+ * Bytes iirdsp_serialize() writes
+ *
+ * @param f Filter
+ * @param what IIRDSP_SERIAL_* parts
+ * @return Snapshot size in bytes
+ */
+long iirdsp_serialized_size(const iirdsp_filter_t* f, int what);
+
+/**
+ * Write a snapshot of one filter
+ *
+ * A state-only snapshot (IIRDSP_SERIAL_STATE) is enough to move a stream
+ * whose coefficients the destination already has.
+ *
+ * @param f Filter
+ * @param what IIRDSP_SERIAL_* parts, at least one
+ * @param buf Destination
+ * @param size Capacity of buf
+ * @return Bytes written, -1 for invalid arguments, -2 if buf is too small
+ */
+long iirdsp_serialize(const iirdsp_filter_t* f, int what, unsigned char* buf, size_t size);
+
+/**
+ * Restore a filter from a snapshot
+ *
+ * Coefficients in the snapshot replace f's coefficients and section
+ * count; without state in the snapshot the state is zeroed. A state-only
+ * snapshot keeps f's coefficients and requires the same section count.
+ * f is unchanged on error.
+ *
+ * @param f Filter to restore into
+ * @param buf Snapshot
+ * @param size Bytes available in buf
+ * @return Bytes consumed, -1 if buf is not a supported snapshot, -2 if it
+ *         is truncated, -3 if a state-only snapshot does not match f
+ */
+long iirdsp_deserialize(iirdsp_filter_t* f, const unsigned char* buf, size_t size);
+
+/**
+ * Bytes iirdsp_serialize_bank() writes
+ *
+ * @param filters Filter array
+ * @param count Number of filters
+ * @param what IIRDSP_SERIAL_* parts
+ * @return Snapshot size in bytes
+ */
+long iirdsp_bank_serialized_size(const iirdsp_filter_t* filters, int count, int what);
+
+/**
+ * Write a snapshot of a filter bank
+ *
+ * @param filters Filter array
+ * @param count Number of filters
+ * @param what IIRDSP_SERIAL_* parts, at least one
+ * @param buf Destination
+ * @param size Capacity of buf
+ * @return Bytes written, -1 for invalid arguments, -2 if buf is too small
+ */
+long iirdsp_serialize_bank(
+    const iirdsp_filter_t* filters,
+    int count,
+    int what,
+    unsigned char* buf,
+    size_t size
+);
+
+/**
+ * Restore a filter bank
+ *
+ * Each filter is restored as by iirdsp_deserialize(). The bank is
+ * validated before any filter is written, so filters are unchanged on
+ * error.
+ *
+ * @param filters Filter array to restore into
+ * @param max_count Capacity of filters
+ * @param buf Snapshot
+ * @param size Bytes available in buf
+ * @param count Receives the number of filters restored
+ * @return Bytes consumed, -1 if buf is not a supported bank snapshot, -2
+ *         if it is truncated, -3 if it holds more than max_count filters
+ *         or a state-only record does not match its filter
+ */
+long iirdsp_deserialize_bank(
+    iirdsp_filter_t* filters,
+    int max_count,
+    const unsigned char* buf,
+    size_t size,
+    int* count
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_SERIALIZE_H */
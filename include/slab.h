@@ -0,0 +1,129 @@
+/**
+ * @file slab.h
+ * @brief Fixed-size slab allocator for filter states and coefficient blocks
+ *
+ * Host-only: uses POSIX threads for the shared depot and per-thread
+ * magazines. Links against iirdsp_host; not available in EMBEDDED_BUILD
+ * configurations.
+ */
+
+#ifndef IIRDSP_SLAB_H
+#define IIRDSP_SLAB_H
+
+#include <stddef.h>
+#include "config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Bytes per slab page (power of two); pages are aligned to their size so
+ * an object's page is found by masking its address. Slabs of large
+ * objects use the next power of two that holds eight of them.
+ */
+#ifndef IIRDSP_SLAB_PAGE_BYTES
+#define IIRDSP_SLAB_PAGE_BYTES (64 * 1024)
+#endif
+
+/**
+ * Objects a per-thread magazine holds before returning half to the depot
+ */
+#ifndef IIRDSP_SLAB_MAGAZINE
+#define IIRDSP_SLAB_MAGAZINE 32
+#endif
+
+/**
+ * Opaque slab allocator
+ */
+typedef struct iirdsp_slab iirdsp_slab_t;
+
+/**
+ * Callback for iirdsp_slab_foreach()
+ *
+ * @param user User pointer
+ * @param obj Live object
+ */
+typedef void (*iirdsp_slab_visit_fn)(void* user, void* obj);
+
+/**
+ * Create a slab for objects of one size
+ *
+ * Objects are rounded up to whole cache lines and start on a cache-line
+ * boundary, so objects used by different threads never share a line.
+ * All slabs share one thread-specific key, so the number of slabs alive
+ * at once is limited only by memory.
+ *
+ * @param object_size Object size in bytes
+ * @return New slab, or NULL if object_size is 0 or over 1 GiB, or on
+ *         allocation failure
+ */
+iirdsp_slab_t* iirdsp_slab_create(size_t object_size);
+
+/**
+ * Free a slab and every object in it
+ *
+ * No thread may use the slab during or after this call.
+ *
+ * @param s Slab, or NULL
+ */
+void iirdsp_slab_destroy(iirdsp_slab_t* s);
+
+/**
+ * Allocate one object
+ *
+ * O(1): pops the calling thread's magazine, refilling it from the shared
+ * depot in batches. New pages are added when the depot is empty. Contents
+ * are not initialized.
+ *
+ * @param s Slab
+ * @return Cache-line aligned object, or NULL on allocation failure
+ */
+void* iirdsp_slab_alloc(iirdsp_slab_t* s);
+
+/**
+ * Return an object to the slab
+ *
+ * O(1): pushes onto the calling thread's magazine. Any thread may free an
+ * object allocated by another.
+ *
+ * @param s Slab the object came from
+ * @param obj Object, or NULL
+ */
+void iirdsp_slab_free(iirdsp_slab_t* s, void* obj);
+
+/**
+ * Visit every live object, page by page, in address order within a page
+ *
+ * Objects of a page are contiguous, so a batch kernel walking the slab
+ * touches memory sequentially. Must not run concurrently with alloc or
+ * free on the same slab.
+ *
+ * @param s Slab
+ * @param visit Called once per live object
+ * @param user Passed to visit
+ * @return Number of live objects visited
+ */
+long iirdsp_slab_foreach(iirdsp_slab_t* s, iirdsp_slab_visit_fn visit, void* user);
+
+/**
+ * Number of live objects
+ *
+ * @param s Slab
+ * @return Objects allocated and not yet freed
+ */
+long iirdsp_slab_live(const iirdsp_slab_t* s);
+
+/**
+ * Padded size of one object in bytes
+ *
+ * @param s Slab
+ * @return Object stride (a multiple of IIRDSP_CACHE_LINE)
+ */
+size_t iirdsp_slab_object_size(const iirdsp_slab_t* s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_SLAB_H */
@@ -40,6 +40,18 @@ typedef struct {
     int num_sections;
 } iirdsp_filter_t;
 
+/**
+ * Work-saved counters for the idle-channel fast path
+ *
+ * Accumulated by iirdsp_process_buffer_idle(); share one instance across
+ * channels to see how much of a bank was skipped. Zero before first use.
+ */
+typedef struct {
+    unsigned long blocks_total;     /* Blocks submitted */
+    unsigned long blocks_skipped;   /* Blocks produced analytically */
+    unsigned long samples_skipped;  /* Samples in skipped blocks */
+} iirdsp_idle_stats_t;
+
 /**
  * Initialize filter state (zero all state variables)
  *
@@ -97,6 +109,9 @@ static inline void iirdsp_filter_reset(iirdsp_filter_t* f)
 /**
  * Process a buffer of samples through the filter
  *
+ * Buffers of IIRDSP_STREAM_THRESHOLD samples or more are routed through
+ * iirdsp_process_buffer_stream().
+ *
  * @param f Filter pointer
  * @param x Input signal (length N)
  * @param y Output signal (length N)
@@ -109,6 +124,158 @@ void iirdsp_process_buffer(
     int N
 );
 
+/**
+ * Process a buffer of samples with the wavefront (skewed-pipeline) kernel
+ *
+ * Places each section in its own SIMD lane: section k processes sample
+ * n-k while section k+1 processes n-k-1. Fill and drain are handled at the
+ * buffer edges, so output and final state match iirdsp_process_buffer()
+ * and calls can be mixed freely on the same filter.
+ *
+ * Best suited to single-stream, high-order filters. Falls back to
+ * iirdsp_process_buffer() for single-section filters.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ */
+void iirdsp_process_buffer_wavefront(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+);
+
+/**
+ * Process a buffer of samples section-major over cache-sized tiles
+ *
+ * For each tile, section 1 runs over the whole tile, then section 2 over
+ * the same tile (in place in y), and so on, carrying state between tiles.
+ * The inner loop is a single biquad with coefficients held in registers.
+ * Output and final state match iirdsp_process_buffer().
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ * @param tile Tile length in samples (<= 0 selects IIRDSP_TILE_DEFAULT)
+ */
+void iirdsp_process_buffer_tiled(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    int tile
+);
+
+/**
+ * Pick the fastest tile length for iirdsp_process_buffer_tiled()
+ *
+ * Times power-of-two tile lengths from 64 up to N on a synthetic signal
+ * using a copy of the filter (f is not modified). Intended for start-up
+ * calibration, not the signal path.
+ *
+ * @param f Filter whose section count is tuned for
+ * @param work Scratch buffer (length N), overwritten
+ * @param N Scratch length; larger values give more stable timings
+ * @return Best tile length in samples, or IIRDSP_TILE_DEFAULT if N is too small
+ */
+int iirdsp_tile_autotune(
+    const iirdsp_filter_t* f,
+    iirdsp_real* work,
+    int N
+);
+
+/**
+ * Process a large buffer with non-temporal output stores
+ *
+ * Same result as iirdsp_process_buffer(), but the output bypasses the
+ * cache via streaming stores and the input is software-prefetched.
+ * Intended for buffers far larger than the last-level cache, where
+ * ordinary stores evict useful data and cost read-for-ownership traffic.
+ * On targets without streaming stores this is an ordinary buffer loop.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ */
+void iirdsp_process_buffer_stream(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+);
+
+/**
+ * DC gain of the whole cascade
+ *
+ * Product over sections of (b0 + b1 + b2) / (1 + a1 + a2).
+ *
+ * @param f Filter pointer
+ * @return Gain at 0 Hz (0 for filters with a zero at DC)
+ */
+iirdsp_real iirdsp_dc_gain(const iirdsp_filter_t* f);
+
+/**
+ * Process a buffer, skipping the cascade for idle (flat) channels
+ *
+ * If every input sample equals x[0] and every section's z1/z2 is within
+ * eps of the steady state for that constant input, the block is produced
+ * analytically: each output is iirdsp_dc_gain(f) * x[0] (zero for a zero
+ * input), and the state is snapped to the exact steady state. Otherwise
+ * the block is filtered normally with iirdsp_process_buffer().
+ *
+ * The deviation from full filtering is bounded by the eps-sized transient
+ * that snapping discards.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ * @param eps State tolerance below which the cascade counts as settled
+ * @param stats Counters to update, may be NULL
+ * @return 1 if the block was skipped, 0 if it was filtered
+ */
+int iirdsp_process_buffer_idle(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_real eps,
+    iirdsp_idle_stats_t* stats
+);
+
+/**
+ * Largest pole radius over all sections
+ *
+ * @param f Filter pointer
+ * @return max |p| over the roots of z^2 + a1*z + a2; >= 1 means unstable
+ */
+iirdsp_real iirdsp_pole_radius(const iirdsp_filter_t* f);
+
+/**
+ * Effective impulse-response length for a given tolerance
+ *
+ * Returns the smallest W such that sum over n >= W of |h[n]| <= tol,
+ * where h is the cascade's impulse response. The response is simulated
+ * until the mass still to come, bounded from the cascade state and each
+ * section's pole radii, is small enough; the result is therefore an upper
+ * bound on the true W (up to rounding), not an estimate.
+ *
+ * Because |y_true[n] - y_warm[n]| <= tol * max|x| when a zero-state filter
+ * is warmed up on the W preceding samples, W is the overlap needed for
+ * chunked (parallel) filtering with a guaranteed error, and the edge
+ * padding / transient length to discard around filtfilt.
+ *
+ * @param f Filter pointer (state is not used or modified)
+ * @param tol L1 tail tolerance (relative to unit input amplitude), > 0
+ * @return W in samples, or -1 if the filter is not stable or its tail
+ *         does not fall below tol within 2^28 samples
+ */
+int iirdsp_impulse_length(const iirdsp_filter_t* f, iirdsp_real tol);
+
 /**
  * Zero-phase filtering via forward-backward filtering (filtfilt)
  *
@@ -116,9 +283,10 @@ void iirdsp_process_buffer(
  * Algorithm:
  *   1. Forward filter x → temp
  *   2. Reset state
- *   3. Reverse temp
- *   4. Filter reversed → y
- *   5. Reverse y in-place
+ *   3. Filter temp from last to first sample → y (no explicit reversal)
+ *
+ * Both passes use streaming stores for buffers of IIRDSP_STREAM_THRESHOLD
+ * samples or more.
  *
  * @param f Filter pointer
  * @param x Input signal (length N)
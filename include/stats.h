@@ -0,0 +1,103 @@
+/**
+ * @file stats.h
+ * @brief Running output statistics fused into filtering
+ */
+
+#ifndef IIRDSP_STATS_H
+#define IIRDSP_STATS_H
+
+#include "config.h"
+#include "sos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Statistic selection flags (combine with |)
+ */
+#define IIRDSP_STAT_SUM            0x01u  /* Sum of outputs (mean) */
+#define IIRDSP_STAT_SUM_SQ         0x02u  /* Sum of squares (energy, RMS) */
+#define IIRDSP_STAT_MIN            0x04u  /* Minimum output */
+#define IIRDSP_STAT_MAX            0x08u  /* Maximum output */
+#define IIRDSP_STAT_ZERO_CROSSINGS 0x10u  /* Sign changes between outputs */
+#define IIRDSP_STAT_ALL            0x1Fu
+
+/**
+ * Running statistics over filter output
+ *
+ * Accumulates across calls until re-initialized, so a window can span
+ * several blocks. Only the fields selected by flags are maintained.
+ */
+typedef struct {
+    unsigned flags;          /* IIRDSP_STAT_* selection */
+    long count;              /* Samples accumulated */
+    iirdsp_real sum;         /* Sum of outputs */
+    iirdsp_real sum_sq;      /* Sum of squared outputs */
+    iirdsp_real min;         /* Minimum output (valid when count > 0) */
+    iirdsp_real max;         /* Maximum output (valid when count > 0) */
+    long zero_crossings;     /* Sign changes between consecutive outputs */
+    iirdsp_real last;        /* Last output seen, for crossings across calls */
+} iirdsp_stats_t;
+
+/**
+ * Start a new statistics window
+ *
+ * @param st Statistics to reset
+ * @param flags IIRDSP_STAT_* selection
+ */
+void iirdsp_stats_init(iirdsp_stats_t* st, unsigned flags);
+
+/**
+ * Mean of the accumulated outputs (requires IIRDSP_STAT_SUM)
+ */
+iirdsp_real iirdsp_stats_mean(const iirdsp_stats_t* st);
+
+/**
+ * RMS of the accumulated outputs (requires IIRDSP_STAT_SUM_SQ)
+ */
+iirdsp_real iirdsp_stats_rms(const iirdsp_stats_t* st);
+
+/**
+ * Filter a buffer and accumulate statistics over the output in one pass
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x, or NULL for stats only
+ * @param N Number of samples
+ * @param st Statistics to update
+ */
+void iirdsp_process_buffer_stats(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_stats_t* st
+);
+
+/**
+ * Zero-phase filtering with statistics accumulated in the backward pass
+ *
+ * Same output as iirdsp_filtfilt(). Zero crossings are counted in
+ * reverse time order, which gives the same count.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x, or NULL for stats only
+ * @param N Number of samples
+ * @param st Statistics to update
+ * @return 0 on success, -1 if the temporary buffer cannot be allocated
+ */
+int iirdsp_filtfilt_stats(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_stats_t* st
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IIRDSP_STATS_H */
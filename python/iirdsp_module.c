@@ -0,0 +1,753 @@
+/**
+ * @file iirdsp_module.c
+ * @brief CPython bindings
+ *
+ * Arrays are taken through the buffer protocol (NumPy arrays, array,
+ * memoryview, ...) with their strides, so no Python-level copy is made.
+ * 1-D arrays are one channel; 2-D arrays hold one channel per row
+ * (axis=-1) or per column (axis=0). Rows with unit sample stride are
+ * filtered in place in the caller's memory; other layouts go through a
+ * per-thread scratch row. An out that overlaps x without being exactly x
+ * is filtered from a private copy of x. The GIL is released for all filtering, and
+ * threads > 1 splits channels over native threads.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "iirdsp.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define REAL_FORMAT "f"
+#define REAL_NAME "float32"
+#else
+#define REAL_FORMAT "d"
+#define REAL_NAME "float64"
+#endif
+
+#define MAX_THREADS 256
+
+/**
+ * A 1-D or 2-D array seen as channels x samples
+ */
+typedef struct {
+    Py_buffer view;
+    char* base;
+    Py_ssize_t channels;
+    Py_ssize_t samples;
+    Py_ssize_t ch_stride;    /* Bytes between channels */
+    Py_ssize_t n_stride;     /* Bytes between samples */
+} array_t;
+
+typedef struct {
+    PyObject_HEAD
+    iirdsp_filter_t f;
+    int busy;                /* process() running with the GIL released */
+} FilterObject;
+
+static PyTypeObject FilterType;
+
+static int format_ok(const char* format)
+{
+    if (format == NULL) {
+        return 0;
+    }
+    if (*format == '@' || *format == '=') {
+        format++;
+    }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    else if (*format == '<') {
+        format++;
+    }
+#endif
+    return strcmp(format, REAL_FORMAT) == 0;
+}
+
+/**
+ * Acquire a buffer and map it to channels x samples
+ *
+ * @return 0, or -1 with an exception set
+ */
+static int get_array(PyObject* obj, int writable, int axis, array_t* a)
+{
+    Py_buffer* v = &a->view;
+
+    if (PyObject_GetBuffer(obj, v, writable ? PyBUF_RECORDS : PyBUF_RECORDS_RO) != 0) {
+        return -1;
+    }
+    if (!format_ok(v->format) || v->itemsize != (Py_ssize_t)sizeof(iirdsp_real)) {
+        PyErr_SetString(PyExc_TypeError, "expected a " REAL_NAME " array");
+        goto fail;
+    }
+    a->base = (char*)v->buf;
+    if (v->ndim == 1 && (axis == -1 || axis == 0)) {
+        a->channels = 1;
+        a->samples = v->shape[0];
+        a->ch_stride = 0;
+        a->n_stride = v->strides[0];
+    } else if (v->ndim == 2 && (axis == -1 || axis == 1)) {
+        a->channels = v->shape[0];
+        a->samples = v->shape[1];
+        a->ch_stride = v->strides[0];
+        a->n_stride = v->strides[1];
+    } else if (v->ndim == 2 && axis == 0) {
+        a->channels = v->shape[1];
+        a->samples = v->shape[0];
+        a->ch_stride = v->strides[1];
+        a->n_stride = v->strides[0];
+    } else {
+        PyErr_SetString(PyExc_ValueError, "expected a 1-D or 2-D array and axis -1, 0 or 1");
+        goto fail;
+    }
+    if (a->samples > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "too many samples per channel");
+        goto fail;
+    }
+    return 0;
+
+fail:
+    PyBuffer_Release(v);
+    return -1;
+}
+
+/**
+ * Resolve the output: the caller's out array, or a new C-contiguous
+ * memoryview shaped like x
+ *
+ * @return New reference to the object to return, or NULL with an
+ *         exception set
+ */
+static PyObject* get_output(PyObject* out, const array_t* x, int axis, array_t* y)
+{
+    PyObject* result;
+
+    if (out != NULL && out != Py_None) {
+        if (get_array(out, 1, axis, y) != 0) {
+            return NULL;
+        }
+        if (y->channels != x->channels || y->samples != x->samples) {
+            PyBuffer_Release(&y->view);
+            PyErr_SetString(PyExc_ValueError, "out must have the same shape as x");
+            return NULL;
+        }
+        Py_INCREF(out);
+        return out;
+    } else {
+        Py_ssize_t count = x->view.ndim == 1 ? x->view.shape[0] : x->view.shape[0] * x->view.shape[1];
+        PyObject* storage = PyByteArray_FromStringAndSize(NULL, count * (Py_ssize_t)sizeof(iirdsp_real));
+        PyObject* flat;
+        PyObject* shape;
+
+        if (storage == NULL) {
+            return NULL;
+        }
+        flat = PyMemoryView_FromObject(storage);
+        Py_DECREF(storage);
+        if (flat == NULL) {
+            return NULL;
+        }
+        shape = x->view.ndim == 1 ? Py_BuildValue("(n)", x->view.shape[0])
+                                  : Py_BuildValue("(nn)", x->view.shape[0], x->view.shape[1]);
+        result = shape != NULL ? PyObject_CallMethod(flat, "cast", "sO", REAL_FORMAT, shape) : NULL;
+        Py_XDECREF(shape);
+        Py_DECREF(flat);
+        if (result == NULL) {
+            return NULL;
+        }
+        if (get_array(result, 1, axis, y) != 0) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        return result;
+    }
+}
+
+/**
+ * Byte range an array touches
+ */
+static void extent(const array_t* a, const char** lo, const char** hi)
+{
+    Py_ssize_t spans[2];
+
+    *lo = *hi = a->base;
+    if (a->channels == 0 || a->samples == 0) {
+        return;
+    }
+    spans[0] = (a->channels - 1) * a->ch_stride;
+    spans[1] = (a->samples - 1) * a->n_stride;
+    for (int i = 0; i < 2; i++) {
+        if (spans[i] < 0) {
+            *lo += spans[i];
+        } else {
+            *hi += spans[i];
+        }
+    }
+    *hi += sizeof(iirdsp_real);
+}
+
+/**
+ * Give x a private copy if y overlaps it other than as the same array
+ *
+ * Writing y while reading x is fine when every element is read before
+ * the same element is written (y is x, sample for sample); any other
+ * overlap would feed outputs back in as inputs.
+ *
+ * @param copy Receives the copy to free afterwards, or NULL
+ * @return 0, or -1 with MemoryError set
+ */
+static int separate_input(array_t* x, const array_t* y, iirdsp_real** copy)
+{
+    const Py_ssize_t R = (Py_ssize_t)sizeof(iirdsp_real);
+    const char* x_lo;
+    const char* x_hi;
+    const char* y_lo;
+    const char* y_hi;
+    iirdsp_real* c;
+
+    *copy = NULL;
+    extent(x, &x_lo, &x_hi);
+    extent(y, &y_lo, &y_hi);
+    if (x_lo == x_hi || y_lo == y_hi || x_hi <= y_lo || y_hi <= x_lo) {
+        return 0;
+    }
+    if (x->base == y->base && x->n_stride == y->n_stride &&
+        (x->channels == 1 || x->ch_stride == y->ch_stride)) {
+        return 0;
+    }
+
+    c = (iirdsp_real*)PyMem_Malloc((size_t)(x->channels * x->samples) * sizeof(iirdsp_real));
+    if (c == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (Py_ssize_t ch = 0; ch < x->channels; ch++) {
+        for (Py_ssize_t n = 0; n < x->samples; n++) {
+            memcpy(&c[ch * x->samples + n], x->base + ch * x->ch_stride + n * x->n_stride, sizeof(iirdsp_real));
+        }
+    }
+    x->base = (char*)c;
+    x->ch_stride = x->samples * R;
+    x->n_stride = R;
+    *copy = c;
+    return 0;
+}
+
+/**
+ * One thread's share of a filtering call
+ */
+typedef struct {
+    iirdsp_filter_t f;
+    const array_t* x;
+    const array_t* y;
+    Py_ssize_t c0;
+    Py_ssize_t c1;
+    int zero_phase;
+    int status;              /* 0, or -1 on allocation failure */
+} job_t;
+
+static void* run_job(void* arg)
+{
+    job_t* j = (job_t*)arg;
+    const array_t* x = j->x;
+    const array_t* y = j->y;
+    const Py_ssize_t R = (Py_ssize_t)sizeof(iirdsp_real);
+    const int N = (int)x->samples;
+    int x_rows = x->n_stride == R;
+    int y_rows = y->n_stride == R;
+    iirdsp_real* scratch = NULL;
+
+    if (N == 0 || j->c0 == j->c1) {
+        return NULL;
+    }
+
+    /* Planar channels: zero-phase filtering runs channels in SIMD lanes */
+    if (j->zero_phase && x_rows && y_rows && x->ch_stride == N * R && y->ch_stride == N * R) {
+        j->status = iirdsp_filtfilt_multi(&j->f, 1, (const iirdsp_real*)(x->base + j->c0 * x->ch_stride),
+                                          (iirdsp_real*)(y->base + j->c0 * y->ch_stride),
+                                          (int)(j->c1 - j->c0), N, IIRDSP_LAYOUT_PLANAR, NULL) == 0 ? 0 : -1;
+        return NULL;
+    }
+
+    if (!x_rows || !y_rows) {
+        scratch = (iirdsp_real*)malloc((size_t)N * sizeof(iirdsp_real));
+        if (scratch == NULL) {
+            j->status = -1;
+            return NULL;
+        }
+    }
+    for (Py_ssize_t c = j->c0; c < j->c1; c++) {
+        const char* xr = x->base + c * x->ch_stride;
+        char* yr = y->base + c * y->ch_stride;
+        const iirdsp_real* src = (const iirdsp_real*)xr;
+        iirdsp_real* dst = y_rows ? (iirdsp_real*)yr : scratch;
+        iirdsp_filter_t g = j->f;
+
+        if (!x_rows) {
+            for (int n = 0; n < N; n++) {
+                memcpy(&scratch[n], xr + n * x->n_stride, sizeof(iirdsp_real));
+            }
+            src = scratch;
+        }
+        iirdsp_filter_init(&g);
+        if (j->zero_phase) {
+            iirdsp_filtfilt(&g, src, dst, N);
+        } else {
+            iirdsp_process_buffer(&g, src, dst, N);
+        }
+        if (!y_rows) {
+            for (int n = 0; n < N; n++) {
+                memcpy(yr + n * y->n_stride, &scratch[n], sizeof(iirdsp_real));
+            }
+        }
+    }
+    free(scratch);
+    return NULL;
+}
+
+/**
+ * Filter every channel, spread over threads; call without the GIL
+ *
+ * @return 0, or -1 on allocation failure
+ */
+static int run_channels(const iirdsp_filter_t* f, const array_t* x, const array_t* y, int zero_phase, int threads)
+{
+    job_t jobs[MAX_THREADS];
+    pthread_t tids[MAX_THREADS];
+    int started[MAX_THREADS];
+    int status = 0;
+
+    if (threads > x->channels) {
+        threads = x->channels > 0 ? (int)x->channels : 1;
+    }
+    for (int t = 0; t < threads; t++) {
+        jobs[t].f = *f;
+        jobs[t].x = x;
+        jobs[t].y = y;
+        jobs[t].c0 = x->channels * t / threads;
+        jobs[t].c1 = x->channels * (t + 1) / threads;
+        jobs[t].zero_phase = zero_phase;
+        jobs[t].status = 0;
+    }
+    for (int t = 1; t < threads; t++) {
+        started[t] = pthread_create(&tids[t], NULL, run_job, &jobs[t]) == 0;
+    }
+    run_job(&jobs[0]);
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        } else {
+            run_job(&jobs[t]);
+        }
+    }
+    for (int t = 0; t < threads; t++) {
+        status |= jobs[t].status;
+    }
+    return status;
+}
+
+static int resolve_threads(int threads)
+{
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    return threads > MAX_THREADS ? MAX_THREADS : threads;
+}
+
+static PyObject* filter_channels(PyObject* args, PyObject* kwargs, int zero_phase)
+{
+    static char* keywords[] = { "filter", "x", "out", "axis", "threads", NULL };
+    FilterObject* fo;
+    PyObject* xo;
+    PyObject* out = NULL;
+    PyObject* result;
+    int axis = -1;
+    int threads = 1;
+    iirdsp_filter_t f;
+    iirdsp_real* copy;
+    array_t x;
+    array_t y;
+    int rc;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O|Oii", keywords, &FilterType, &fo, &xo, &out, &axis,
+                                     &threads)) {
+        return NULL;
+    }
+    if (get_array(xo, 0, axis, &x) != 0) {
+        return NULL;
+    }
+    result = get_output(out, &x, axis, &y);
+    if (result == NULL) {
+        PyBuffer_Release(&x.view);
+        return NULL;
+    }
+    if (separate_input(&x, &y, &copy) != 0) {
+        PyBuffer_Release(&x.view);
+        PyBuffer_Release(&y.view);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    f = fo->f;
+    threads = resolve_threads(threads);
+    Py_BEGIN_ALLOW_THREADS
+    rc = run_channels(&f, &x, &y, zero_phase, threads);
+    Py_END_ALLOW_THREADS
+
+    PyMem_Free(copy);
+    PyBuffer_Release(&x.view);
+    PyBuffer_Release(&y.view);
+    if (rc != 0) {
+        Py_DECREF(result);
+        return PyErr_NoMemory();
+    }
+    return result;
+}
+
+PyDoc_STRVAR(sosfilt_doc,
+"sosfilt(filter, x, out=None, axis=-1, threads=1)\n"
+"\n"
+"Filter every channel of x from zero state. x is a 1-D or 2-D " REAL_NAME "\n"
+"buffer (axis selects the sample axis). The result goes to out if given\n"
+"(may be x itself; any other view overlapping x is filtered from a copy\n"
+"of x), otherwise to a new memoryview shaped like x.\n"
+"threads > 1 spreads channels over native threads; 0 uses every CPU.");
+
+static PyObject* py_sosfilt(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    (void)self;
+    return filter_channels(args, kwargs, 0);
+}
+
+PyDoc_STRVAR(sosfiltfilt_doc,
+"sosfiltfilt(filter, x, out=None, axis=-1, threads=1)\n"
+"\n"
+"Zero-phase forward-backward filtering of every channel, as\n"
+"scipy.signal.sosfiltfilt(sos, x, padlen=0). Arguments as for sosfilt().");
+
+static PyObject* py_sosfiltfilt(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    (void)self;
+    return filter_channels(args, kwargs, 1);
+}
+
+static FilterObject* new_filter(void)
+{
+    FilterObject* fo = PyObject_New(FilterObject, &FilterType);
+
+    if (fo != NULL) {
+        memset(&fo->f, 0, sizeof(fo->f));
+        fo->busy = 0;
+    }
+    return fo;
+}
+
+static PyObject* design_result(FilterObject* fo, int rc)
+{
+    if (rc != 0) {
+        Py_DECREF(fo);
+        PyErr_Format(PyExc_ValueError, "filter design failed (%d)", rc);
+        return NULL;
+    }
+    iirdsp_filter_init(&fo->f);
+    return (PyObject*)fo;
+}
+
+PyDoc_STRVAR(butter_doc,
+"butter(order, Wn, fs, btype='lowpass')\n"
+"\n"
+"Butterworth design, as scipy.signal.butter(..., output='sos').\n"
+"btype is 'lowpass', 'highpass' or 'bandpass' (Wn = (low, high)).");
+
+static PyObject* py_butter(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = { "order", "Wn", "fs", "btype", NULL };
+    const char* btype = "lowpass";
+    PyObject* wn;
+    double fs;
+    int order;
+    FilterObject* fo;
+    int rc;
+
+    (void)self;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iOd|s", keywords, &order, &wn, &fs, &btype)) {
+        return NULL;
+    }
+    fo = new_filter();
+    if (fo == NULL) {
+        return NULL;
+    }
+
+    if (strcmp(btype, "bandpass") == 0 || strcmp(btype, "band") == 0) {
+        double lo;
+        double hi;
+
+        if (!PyArg_ParseTuple(wn, "dd", &lo, &hi)) {
+            Py_DECREF(fo);
+            return NULL;
+        }
+        rc = butter_bandpass_init(&fo->f, order, (iirdsp_real)lo, (iirdsp_real)hi, (iirdsp_real)fs);
+    } else {
+        double fc = PyFloat_AsDouble(wn);
+
+        if (fc == -1.0 && PyErr_Occurred()) {
+            Py_DECREF(fo);
+            return NULL;
+        }
+        if (strcmp(btype, "lowpass") == 0 || strcmp(btype, "low") == 0) {
+            rc = butter_lowpass_init(&fo->f, order, (iirdsp_real)fc, (iirdsp_real)fs);
+        } else if (strcmp(btype, "highpass") == 0 || strcmp(btype, "high") == 0) {
+            rc = butter_highpass_init(&fo->f, order, (iirdsp_real)fc, (iirdsp_real)fs);
+        } else {
+            Py_DECREF(fo);
+            PyErr_Format(PyExc_ValueError, "unknown btype '%s'", btype);
+            return NULL;
+        }
+    }
+    return design_result(fo, rc);
+}
+
+PyDoc_STRVAR(notch_doc,
+"notch(f0, Q, fs)\n"
+"\n"
+"Second-order notch, as scipy.signal.iirnotch().");
+
+static PyObject* py_notch(PyObject* self, PyObject* args)
+{
+    double f0;
+    double q;
+    double fs;
+    FilterObject* fo;
+
+    (void)self;
+    if (!PyArg_ParseTuple(args, "ddd", &f0, &q, &fs)) {
+        return NULL;
+    }
+    fo = new_filter();
+    if (fo == NULL) {
+        return NULL;
+    }
+    return design_result(fo, notch_filter_init(&fo->f, (iirdsp_real)f0, (iirdsp_real)q, (iirdsp_real)fs));
+}
+
+/* Filter(sos): sections as (b0, b1, b2, a0, a1, a2) rows, like SciPy's sos */
+static int Filter_init(FilterObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = { "sos", NULL };
+    PyObject* sos;
+    PyObject* seq;
+    Py_ssize_t count;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &sos)) {
+        return -1;
+    }
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "filter is in use by another thread");
+        return -1;
+    }
+    seq = PySequence_Fast(sos, "sos must be a sequence of 6-element sections");
+    if (seq == NULL) {
+        return -1;
+    }
+    count = PySequence_Fast_GET_SIZE(seq);
+    if (count < 1 || count > IIRDSP_MAX_SECTIONS) {
+        Py_DECREF(seq);
+        PyErr_Format(PyExc_ValueError, "sos must have 1 to %d sections", IIRDSP_MAX_SECTIONS);
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < count; i++) {
+        double c[6];
+        iirdsp_biquad_t* s = &self->f.sections[i];
+
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(seq, i), "dddddd", &c[0], &c[1], &c[2], &c[3], &c[4],
+                              &c[5])) {
+            PyErr_Clear();
+            Py_DECREF(seq);
+            PyErr_SetString(PyExc_ValueError, "each sos section must be a tuple of 6 numbers");
+            return -1;
+        }
+        if (c[3] == 0.0) {
+            Py_DECREF(seq);
+            PyErr_SetString(PyExc_ValueError, "a0 must be nonzero");
+            return -1;
+        }
+        s->b0 = (iirdsp_real)(c[0] / c[3]);
+        s->b1 = (iirdsp_real)(c[1] / c[3]);
+        s->b2 = (iirdsp_real)(c[2] / c[3]);
+        s->a1 = (iirdsp_real)(c[4] / c[3]);
+        s->a2 = (iirdsp_real)(c[5] / c[3]);
+    }
+    Py_DECREF(seq);
+    self->f.num_sections = (int)count;
+    iirdsp_filter_init(&self->f);
+    return 0;
+}
+
+static PyObject* Filter_get_sos(FilterObject* self, void* closure)
+{
+    PyObject* sos = PyTuple_New(self->f.num_sections);
+
+    (void)closure;
+    for (int i = 0; sos != NULL && i < self->f.num_sections; i++) {
+        const iirdsp_biquad_t* s = &self->f.sections[i];
+        PyObject* row = Py_BuildValue("(dddddd)", (double)s->b0, (double)s->b1, (double)s->b2, 1.0,
+                                      (double)s->a1, (double)s->a2);
+        if (row == NULL) {
+            Py_DECREF(sos);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(sos, i, row);
+    }
+    return sos;
+}
+
+PyDoc_STRVAR(process_doc,
+"process(x, out=None)\n"
+"\n"
+"Stream a 1-D block through the filter, keeping state between calls.");
+
+static PyObject* Filter_process(FilterObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* keywords[] = { "x", "out", NULL };
+    PyObject* xo;
+    PyObject* out = NULL;
+    PyObject* result;
+    iirdsp_real* copy;
+    array_t x;
+    array_t y;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &xo, &out)) {
+        return NULL;
+    }
+    if (get_array(xo, 0, -1, &x) != 0) {
+        return NULL;
+    }
+    if (x.view.ndim != 1) {
+        PyBuffer_Release(&x.view);
+        PyErr_SetString(PyExc_ValueError, "process() takes a 1-D array");
+        return NULL;
+    }
+    if (self->busy) {
+        PyBuffer_Release(&x.view);
+        PyErr_SetString(PyExc_RuntimeError, "filter is in use by another thread");
+        return NULL;
+    }
+    result = get_output(out, &x, -1, &y);
+    if (result == NULL) {
+        PyBuffer_Release(&x.view);
+        return NULL;
+    }
+    if (separate_input(&x, &y, &copy) != 0) {
+        PyBuffer_Release(&x.view);
+        PyBuffer_Release(&y.view);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    self->busy = 1;
+    Py_BEGIN_ALLOW_THREADS
+    if (x.n_stride == (Py_ssize_t)sizeof(iirdsp_real) && y.n_stride == (Py_ssize_t)sizeof(iirdsp_real)) {
+        iirdsp_process_buffer(&self->f, (const iirdsp_real*)x.base, (iirdsp_real*)y.base, (int)x.samples);
+    } else {
+        for (Py_ssize_t n = 0; n < x.samples; n++) {
+            iirdsp_real v;
+
+            memcpy(&v, x.base + n * x.n_stride, sizeof(v));
+            v = iirdsp_process_sample(&self->f, v);
+            memcpy(y.base + n * y.n_stride, &v, sizeof(v));
+        }
+    }
+    Py_END_ALLOW_THREADS
+    self->busy = 0;
+
+    PyMem_Free(copy);
+    PyBuffer_Release(&x.view);
+    PyBuffer_Release(&y.view);
+    return result;
+}
+
+static PyObject* Filter_reset(FilterObject* self, PyObject* unused)
+{
+    (void)unused;
+    if (self->busy) {
+        PyErr_SetString(PyExc_RuntimeError, "filter is in use by another thread");
+        return NULL;
+    }
+    iirdsp_filter_reset(&self->f);
+    Py_RETURN_NONE;
+}
+
+static PyObject* Filter_repr(FilterObject* self)
+{
+    return PyUnicode_FromFormat("<iirdsp.Filter sections=%d>", self->f.num_sections);
+}
+
+static PyMethodDef Filter_methods[] = {
+    { "process", (PyCFunction)(void (*)(void))Filter_process, METH_VARARGS | METH_KEYWORDS, process_doc },
+    { "reset", (PyCFunction)Filter_reset, METH_NOARGS, "reset()\n\nZero the filter state." },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef Filter_getset[] = {
+    { "sos", (getter)Filter_get_sos, NULL, "Sections as (b0, b1, b2, 1, a1, a2) rows", NULL },
+    { NULL, NULL, NULL, NULL, NULL }
+};
+
+static PyTypeObject FilterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "iirdsp.Filter",
+    .tp_basicsize = sizeof(FilterObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = "Filter(sos)\n\nSOS cascade with state; use butter() or notch() to design one.",
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Filter_init,
+    .tp_repr = (reprfunc)Filter_repr,
+    .tp_methods = Filter_methods,
+    .tp_getset = Filter_getset,
+};
+
+static PyMethodDef module_methods[] = {
+    { "butter", (PyCFunction)(void (*)(void))py_butter, METH_VARARGS | METH_KEYWORDS, butter_doc },
+    { "notch", py_notch, METH_VARARGS, notch_doc },
+    { "sosfilt", (PyCFunction)(void (*)(void))py_sosfilt, METH_VARARGS | METH_KEYWORDS, sosfilt_doc },
+    { "sosfiltfilt", (PyCFunction)(void (*)(void))py_sosfiltfilt, METH_VARARGS | METH_KEYWORDS, sosfiltfilt_doc },
+    { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef module_def = {
+    PyModuleDef_HEAD_INIT,
+    "iirdsp",
+    "IIR filtering (SOS cascades) on buffer-protocol arrays without copies.",
+    -1,
+    module_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit_iirdsp(void)
+{
+    PyObject* m;
+
+    if (PyType_Ready(&FilterType) < 0) {
+        return NULL;
+    }
+    m = PyModule_Create(&module_def);
+    if (m == NULL) {
+        return NULL;
+    }
+    Py_INCREF(&FilterType);
+    if (PyModule_AddObject(m, "Filter", (PyObject*)&FilterType) < 0) {
+        Py_DECREF(&FilterType);
+        Py_DECREF(m);
+        return NULL;
+    }
+    PyModule_AddStringConstant(m, "dtype", REAL_NAME);
+    PyModule_AddIntConstant(m, "MAX_SECTIONS", IIRDSP_MAX_SECTIONS);
+    return m;
+}
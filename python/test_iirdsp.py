@@ -0,0 +1,190 @@
+"""Tests for the iirdsp CPython module.
+
+Uses only the standard library (array, memoryview) so it runs without
+NumPy; NumPy arrays reach the same buffer-protocol code paths.
+"""
+
+import array
+import math
+import threading
+import unittest
+
+import iirdsp
+
+CODE = "f" if iirdsp.dtype == "float32" else "d"
+TOL = 1e-4 if CODE == "f" else 1e-9
+
+
+def signal(n, k=0):
+    return array.array(CODE, (math.sin(0.05 * i * (k + 1)) + 0.3 * math.sin(0.9 * i) for i in range(n)))
+
+
+def direct_form(sos, x):
+    """Reference cascade in pure Python (DF2T, zero state)."""
+    y = list(x)
+    for b0, b1, b2, _, a1, a2 in sos:
+        z1 = z2 = 0.0
+        for i, v in enumerate(y):
+            out = b0 * v + z1
+            z1 = b1 * v - a1 * out + z2
+            z2 = b2 * v - a2 * out
+            y[i] = out
+    return y
+
+
+def close(a, b):
+    return len(a) == len(b) and all(abs(u - v) <= TOL * max(1.0, abs(v)) for u, v in zip(a, b))
+
+
+class DesignTest(unittest.TestCase):
+    def test_butter_sections(self):
+        self.assertEqual(len(iirdsp.butter(4, 40.0, 500.0).sos), 2)
+        self.assertEqual(len(iirdsp.butter(4, (0.5, 40.0), 500.0, btype="bandpass").sos), 4)
+        self.assertEqual(len(iirdsp.notch(50.0, 30.0, 500.0).sos), 1)
+
+    def test_bad_arguments(self):
+        with self.assertRaises(ValueError):
+            iirdsp.butter(4, 40.0, 500.0, btype="comb")
+        with self.assertRaises(ValueError):
+            iirdsp.butter(4, 400.0, 500.0)
+        with self.assertRaises(ValueError):
+            iirdsp.Filter([(1, 0, 0, 0, 0, 0)])
+
+    def test_sos_round_trip(self):
+        f = iirdsp.butter(6, 30.0, 250.0, btype="highpass")
+        g = iirdsp.Filter([tuple(2.0 * c for c in s) for s in f.sos])
+        for s, t in zip(f.sos, g.sos):
+            self.assertTrue(close(s, t))
+
+
+class FilterTest(unittest.TestCase):
+    def setUp(self):
+        self.f = iirdsp.butter(4, (1.0, 40.0), 500.0, btype="bandpass")
+        self.x = signal(1000)
+        self.ref = direct_form(self.f.sos, self.x)
+
+    def test_sosfilt_matches_reference(self):
+        y = iirdsp.sosfilt(self.f, self.x)
+        self.assertIsInstance(y, memoryview)
+        self.assertTrue(close(y.tolist(), self.ref))
+
+    def test_process_streams_state(self):
+        y = array.array(CODE, bytes(len(self.x) * self.x.itemsize))
+        self.f.process(memoryview(self.x)[:300], out=memoryview(y)[:300])
+        self.f.process(memoryview(self.x)[300:], out=memoryview(y)[300:])
+        self.assertTrue(close(y.tolist(), self.ref))
+        self.f.reset()
+        self.assertTrue(close(self.f.process(self.x).tolist(), self.ref))
+
+    def test_in_place_and_strided(self):
+        x = array.array(CODE, self.x)
+        iirdsp.sosfilt(self.f, x, out=x)
+        self.assertTrue(close(x.tolist(), self.ref))
+
+        # Every other sample of a longer buffer, written to a strided view
+        wide = array.array(CODE, [v for v in self.x for _ in (0, 1)])
+        out = array.array(CODE, bytes(len(wide) * wide.itemsize))
+        iirdsp.sosfilt(self.f, memoryview(wide)[::2], out=memoryview(out)[::2])
+        self.assertTrue(close(out[::2].tolist(), self.ref))
+        self.assertTrue(all(v == 0.0 for v in out[1::2]))
+
+    def test_overlapping_out(self):
+        # out shifted against x within one buffer: x must be read as given
+        for shift in (100, -100):
+            buf = array.array(CODE, list(self.x) + [0.0] * 100)
+            if shift > 0:
+                x, out = memoryview(buf)[:1000], memoryview(buf)[shift:shift + 1000]
+            else:
+                buf = array.array(CODE, [0.0] * 100 + list(self.x))
+                x, out = memoryview(buf)[100:], memoryview(buf)[:1000]
+            iirdsp.sosfilt(self.f, x, out=out)
+            self.assertTrue(close(out.tolist(), self.ref))
+            self.f.reset()
+        buf = array.array(CODE, list(self.x) + [0.0] * 1)
+        self.f.process(memoryview(buf)[:1000], out=memoryview(buf)[1:])
+        self.assertTrue(close(buf[1:].tolist(), self.ref))
+
+    def test_busy_filter(self):
+        x = signal(2000000)
+        ref = iirdsp.sosfilt(self.f, x).tolist()
+        result = []
+        worker = threading.Thread(target=lambda: result.append(self.f.process(x).tolist()))
+        worker.start()
+        while worker.is_alive():
+            try:
+                self.f.reset()
+                self.f.__init__(self.f.sos)
+            except RuntimeError:
+                pass
+        worker.join()
+        self.assertTrue(result[0] == ref)
+
+    def test_sosfiltfilt_zero_phase(self):
+        y = iirdsp.sosfiltfilt(self.f, self.x).tolist()
+        backward = direct_form(self.f.sos, self.ref[::-1])[::-1]
+        self.assertTrue(close(y, backward))
+
+    def test_wrong_type(self):
+        with self.assertRaises(TypeError):
+            iirdsp.sosfilt(self.f, array.array("i", [1, 2, 3]))
+        with self.assertRaises(ValueError):
+            iirdsp.sosfilt(self.f, self.x, out=array.array(CODE, [0.0]))
+
+
+class MultiChannelTest(unittest.TestCase):
+    C = 7
+    N = 600
+
+    def setUp(self):
+        self.f = iirdsp.butter(4, 40.0, 500.0)
+        self.rows = [signal(self.N, k) for k in range(self.C)]
+        flat = array.array(CODE)
+        for r in self.rows:
+            flat.extend(r)
+        self.planar = memoryview(flat).cast("B").cast(CODE, (self.C, self.N))
+        inter = array.array(CODE, (self.rows[c][n] for n in range(self.N) for c in range(self.C)))
+        self.interleaved = memoryview(inter).cast("B").cast(CODE, (self.N, self.C))
+
+    def expected(self, zero_phase):
+        out = []
+        for r in self.rows:
+            y = direct_form(self.f.sos, r)
+            if zero_phase:
+                y = direct_form(self.f.sos, y[::-1])[::-1]
+            out.append(y)
+        return out
+
+    def check_rows(self, y, axis, zero_phase):
+        got = y.tolist()
+        if axis == 0:
+            got = [list(col) for col in zip(*got)]
+        for g, e in zip(got, self.expected(zero_phase)):
+            self.assertTrue(close(g, e))
+
+    def test_layouts_and_threads(self):
+        for zero_phase, fn in ((0, iirdsp.sosfilt), (1, iirdsp.sosfiltfilt)):
+            for threads in (1, 3, 0):
+                y = fn(self.f, self.planar, threads=threads)
+                self.assertEqual(y.shape, (self.C, self.N))
+                self.check_rows(y, -1, zero_phase)
+                y = fn(self.f, self.interleaved, axis=0, threads=threads)
+                self.assertEqual(y.shape, (self.N, self.C))
+                self.check_rows(y, 0, zero_phase)
+
+    def test_python_threads_run_concurrently(self):
+        results = [None] * 4
+
+        def work(i):
+            results[i] = iirdsp.sosfiltfilt(self.f, self.planar).tolist()
+
+        threads = [threading.Thread(target=work, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for r in results:
+            self.assertEqual(r, results[0])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,203 @@
+/**
+ * @file bandpower.c
+ * @brief Multi-band power feature extractor implementation
+ *
+ * Per input sample, for each lane group of bands:
+ *   1. Broadcast the sample to every lane
+ *   2. Run the lane cascades (one band per lane)
+ *   3. Add the squared lane outputs to the frame sums
+ * Every hop samples the frame sums are scaled to mean power, written out
+ * and cleared. Full-rate band outputs only ever exist in registers.
+ */
+
+#include "bandpower.h"
+#include "butter.h"
+
+#define L IIRDSP_LANES
+
+int iirdsp_bandpower_init_filters(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_filter_t* filters,
+    int num_bands,
+    int hop
+)
+{
+    if (num_bands <= 0 || num_bands > IIRDSP_BANDPOWER_MAX_BANDS || hop <= 0) {
+        return -1;
+    }
+
+    bp->num_bands = num_bands;
+    bp->num_groups = (num_bands + L - 1) / L;
+    bp->hop = hop;
+    bp->pos = 0;
+
+    for (int g = 0; g < bp->num_groups; g++) {
+        int first = g * L;
+        int count = num_bands - first < L ? num_bands - first : L;
+
+        iirdsp_lanes_load(&bp->groups[g], &filters[first], 1, count);
+        for (int lane = 0; lane < L; lane++) {
+            bp->acc[g][lane] = 0.0;
+        }
+    }
+    return 0;
+}
+
+int iirdsp_bandpower_init(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_band_t* bands,
+    int num_bands,
+    int order,
+    iirdsp_real fs_hz,
+    iirdsp_real frame_hz
+)
+{
+    iirdsp_filter_t filters[IIRDSP_BANDPOWER_MAX_BANDS];
+    int hop;
+
+    if (num_bands <= 0 || num_bands > IIRDSP_BANDPOWER_MAX_BANDS ||
+        fs_hz <= 0.0 || frame_hz <= 0.0 || frame_hz > fs_hz) {
+        return -1;
+    }
+
+    for (int b = 0; b < num_bands; b++) {
+        int err;
+
+        if (bands[b].low_hz <= 0.0) {
+            err = butter_lowpass_init(&filters[b], order, bands[b].high_hz, fs_hz);
+        } else {
+            err = butter_bandpass_init(&filters[b], order, bands[b].low_hz,
+                                       bands[b].high_hz, fs_hz);
+        }
+        if (err != 0) {
+            return -2;
+        }
+    }
+
+    hop = (int)(fs_hz / frame_hz + 0.5);
+    if (hop < 1) {
+        hop = 1;
+    }
+    return iirdsp_bandpower_init_filters(bp, filters, num_bands, hop);
+}
+
+void iirdsp_bandpower_reset(iirdsp_bandpower_t* bp)
+{
+    for (int g = 0; g < bp->num_groups; g++) {
+        iirdsp_lanes_reset(&bp->groups[g]);
+        for (int lane = 0; lane < L; lane++) {
+            bp->acc[g][lane] = 0.0;
+        }
+    }
+    bp->pos = 0;
+}
+
+/**
+ * Filter one input sample through every band and accumulate its power
+ */
+static inline void bandpower_step(iirdsp_bandpower_t* bp, iirdsp_real x)
+{
+    for (int g = 0; g < bp->num_groups; g++) {
+        iirdsp_lanes_t* l = &bp->groups[g];
+        iirdsp_real v[L];
+
+        for (int lane = 0; lane < L; lane++) {
+            v[lane] = x;
+        }
+        iirdsp_lanes_process(l, v, v, 1);
+        for (int lane = 0; lane < L; lane++) {
+            bp->acc[g][lane] += v[lane] * v[lane];
+        }
+    }
+}
+
+/**
+ * Write the mean power of the finished frame and start the next one
+ */
+static void bandpower_emit(iirdsp_bandpower_t* bp, iirdsp_real* out)
+{
+    const iirdsp_real inv_hop = (iirdsp_real)1.0 / bp->hop;
+
+    for (int g = 0; g < bp->num_groups; g++) {
+        for (int lane = 0; lane < L; lane++) {
+            int b = g * L + lane;
+
+            if (out != NULL && b < bp->num_bands) {
+                out[b] = bp->acc[g][lane] * inv_hop;
+            }
+            bp->acc[g][lane] = 0.0;
+        }
+    }
+    bp->pos = 0;
+}
+
+/**
+ * Run N samples read with stride x_stride; frame k goes to
+ * features + k * frame_stride. Frames past max_frames are computed
+ * but dropped.
+ */
+static int bandpower_run(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_real* x,
+    size_t x_stride,
+    int N,
+    iirdsp_real* features,
+    size_t frame_stride,
+    int max_frames
+)
+{
+    int frames = 0;
+
+    for (int n = 0; n < N; n++) {
+        bandpower_step(bp, x[(size_t)n * x_stride]);
+        if (++bp->pos == bp->hop) {
+            iirdsp_real* out = frames < max_frames ? features + (size_t)frames * frame_stride : NULL;
+            bandpower_emit(bp, out);
+            frames++;
+        }
+    }
+    return frames < max_frames ? frames : max_frames;
+}
+
+int iirdsp_bandpower_process(
+    iirdsp_bandpower_t* bp,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_real* features,
+    int max_frames
+)
+{
+    return bandpower_run(bp, x, 1, N, features, (size_t)bp->num_bands, max_frames);
+}
+
+int iirdsp_bandpower_process_multi(
+    iirdsp_bandpower_t* bp,
+    int channels,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_layout_t layout,
+    iirdsp_real* features,
+    int max_frames
+)
+{
+    const size_t ch_stride = layout == IIRDSP_LAYOUT_PLANAR ? (size_t)N : 1;
+    const size_t n_stride = layout == IIRDSP_LAYOUT_PLANAR ? 1 : (size_t)channels;
+    int frames = 0;
+
+    if (channels <= 0) {
+        return -1;
+    }
+    for (int c = 1; c < channels; c++) {
+        if (bp[c].num_bands != bp[0].num_bands || bp[c].hop != bp[0].hop ||
+            bp[c].pos != bp[0].pos) {
+            return -1;
+        }
+    }
+
+    for (int c = 0; c < channels; c++) {
+        frames = bandpower_run(&bp[c], x + c * ch_stride, n_stride, N,
+                               features + (size_t)c * bp[c].num_bands,
+                               (size_t)channels * bp[c].num_bands, max_frames);
+    }
+    return frames;
+}
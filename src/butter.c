@@ -29,20 +29,45 @@
  *   p_k = e^(j * pi * (2*k + N + 1) / (2*N))
  *   for k = 0, 1, ..., N-1
  *
- * We store only the left-half plane (stable) poles as (real, imag) pairs.
+ * All lie in the left-half plane. p_k and p_(N-1-k) are complex conjugates;
+ * for odd N the middle pole is real (-1). Poles are emitted as consecutive
+ * conjugate pairs, lowest Q first, with the real pole (if any) last, so
+ * that bilinear_zpk() can pair neighbours into real-coefficient sections.
  *
  * @param order Filter order N
  * @param poles Output array of pole pairs (2*order real values: [re0, im0, re1, im1, ...])
  */
 static void butter_analog_poles(int order, iirdsp_real* poles)
 {
-    for (int k = 0; k < order; k++) {
+    int n = 0;
+
+    for (int k = order / 2 - 1; k >= 0; k--) {
         iirdsp_real angle = M_PI * (2.0 * k + order + 1.0) / (2.0 * order);
-        poles[2*k]     = -sin(angle);  /* Real part */
-        poles[2*k + 1] =  cos(angle);  /* Imaginary part */
+        poles[2*n]     = cos(angle);  /* Real part */
+        poles[2*n + 1] = sin(angle);  /* Imaginary part */
+        n++;
+        poles[2*n]     = cos(angle);
+        poles[2*n + 1] = -sin(angle);
+        n++;
+    }
+    if (order % 2) {
+        poles[2*n]     = -1.0;
+        poles[2*n + 1] = 0.0;
     }
 }
 
+/**
+ * Principal square root of a complex number
+ */
+static void complex_sqrt(iirdsp_real re, iirdsp_real im, iirdsp_real* out_re, iirdsp_real* out_im)
+{
+    iirdsp_real mag = sqrt(re * re + im * im);
+    iirdsp_real r = sqrt((mag + re) / 2.0 > 0.0 ? (mag + re) / 2.0 : 0.0);
+    iirdsp_real i = sqrt((mag - re) / 2.0 > 0.0 ? (mag - re) / 2.0 : 0.0);
+    *out_re = r;
+    *out_im = im < 0.0 ? -i : i;
+}
+
 /**
  * Apply bilinear transform to convert analog poles to digital filter
  *
@@ -110,72 +135,40 @@ static void bilinear_zpk(
             zeros_z[2*i]     =  1.0;
             zeros_z[2*i + 1] =  0.0;
         }
-    } else {  /* Band-pass: zeros at z = -1 and z = +1 */
-        for (int i = 0; i < actual_num_zeros / 2; i++) {
-            zeros_z[2*i]     = -1.0;
-            zeros_z[2*i + 1] =  0.0;
-        }
-        for (int i = actual_num_zeros / 2; i < actual_num_zeros; i++) {
-            zeros_z[2*i]     =  1.0;
-            zeros_z[2*i + 1] =  0.0;
+    } else {  /* Band-pass: zeros at z = -1 and z = +1, one of each per section */
+        for (int i = 0; i < actual_num_zeros; i++) {
+            zeros_z[2*i]     = (i % 2) ? 1.0 : -1.0;
+            zeros_z[2*i + 1] = 0.0;
         }
     }
 
     /* Pair poles and zeros into second-order sections */
     for (int i = 0; i < num_sections; i++) {
-        iirdsp_real p1_re, p1_im, p2_re, p2_im;
-        iirdsp_real z1_re, z1_im, z2_re, z2_im;
-        
-        /* Get pole pair (or single pole for odd order) */
-        if (2*i + 1 < num_poles) {
-            /* Conjugate pair */
-            p1_re = poles_z[4*i];
-            p1_im = poles_z[4*i + 1];
-            p2_re = poles_z[4*i + 2];
-            p2_im = poles_z[4*i + 3];
-        } else if (2*i < num_poles) {
-            /* Single real pole (odd order, last section) */
-            p1_re = poles_z[2*(num_poles - 1)];
-            p1_im = poles_z[2*(num_poles - 1) + 1];
-            p2_re = p1_re;
-            p2_im = -p1_im;  /* Conjugate for completeness */
-        } else {
-            /* Should not happen */
-            p1_re = 0.0;
-            p1_im = 0.0;
-            p2_re = 0.0;
-            p2_im = 0.0;
-        }
+        iirdsp_real b0 = 1.0, b1, b2;
+        iirdsp_real a0 = 1.0, a1, a2;
 
-        /* Get zero pair */
-        if (2*i + 1 < actual_num_zeros) {
-            z1_re = zeros_z[4*i];
-            z1_im = zeros_z[4*i + 1];
-            z2_re = zeros_z[4*i + 2];
-            z2_im = zeros_z[4*i + 3];
-        } else if (2*i < actual_num_zeros) {
-            z1_re = zeros_z[2*(actual_num_zeros - 1)];
-            z1_im = zeros_z[2*(actual_num_zeros - 1) + 1];
-            z2_re = z1_re;
-            z2_im = z1_im;
+        if (2*i + 1 < num_poles) {
+            /* Conjugate (or real) pole pair and zero pair */
+            iirdsp_real p1_re = poles_z[4*i],     p1_im = poles_z[4*i + 1];
+            iirdsp_real p2_re = poles_z[4*i + 2], p2_im = poles_z[4*i + 3];
+            iirdsp_real z1_re = zeros_z[4*i],     z1_im = zeros_z[4*i + 1];
+            iirdsp_real z2_re = zeros_z[4*i + 2], z2_im = zeros_z[4*i + 3];
+
+            /* Numerator: (z - z1)(z - z2) = z^2 - (z1+z2)*z + z1*z2 */
+            b1 = -(z1_re + z2_re);
+            b2 = z1_re * z2_re - z1_im * z2_im;
+
+            /* Denominator: (z - p1)(z - p2) = z^2 - (p1+p2)*z + p1*p2 */
+            a1 = -(p1_re + p2_re);
+            a2 = p1_re * p2_re - p1_im * p2_im;
         } else {
-            z1_re = zeros_z[0];
-            z1_im = zeros_z[1];
-            z2_re = zeros_z[0];
-            z2_im = zeros_z[1];
+            /* Single real pole and zero (odd order, last section): first order */
+            b1 = -zeros_z[2*(actual_num_zeros - 1)];
+            b2 = 0.0;
+            a1 = -poles_z[2*(num_poles - 1)];
+            a2 = 0.0;
         }
 
-        /* Form second-order section coefficients */
-        /* Numerator: (z - z1)(z - z2) = z^2 - (z1+z2)*z + z1*z2 */
-        iirdsp_real b0 = 1.0;
-        iirdsp_real b1 = -(z1_re + z2_re);
-        iirdsp_real b2 = z1_re * z2_re - z1_im * z2_im;
-
-        /* Denominator: (z - p1)(z - p2) = z^2 - (p1+p2)*z + p1*p2 */
-        iirdsp_real a0 = 1.0;
-        iirdsp_real a1 = -(p1_re + p2_re);
-        iirdsp_real a2 = p1_re * p2_re - p1_im * p2_im;
-
         /* Normalize by a0 and store */
         f->sections[i].b0 = b0 / a0;
         f->sections[i].b1 = b1 / a0;
@@ -329,8 +322,8 @@ int butter_highpass_init(
         iirdsp_real p_im = poles_s[2*i + 1];
         iirdsp_real mag_sq = p_re * p_re + p_im * p_im;
         
-        /* Invert and scale */
-        poles_s[2*i]     = -p_re * wc_warped / mag_sq;
+        /* wc / p = wc * conj(p) / |p|^2 */
+        poles_s[2*i]     =  p_re * wc_warped / mag_sq;
         poles_s[2*i + 1] = -p_im * wc_warped / mag_sq;
     }
 
@@ -386,44 +379,40 @@ int butter_bandpass_init(
 
     /* Low-pass to band-pass transformation */
     /* Each pole p becomes two poles via: s^2 - p*BW*s + w0^2 = 0 */
+    /*   s = (p*BW +/- sqrt((p*BW)^2 - 4*w0^2)) / 2 */
     iirdsp_real poles_bp[2 * IIRDSP_MAX_SECTIONS * 4];
     int bp_count = 0;
 
     for (int i = 0; i < order; i++) {
-        iirdsp_real p_re = poles_lp[2*i];
-        iirdsp_real p_im = poles_lp[2*i + 1];
-        
-        /* Only use real part for LP->BP transform (imaginary handled separately) */
-        /* Solve: s^2 - p*BW*s + w0^2 = 0 */
-        iirdsp_real alpha = -p_re * bw / 2.0;
-        iirdsp_real beta_sq = alpha * alpha - w0 * w0;
-        
-        if (beta_sq >= 0.0) {
-            /* Real roots */
-            iirdsp_real beta = sqrt(beta_sq);
-            poles_bp[2*bp_count]     = alpha + beta;
-            poles_bp[2*bp_count + 1] = p_im * bw;
-            bp_count++;
-            poles_bp[2*bp_count]     = alpha - beta;
-            poles_bp[2*bp_count + 1] = p_im * bw;
-            bp_count++;
+        iirdsp_real pb_re = poles_lp[2*i] * bw;
+        iirdsp_real pb_im = poles_lp[2*i + 1] * bw;
+        iirdsp_real d_re, d_im;
+
+        complex_sqrt(pb_re * pb_re - pb_im * pb_im - 4.0 * w0 * w0,
+                     2.0 * pb_re * pb_im, &d_re, &d_im);
+
+        iirdsp_real s1_re = (pb_re + d_re) / 2.0, s1_im = (pb_im + d_im) / 2.0;
+        iirdsp_real s2_re = (pb_re - d_re) / 2.0, s2_im = (pb_im - d_im) / 2.0;
+
+        if (pb_im != 0.0 && i + 1 < order) {
+            /* Conjugate LP pair: emit s1, conj(s1), s2, conj(s2) */
+            poles_bp[2*bp_count] = s1_re; poles_bp[2*bp_count + 1] =  s1_im; bp_count++;
+            poles_bp[2*bp_count] = s1_re; poles_bp[2*bp_count + 1] = -s1_im; bp_count++;
+            poles_bp[2*bp_count] = s2_re; poles_bp[2*bp_count + 1] =  s2_im; bp_count++;
+            poles_bp[2*bp_count] = s2_re; poles_bp[2*bp_count + 1] = -s2_im; bp_count++;
+            i++;  /* Partner pole already covered */
         } else {
-            /* Complex roots */
-            iirdsp_real beta = sqrt(-beta_sq);
-            poles_bp[2*bp_count]     = alpha;
-            poles_bp[2*bp_count + 1] = beta + p_im * bw;
-            bp_count++;
-            poles_bp[2*bp_count]     = alpha;
-            poles_bp[2*bp_count + 1] = -beta + p_im * bw;
-            bp_count++;
+            /* Real LP pole: its two BP poles form a pair on their own */
+            poles_bp[2*bp_count] = s1_re; poles_bp[2*bp_count + 1] = s1_im; bp_count++;
+            poles_bp[2*bp_count] = s2_re; poles_bp[2*bp_count + 1] = s2_im; bp_count++;
         }
     }
 
     /* Apply bilinear transform (filter_type=2 for bandpass) */
     bilinear_zpk(poles_bp, NULL, bp_count, 0, fs_hz, 2, f);
 
-    /* Normalize gain at center frequency */
-    iirdsp_real f_center = sqrt(f_low_hz * f_high_hz);
+    /* Normalize gain at the digital image of the analog center frequency */
+    iirdsp_real f_center = fs_hz / M_PI * atan(w0 / (2.0 * fs_hz));
     normalize_gain(f, f_center / fs_hz);
 
     return 0;
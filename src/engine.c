@@ -0,0 +1,485 @@
+/**
+ * @file engine.c
+ * @brief Multi-tenant stream engine implementation
+ *
+ * Layout:
+ *   - Stream records come from a slab (slab.h); each record holds the
+ *     stream's state followed by its pending buffer, so one stream's
+ *     data is contiguous and cache-line aligned, and records of closed
+ *     streams are reused in place.
+ *   - An open-addressing hash table (linear probing, backward-shift
+ *     deletion) maps stream IDs to record indices.
+ *   - Each coefficient set keeps a FIFO of streams with pending samples.
+ *
+ * A run takes each set's FIFO and keeps IIRDSP_LANES lanes busy: lanes
+ * advance together by the shortest remaining packet run, and a lane whose
+ * stream is done is saved and refilled from the FIFO. Filtering happens in
+ * place in the pending buffers, which are then handed to the sink.
+ */
+
+#include "engine.h"
+#include "multi.h"
+#include "slab.h"
+#include <stdlib.h>
+
+#define L IIRDSP_LANES
+
+/**
+ * Per-stream record: state and queued input; coefficients live in the set
+ */
+typedef struct stream_rec {
+    uint64_t id;
+    int coeff_set;
+    int ready;                /* On its set's ready FIFO */
+    struct stream_rec* next;  /* Next record on the ready FIFO */
+    int pending;              /* Samples queued in buf */
+    iirdsp_real z1[IIRDSP_MAX_SECTIONS];
+    iirdsp_real z2[IIRDSP_MAX_SECTIONS];
+    iirdsp_real buf[];        /* max_pending samples */
+} stream_rec_t;
+
+/**
+ * Shared coefficients and the FIFO of streams waiting on them
+ */
+typedef struct {
+    iirdsp_filter_t filter;
+    stream_rec_t* head;
+    stream_rec_t* tail;
+    int refs;                 /* add_coeffs() references plus open streams; 0 if free */
+} coeff_set_t;
+
+struct iirdsp_engine {
+    iirdsp_slab_t* slab;      /* Stream records */
+    int max_streams;
+    int num_streams;
+
+    stream_rec_t** table;     /* Open addressing, NULL if empty */
+    uint32_t mask;            /* Table size - 1 */
+
+    int max_pending;
+    iirdsp_real* work;        /* max_pending lane vectors */
+
+    coeff_set_t sets[IIRDSP_ENGINE_MAX_COEFFS];
+    int num_sets;             /* High-water mark; freed sets are reused */
+
+    iirdsp_sink_fn sink;
+    void* user;
+    iirdsp_engine_stats_t stats;
+};
+
+/**
+ * 64-bit mix (splitmix64 finalizer) so sequential IDs spread out
+ */
+static uint32_t hash_id(uint64_t id)
+{
+    id ^= id >> 30;
+    id *= 0xbf58476d1ce4e5b9ULL;
+    id ^= id >> 27;
+    id *= 0x94d049bb133111ebULL;
+    id ^= id >> 31;
+    return (uint32_t)id;
+}
+
+/**
+ * Table slot holding stream_id, or -1
+ */
+static int find_slot(const iirdsp_engine_t* e, uint64_t stream_id)
+{
+    uint32_t i = hash_id(stream_id) & e->mask;
+
+    while (e->table[i] != NULL) {
+        if (e->table[i]->id == stream_id) {
+            return (int)i;
+        }
+        i = (i + 1) & e->mask;
+    }
+    return -1;
+}
+
+static stream_rec_t* find_stream(iirdsp_engine_t* e, uint64_t stream_id)
+{
+    int slot = find_slot(e, stream_id);
+    return slot >= 0 ? e->table[slot] : NULL;
+}
+
+/**
+ * Remove a slot and shift later members of its probe run back
+ */
+static void remove_slot(iirdsp_engine_t* e, uint32_t i)
+{
+    uint32_t j = i;
+
+    e->table[i] = NULL;
+    for (;;) {
+        uint32_t k;
+
+        j = (j + 1) & e->mask;
+        if (e->table[j] == NULL) {
+            return;
+        }
+        k = hash_id(e->table[j]->id) & e->mask;
+        /* Leave entries whose home slot lies in (i, j] */
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        e->table[i] = e->table[j];
+        e->table[j] = NULL;
+        i = j;
+    }
+}
+
+iirdsp_engine_t* iirdsp_engine_create(
+    int max_streams,
+    int max_pending,
+    iirdsp_sink_fn sink,
+    void* user
+)
+{
+    iirdsp_engine_t* e;
+    uint32_t size = 16;
+
+    if (max_streams <= 0 || max_pending <= 0 || sink == NULL) {
+        return NULL;
+    }
+    while (size < 2u * (uint32_t)max_streams) {
+        size *= 2;
+    }
+
+    e = (iirdsp_engine_t*)calloc(1, sizeof(*e));
+    if (e == NULL) {
+        return NULL;
+    }
+    e->slab = iirdsp_slab_create(sizeof(stream_rec_t) + (size_t)max_pending * sizeof(iirdsp_real));
+    e->table = (stream_rec_t**)calloc(size, sizeof(stream_rec_t*));
+    e->work = (iirdsp_real*)malloc((size_t)max_pending * L * sizeof(iirdsp_real));
+    if (e->slab == NULL || e->table == NULL || e->work == NULL) {
+        iirdsp_engine_destroy(e);
+        return NULL;
+    }
+
+    e->max_streams = max_streams;
+    e->max_pending = max_pending;
+    e->mask = size - 1;
+    e->sink = sink;
+    e->user = user;
+    return e;
+}
+
+void iirdsp_engine_destroy(iirdsp_engine_t* e)
+{
+    if (e != NULL) {
+        iirdsp_slab_destroy(e->slab);
+        free(e->table);
+        free(e->work);
+        free(e);
+    }
+}
+
+int iirdsp_engine_add_coeffs(iirdsp_engine_t* e, const iirdsp_filter_t* f)
+{
+    coeff_set_t* set;
+    int free_set = -1;
+
+    for (int s = 0; s < e->num_sets; s++) {
+        const iirdsp_filter_t* g = &e->sets[s].filter;
+        int same = g->num_sections == f->num_sections;
+
+        if (e->sets[s].refs == 0) {
+            if (free_set < 0) {
+                free_set = s;
+            }
+            continue;
+        }
+        for (int i = 0; same && i < f->num_sections; i++) {
+            same = g->sections[i].b0 == f->sections[i].b0 &&
+                   g->sections[i].b1 == f->sections[i].b1 &&
+                   g->sections[i].b2 == f->sections[i].b2 &&
+                   g->sections[i].a1 == f->sections[i].a1 &&
+                   g->sections[i].a2 == f->sections[i].a2;
+        }
+        if (same) {
+            e->sets[s].refs++;
+            return s;
+        }
+    }
+
+    if (free_set < 0) {
+        if (e->num_sets == IIRDSP_ENGINE_MAX_COEFFS) {
+            return -1;
+        }
+        free_set = e->num_sets++;
+    }
+    set = &e->sets[free_set];
+    set->filter = *f;
+    iirdsp_filter_init(&set->filter);
+    set->head = NULL;
+    set->tail = NULL;
+    set->refs = 1;
+    return free_set;
+}
+
+int iirdsp_engine_release_coeffs(iirdsp_engine_t* e, int coeff_set)
+{
+    if (coeff_set < 0 || coeff_set >= e->num_sets || e->sets[coeff_set].refs == 0) {
+        return -1;
+    }
+    e->sets[coeff_set].refs--;
+    return 0;
+}
+
+int iirdsp_engine_open(iirdsp_engine_t* e, uint64_t stream_id, int coeff_set)
+{
+    stream_rec_t* rec;
+    uint32_t i;
+
+    if (coeff_set < 0 || coeff_set >= e->num_sets || e->sets[coeff_set].refs == 0) {
+        return -3;
+    }
+    if (find_slot(e, stream_id) >= 0) {
+        return -2;
+    }
+    if (e->num_streams == e->max_streams) {
+        return -1;
+    }
+    rec = (stream_rec_t*)iirdsp_slab_alloc(e->slab);
+    if (rec == NULL) {
+        return -1;
+    }
+    e->num_streams++;
+    e->sets[coeff_set].refs++;
+
+    rec->id = stream_id;
+    rec->coeff_set = coeff_set;
+    rec->next = NULL;
+    rec->ready = 0;
+    rec->pending = 0;
+    for (int s = 0; s < IIRDSP_MAX_SECTIONS; s++) {
+        rec->z1[s] = 0.0;
+        rec->z2[s] = 0.0;
+    }
+
+    i = hash_id(stream_id) & e->mask;
+    while (e->table[i] != NULL) {
+        i = (i + 1) & e->mask;
+    }
+    e->table[i] = rec;
+    return 0;
+}
+
+int iirdsp_engine_close(iirdsp_engine_t* e, uint64_t stream_id)
+{
+    int slot = find_slot(e, stream_id);
+    stream_rec_t* rec;
+
+    if (slot < 0) {
+        return -1;
+    }
+    rec = e->table[slot];
+
+    /* Unlink from the ready FIFO */
+    if (rec->ready) {
+        coeff_set_t* set = &e->sets[rec->coeff_set];
+        stream_rec_t* prev = NULL;
+        stream_rec_t* cur = set->head;
+
+        while (cur != rec) {
+            prev = cur;
+            cur = cur->next;
+        }
+        if (prev == NULL) {
+            set->head = rec->next;
+        } else {
+            prev->next = rec->next;
+        }
+        if (set->tail == rec) {
+            set->tail = prev;
+        }
+    }
+
+    e->sets[rec->coeff_set].refs--;
+    remove_slot(e, (uint32_t)slot);
+    iirdsp_slab_free(e->slab, rec);
+    e->num_streams--;
+    return 0;
+}
+
+int iirdsp_engine_ingest(iirdsp_engine_t* e, uint64_t stream_id, const iirdsp_real* x, int n)
+{
+    stream_rec_t* rec = find_stream(e, stream_id);
+
+    if (rec == NULL) {
+        return -1;
+    }
+    if (n <= 0) {
+        return 0;
+    }
+    if (rec->pending + n > e->max_pending) {
+        return -2;
+    }
+
+    memcpy(rec->buf + rec->pending, x, (size_t)n * sizeof(iirdsp_real));
+    rec->pending += n;
+    e->stats.packets++;
+
+    if (!rec->ready) {
+        coeff_set_t* set = &e->sets[rec->coeff_set];
+
+        rec->ready = 1;
+        rec->next = NULL;
+        if (set->tail == NULL) {
+            set->head = rec;
+        } else {
+            set->tail->next = rec;
+        }
+        set->tail = rec;
+    }
+    return 0;
+}
+
+/**
+ * Hand a finished stream's output to the sink and clear its queue
+ */
+static void deliver(iirdsp_engine_t* e, stream_rec_t* rec)
+{
+    e->sink(e->user, rec->id, rec->buf, rec->pending);
+    rec->pending = 0;
+}
+
+/**
+ * Filter one stream on its own
+ */
+static void run_scalar(iirdsp_engine_t* e, const coeff_set_t* set, stream_rec_t* rec, int offset)
+{
+    iirdsp_filter_t f = set->filter;
+    iirdsp_real* buf = rec->buf;
+
+    for (int i = 0; i < f.num_sections; i++) {
+        f.sections[i].z1 = rec->z1[i];
+        f.sections[i].z2 = rec->z2[i];
+    }
+    iirdsp_process_buffer(&f, buf + offset, buf + offset, rec->pending - offset);
+    for (int i = 0; i < f.num_sections; i++) {
+        rec->z1[i] = f.sections[i].z1;
+        rec->z2[i] = f.sections[i].z2;
+    }
+    e->stats.scalar_samples += rec->pending - offset;
+}
+
+/**
+ * Run one coefficient set's ready FIFO through the lanes
+ */
+static long run_set(iirdsp_engine_t* e, coeff_set_t* set)
+{
+    iirdsp_lanes_t lanes;
+    stream_rec_t* slot[L];   /* Record in each lane, NULL if idle */
+    int offset[L];           /* Samples of that record already filtered */
+    int active = 0;
+    stream_rec_t* next = set->head;
+    long total = 0;
+
+    set->head = NULL;
+    set->tail = NULL;
+
+    iirdsp_lanes_load(&lanes, &set->filter, 0, L);
+    for (int lane = 0; lane < L; lane++) {
+        slot[lane] = NULL;
+        offset[lane] = 0;
+    }
+
+    for (;;) {
+        int k = e->max_pending;
+
+        /* Refill idle lanes from the FIFO */
+        for (int lane = 0; lane < L && next != NULL; lane++) {
+            if (slot[lane] == NULL) {
+                stream_rec_t* rec = next;
+
+                rec->ready = 0;
+                total += rec->pending;
+                slot[lane] = next;
+                offset[lane] = 0;
+                for (int i = 0; i < lanes.num_sections; i++) {
+                    lanes.z1[i][lane] = rec->z1[i];
+                    lanes.z2[i][lane] = rec->z2[i];
+                }
+                next = rec->next;
+                active++;
+            }
+        }
+        if (active < 2) {
+            break;
+        }
+
+        /* Advance every busy lane by the shortest remaining run */
+        for (int lane = 0; lane < L; lane++) {
+            if (slot[lane] != NULL && slot[lane]->pending - offset[lane] < k) {
+                k = slot[lane]->pending - offset[lane];
+            }
+        }
+        for (int lane = 0; lane < L; lane++) {
+            const iirdsp_real* src = slot[lane] != NULL ? slot[lane]->buf + offset[lane] : NULL;
+            for (int n = 0; n < k; n++) {
+                e->work[(size_t)n * L + lane] = src != NULL ? src[n] : 0.0;
+            }
+        }
+        iirdsp_lanes_process(&lanes, e->work, e->work, k);
+        e->stats.lane_samples += (long)k * active;
+
+        for (int lane = 0; lane < L; lane++) {
+            stream_rec_t* rec = slot[lane];
+            iirdsp_real* dst;
+
+            if (rec == NULL) {
+                continue;
+            }
+            dst = rec->buf + offset[lane];
+            for (int n = 0; n < k; n++) {
+                dst[n] = e->work[(size_t)n * L + lane];
+            }
+            offset[lane] += k;
+
+            if (offset[lane] == rec->pending) {
+                for (int i = 0; i < lanes.num_sections; i++) {
+                    rec->z1[i] = lanes.z1[i][lane];
+                    rec->z2[i] = lanes.z2[i][lane];
+                }
+                deliver(e, rec);
+                slot[lane] = NULL;
+                active--;
+            }
+        }
+    }
+
+    /* At most one stream left: finish it alone */
+    for (int lane = 0; lane < L; lane++) {
+        stream_rec_t* rec = slot[lane];
+
+        if (rec != NULL) {
+            for (int i = 0; i < lanes.num_sections; i++) {
+                rec->z1[i] = lanes.z1[i][lane];
+                rec->z2[i] = lanes.z2[i][lane];
+            }
+            run_scalar(e, set, rec, offset[lane]);
+            deliver(e, rec);
+        }
+    }
+    return total;
+}
+
+long iirdsp_engine_run(iirdsp_engine_t* e)
+{
+    long total = 0;
+
+    for (int s = 0; s < e->num_sets; s++) {
+        if (e->sets[s].head != NULL) {
+            total += run_set(e, &e->sets[s]);
+        }
+    }
+    e->stats.runs++;
+    return total;
+}
+
+void iirdsp_engine_get_stats(const iirdsp_engine_t* e, iirdsp_engine_stats_t* stats)
+{
+    *stats = e->stats;
+}
@@ -0,0 +1,226 @@
+/**
+ * @file hotswap.c
+ * @brief Lock-free coefficient hot swap
+ *
+ * Two single-pointer channels connect the threads:
+ *   - pending: the control thread exchanges a new update in; the
+ *     real-time thread exchanges NULL in at each block start. Whoever
+ *     takes an update out owns it, so an update replaced before the
+ *     real-time thread saw it is freed by the publisher.
+ *   - retired: the real-time thread pushes adopted updates onto a
+ *     Treiber stack once it has copied their coefficients; the control
+ *     thread takes the whole stack with one exchange and frees it.
+ * The real-time thread keeps its own copy of the active filter, so the
+ * coefficients it runs are never written by another thread.
+ */
+
+#include "hotswap.h"
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct swap_update {
+    iirdsp_filter_t filter;
+    iirdsp_swap_state_t state;
+    int crossfade;
+    struct swap_update* next;   /* Retired stack link */
+} swap_update_t;
+
+struct iirdsp_hotswap {
+    /* Shared */
+    swap_update_t* pending;
+    swap_update_t* retired;
+    unsigned long generation;
+
+    /* Real-time thread only */
+    iirdsp_filter_t active;
+    iirdsp_filter_t fading;     /* Previous filter during a crossfade */
+    int fade_pos;
+    int fade_len;               /* 0 when not fading */
+    iirdsp_real last_x;
+};
+
+/**
+ * Set the state to the steady state for a constant input u
+ *
+ * Same per-section relations as iirdsp_process_buffer_idle(); a section
+ * with a pole at z = 1 has no steady state and its state is zeroed along
+ * with everything after it.
+ */
+static void steady_state(iirdsp_filter_t* f, iirdsp_real u)
+{
+    for (int i = 0; i < f->num_sections; i++) {
+        iirdsp_biquad_t* s = &f->sections[i];
+        iirdsp_real den = 1.0 + s->a1 + s->a2;
+        iirdsp_real out;
+
+        if (fabs(den) <= 1e-12) {
+            u = 0.0;
+            s->z1 = 0.0;
+            s->z2 = 0.0;
+            continue;
+        }
+        out = (s->b0 + s->b1 + s->b2) / den * u;
+        s->z1 = out - s->b0 * u;
+        s->z2 = s->b2 * u - s->a2 * out;
+        u = out;
+    }
+}
+
+static void retire(iirdsp_hotswap_t* h, swap_update_t* u)
+{
+    swap_update_t* head = __atomic_load_n(&h->retired, __ATOMIC_RELAXED);
+
+    do {
+        u->next = head;
+    } while (!__atomic_compare_exchange_n(&h->retired, &head, u, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * Switch the active filter to an update's coefficients
+ */
+static void adopt(iirdsp_hotswap_t* h, const swap_update_t* u)
+{
+    iirdsp_filter_t next = u->filter;
+
+    switch (u->state) {
+    case IIRDSP_SWAP_KEEP:
+        for (int i = 0; i < next.num_sections; i++) {
+            int keep = i < h->active.num_sections;
+            next.sections[i].z1 = keep ? h->active.sections[i].z1 : 0.0;
+            next.sections[i].z2 = keep ? h->active.sections[i].z2 : 0.0;
+        }
+        break;
+    case IIRDSP_SWAP_STEADY:
+        steady_state(&next, h->last_x);
+        break;
+    default:
+        iirdsp_filter_init(&next);
+        break;
+    }
+
+    if (u->crossfade > 0) {
+        h->fading = h->active;
+        h->fade_pos = 0;
+        h->fade_len = u->crossfade;
+    } else {
+        h->fade_len = 0;
+    }
+    h->active = next;
+}
+
+iirdsp_hotswap_t* iirdsp_hotswap_create(const iirdsp_filter_t* initial)
+{
+    iirdsp_hotswap_t* h;
+
+    if (initial == NULL || initial->num_sections <= 0 || initial->num_sections > IIRDSP_MAX_SECTIONS) {
+        return NULL;
+    }
+    h = (iirdsp_hotswap_t*)calloc(1, sizeof(*h));
+    if (h == NULL) {
+        return NULL;
+    }
+    h->active = *initial;
+    return h;
+}
+
+void iirdsp_hotswap_destroy(iirdsp_hotswap_t* h)
+{
+    if (h == NULL) {
+        return;
+    }
+    free(h->pending);
+    iirdsp_hotswap_reclaim(h);
+    free(h);
+}
+
+int iirdsp_hotswap_publish(
+    iirdsp_hotswap_t* h,
+    const iirdsp_filter_t* coeffs,
+    iirdsp_swap_state_t state,
+    int crossfade
+)
+{
+    swap_update_t* u;
+    swap_update_t* old;
+
+    if (coeffs == NULL || coeffs->num_sections <= 0 || coeffs->num_sections > IIRDSP_MAX_SECTIONS ||
+        (unsigned)state > IIRDSP_SWAP_STEADY || crossfade < 0) {
+        return -1;
+    }
+    u = (swap_update_t*)malloc(sizeof(*u));
+    if (u == NULL) {
+        return -2;
+    }
+    u->filter = *coeffs;
+    u->state = state;
+    u->crossfade = crossfade;
+    u->next = NULL;
+
+    old = __atomic_exchange_n(&h->pending, u, __ATOMIC_ACQ_REL);
+    free(old);
+    return 0;
+}
+
+int iirdsp_hotswap_reclaim(iirdsp_hotswap_t* h)
+{
+    swap_update_t* u = __atomic_exchange_n(&h->retired, NULL, __ATOMIC_ACQUIRE);
+    int freed = 0;
+
+    while (u != NULL) {
+        swap_update_t* next = u->next;
+        free(u);
+        u = next;
+        freed++;
+    }
+    return freed;
+}
+
+void iirdsp_hotswap_process(iirdsp_hotswap_t* h, const iirdsp_real* x, iirdsp_real* y, int N)
+{
+    iirdsp_real last;
+    int n = 0;
+
+    if (N <= 0) {
+        return;
+    }
+    last = x[N - 1];  /* y may alias x */
+
+    if (__atomic_load_n(&h->pending, __ATOMIC_RELAXED) != NULL) {
+        swap_update_t* u = __atomic_exchange_n(&h->pending, NULL, __ATOMIC_ACQUIRE);
+
+        if (u != NULL) {
+            adopt(h, u);
+            retire(h, u);
+            __atomic_fetch_add(&h->generation, 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    /* Blend old and new outputs until the fade completes */
+    for (; n < N && h->fade_len > 0; n++) {
+        iirdsp_real w = (iirdsp_real)(h->fade_pos + 1) / (iirdsp_real)(h->fade_len + 1);
+        iirdsp_real xn = x[n];
+        iirdsp_real a = iirdsp_process_sample(&h->active, xn);
+        iirdsp_real b = iirdsp_process_sample(&h->fading, xn);
+
+        y[n] = w * a + (1.0 - w) * b;
+        if (++h->fade_pos == h->fade_len) {
+            h->fade_len = 0;
+        }
+    }
+
+    h->last_x = last;
+    if (n < N) {
+        iirdsp_process_buffer(&h->active, x + n, y + n, N - n);
+    }
+}
+
+const iirdsp_filter_t* iirdsp_hotswap_active(const iirdsp_hotswap_t* h)
+{
+    return &h->active;
+}
+
+unsigned long iirdsp_hotswap_generation(const iirdsp_hotswap_t* h)
+{
+    return __atomic_load_n(&h->generation, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,589 @@
+/**
+ * @file jit.c
+ * @brief x86-64 code generation for fixed cascades
+ *
+ * Generated function (System V ABI: rdi = f, rsi = x, rdx = y, ecx = N):
+ *
+ *   load register-resident state and coefficients
+ *   if N > 0:
+ *     for n in 0..N-1:
+ *       X = x[n]
+ *       per section: Y = b0*X + z1; z1 = b1*X - a1*Y + z2; z2 = b2*X - a2*Y
+ *       y[n] = X (input and output registers swap roles per section)
+ *   store register-resident state
+ *
+ * Each statement is evaluated in the same order as iirdsp_biquad_process()
+ * so the results round identically; a product with a zero coefficient is
+ * dropped and a product with a unit coefficient is replaced by its other
+ * operand, both of which leave every finite result unchanged.
+ *
+ * Registers: xmm0-3 are X, Y and two temporaries. Up to six sections keep
+ * z1/z2 in xmm4-15; longer cascades keep five there and run the rest
+ * through xmm14/15, loading and storing their state in the filter around
+ * each sample. Registers left over hold the first coefficients; the rest
+ * are read from a literal pool placed after the code (RIP-relative).
+ *
+ * Code is written to an anonymous mapping that is made executable (and
+ * no longer writable) before use.
+ */
+
+#define _GNU_SOURCE
+
+#include "jit.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__unix__) && !defined(IIRDSP_NO_JIT)
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+struct iirdsp_jit {
+    iirdsp_process_fn fn;
+    const char* isa;
+    void* code;
+    size_t code_size;
+};
+
+#ifdef JIT_X86_64
+
+#define CODE_CAPACITY 8192
+#define MAX_POOL (IIRDSP_MAX_SECTIONS * 5)
+#define MAX_FIXUPS 512
+
+#ifdef IIRDSP_USE_FLOAT
+#define SCALAR_PP 2   /* F3: ss forms */
+#define FMA_W 0
+#define SAMPLE_SCALE 2
+#else
+#define SCALAR_PP 3   /* F2: sd forms */
+#define FMA_W 1
+#define SAMPLE_SCALE 3
+#endif
+
+/* Opcodes (0F map unless noted) */
+#define OP_MOVS_LOAD 0x10
+#define OP_MOVS_STORE 0x11
+#define OP_MOVAPS 0x28
+#define OP_XORPS 0x57
+#define OP_ADD 0x58
+#define OP_MUL 0x59
+#define OP_SUB 0x5C
+#define OP_FMADD231 0xB9   /* 0F38: d = a * b + d */
+#define OP_FNMADD231 0xBD  /* 0F38: d = -(a * b) + d */
+
+/* General-purpose register numbers used in addressing */
+#define R_RDX 2
+#define R_RSI 6
+#define R_RDI 7
+
+#define X_REG 0
+#define Y_REG 1
+#define T_REG 2
+#define U_REG 3
+#define SPILL_Z1 14
+#define SPILL_Z2 15
+
+/**
+ * Instruction operand: a register or a memory location
+ */
+typedef struct {
+    int kind;   /* OPND_REG, OPND_STATE, OPND_SAMPLE, OPND_POOL */
+    int reg;    /* Register, sample base register, or pool index */
+    int disp;   /* Displacement from rdi for OPND_STATE */
+} opnd_t;
+
+enum { OPND_REG, OPND_STATE, OPND_SAMPLE, OPND_POOL };
+
+typedef struct {
+    unsigned char* buf;
+    size_t len;
+    int overflow;
+    int vex;
+    int fma;
+    iirdsp_real pool[MAX_POOL];
+    int pool_size;
+    int pool_reg[MAX_POOL];         /* Register holding the constant, or -1 */
+    size_t fixups[MAX_FIXUPS];      /* Offsets of RIP-relative disp32 fields */
+    int fixup_index[MAX_FIXUPS];
+    int num_fixups;
+} asm_t;
+
+static opnd_t reg_of(int r)
+{
+    opnd_t o = { OPND_REG, r, 0 };
+    return o;
+}
+
+static void byte(asm_t* a, int b)
+{
+    if (a->len < CODE_CAPACITY) {
+        a->buf[a->len++] = (unsigned char)b;
+    } else {
+        a->overflow = 1;
+    }
+}
+
+static void dword(asm_t* a, int32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        byte(a, (int)(((uint32_t)v >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * ModRM (plus SIB / displacement) for reg field r and operand m
+ */
+static void modrm(asm_t* a, int r, opnd_t m)
+{
+    r &= 7;
+    switch (m.kind) {
+    case OPND_REG:
+        byte(a, 0xC0 | (r << 3) | (m.reg & 7));
+        break;
+    case OPND_STATE:                      /* [rdi + disp32] */
+        byte(a, 0x80 | (r << 3) | R_RDI);
+        dword(a, m.disp);
+        break;
+    case OPND_SAMPLE:                     /* [base + rax * sizeof(iirdsp_real)] */
+        byte(a, 0x04 | (r << 3));
+        byte(a, (SAMPLE_SCALE << 6) | (0 << 3) | m.reg);
+        break;
+    default:                              /* [rip + disp32], patched later */
+        byte(a, 0x05 | (r << 3));
+        if (a->num_fixups < MAX_FIXUPS) {
+            a->fixups[a->num_fixups] = a->len;
+            a->fixup_index[a->num_fixups++] = m.reg;
+        } else {
+            a->overflow = 1;
+        }
+        dword(a, 0);
+        break;
+    }
+}
+
+/**
+ * Emit one SSE/AVX instruction
+ *
+ * @param pp Mandatory prefix: 0 none, 1 66, 2 F3, 3 F2
+ * @param map 1 for 0F, 2 for 0F38 (VEX only)
+ * @param w VEX.W
+ * @param op Opcode
+ * @param r ModRM reg operand (destination for loads and arithmetic)
+ * @param v VEX.vvvv source register, -1 if unused
+ * @param m ModRM r/m operand
+ */
+static void insn(asm_t* a, int pp, int map, int w, int op, int r, int v, opnd_t m)
+{
+    int rex_r = (r >> 3) & 1;
+    int rex_b = m.kind == OPND_REG ? (m.reg >> 3) & 1 : 0;
+
+    if (a->vex) {
+        byte(a, 0xC4);
+        byte(a, ((!rex_r) << 7) | (1 << 6) | ((!rex_b) << 5) | map);
+        byte(a, (w << 7) | ((~(v < 0 ? 0 : v) & 15) << 3) | pp);
+        byte(a, op);
+    } else {
+        static const int prefix[4] = { 0, 0x66, 0xF3, 0xF2 };
+        if (pp != 0) {
+            byte(a, prefix[pp]);
+        }
+        if (rex_r || rex_b) {
+            byte(a, 0x40 | (rex_r << 2) | rex_b);
+        }
+        byte(a, 0x0F);
+        byte(a, op);
+    }
+    modrm(a, r, m);
+}
+
+static void mov_reg(asm_t* a, int d, int s)
+{
+    if (d != s) {
+        insn(a, 0, 1, 0, OP_MOVAPS, d, -1, reg_of(s));
+    }
+}
+
+static void zero(asm_t* a, int d)
+{
+    insn(a, 0, 1, 0, OP_XORPS, d, d, reg_of(d));
+}
+
+static void load(asm_t* a, int d, opnd_t m)
+{
+    insn(a, SCALAR_PP, 1, 0, OP_MOVS_LOAD, d, -1, m);
+}
+
+static void store(asm_t* a, opnd_t m, int s)
+{
+    insn(a, SCALAR_PP, 1, 0, OP_MOVS_STORE, s, -1, m);
+}
+
+/**
+ * d = s op b; with SSE encodings d is first set to s, so b must not be d
+ * unless d == s
+ */
+static void arith(asm_t* a, int op, int d, int s, opnd_t b)
+{
+    if (a->vex) {
+        insn(a, SCALAR_PP, 1, 0, op, d, s, b);
+    } else {
+        mov_reg(a, d, s);
+        insn(a, SCALAR_PP, 1, 0, op, d, -1, b);
+    }
+}
+
+/**
+ * d = d +/- s * b (FMA3, VEX only)
+ */
+static void fused(asm_t* a, int op, int d, int s, opnd_t b)
+{
+    insn(a, 1, 2, FMA_W, op, d, s, b);
+}
+
+/**
+ * Operand for a coefficient: its register or its pool slot
+ */
+static opnd_t constant(asm_t* a, iirdsp_real c)
+{
+    opnd_t o = { OPND_POOL, 0, 0 };
+    int i = 0;
+
+    while (i < a->pool_size && memcmp(&a->pool[i], &c, sizeof(c)) != 0) {
+        i++;
+    }
+    if (i == a->pool_size) {
+        a->pool[a->pool_size] = c;
+        a->pool_reg[a->pool_size++] = -1;
+    }
+    if (a->pool_reg[i] >= 0) {
+        return reg_of(a->pool_reg[i]);
+    }
+    o.reg = i;
+    return o;
+}
+
+/**
+ * Register holding s * c: s itself for c == 1, otherwise d
+ */
+static int product(asm_t* a, int d, int s, iirdsp_real c)
+{
+    if (c == 1) {
+        return s;
+    }
+    arith(a, OP_MUL, d, s, constant(a, c));
+    return d;
+}
+
+/**
+ * One section: reads X, writes Y, updates z1/z2 in registers
+ */
+static void emit_section(asm_t* a, const iirdsp_biquad_t* s, int X, int Y, int Z1, int Z2)
+{
+    /* y = b0*x + z1 */
+    if (s->b0 == 0) {
+        mov_reg(a, Y, Z1);
+    } else if (a->fma && s->b0 != 1) {
+        mov_reg(a, Y, Z1);
+        fused(a, OP_FMADD231, Y, X, constant(a, s->b0));
+    } else {
+        arith(a, OP_ADD, Y, product(a, Y, X, s->b0), reg_of(Z1));
+    }
+
+    /* z1 = (b1*x - a1*y) + z2 */
+    if (s->b1 != 0 && s->a1 != 0) {
+        if (a->fma) {
+            mov_reg(a, T_REG, product(a, T_REG, X, s->b1));
+            fused(a, OP_FNMADD231, T_REG, Y, constant(a, s->a1));
+            arith(a, OP_ADD, Z1, T_REG, reg_of(Z2));
+        } else {
+            int p = product(a, T_REG, X, s->b1);
+            int q = product(a, U_REG, Y, s->a1);
+            arith(a, OP_SUB, T_REG, p, reg_of(q));
+            arith(a, OP_ADD, Z1, T_REG, reg_of(Z2));
+        }
+    } else if (s->b1 != 0) {
+        arith(a, OP_ADD, Z1, product(a, T_REG, X, s->b1), reg_of(Z2));
+    } else if (s->a1 != 0) {
+        arith(a, OP_SUB, Z1, Z2, reg_of(product(a, U_REG, Y, s->a1)));
+    } else {
+        mov_reg(a, Z1, Z2);
+    }
+
+    /* z2 = b2*x - a2*y */
+    if (s->b2 != 0 && s->a2 != 0) {
+        if (a->fma) {
+            mov_reg(a, Z2, product(a, Z2, X, s->b2));
+            fused(a, OP_FNMADD231, Z2, Y, constant(a, s->a2));
+        } else {
+            int p = product(a, T_REG, X, s->b2);
+            int q = product(a, U_REG, Y, s->a2);
+            arith(a, OP_SUB, Z2, p, reg_of(q));
+        }
+    } else if (s->b2 != 0) {
+        mov_reg(a, Z2, product(a, Z2, X, s->b2));
+    } else if (s->a2 != 0) {
+        int q = product(a, U_REG, Y, s->a2);
+        zero(a, Z2);
+        arith(a, OP_SUB, Z2, Z2, reg_of(q));
+    } else {
+        zero(a, Z2);
+    }
+}
+
+static opnd_t state_of(int section, int z2)
+{
+    opnd_t o = { OPND_STATE, 0, 0 };
+    o.disp = (int)(offsetof(iirdsp_filter_t, sections) + (size_t)section * sizeof(iirdsp_biquad_t) +
+                   (z2 ? offsetof(iirdsp_biquad_t, z2) : offsetof(iirdsp_biquad_t, z1)));
+    return o;
+}
+
+/**
+ * Generate the kernel into a->buf; returns the total size (code and
+ * pool), or 0 if it did not fit
+ */
+static size_t generate(asm_t* a, const iirdsp_filter_t* f)
+{
+    const int S = f->num_sections;
+    const int resident = S <= 6 ? S : 5;
+    int free_regs = S <= 6 ? 12 - 2 * S : 0;
+    int next_reg = 4 + 2 * resident;
+    opnd_t x_at = { OPND_SAMPLE, R_RSI, 0 };
+    opnd_t y_at = { OPND_SAMPLE, R_RDX, 0 };
+    size_t loop_top;
+    size_t skip_at;
+    size_t pool_at;
+    int X = X_REG;
+    int Y = Y_REG;
+
+    /* Give the first coefficients that need a multiply a register */
+    for (int i = 0; i < S && free_regs > 0; i++) {
+        const iirdsp_real c[5] = { f->sections[i].b0, f->sections[i].b1, f->sections[i].b2,
+                                   f->sections[i].a1, f->sections[i].a2 };
+        for (int k = 0; k < 5 && free_regs > 0; k++) {
+            opnd_t o;
+            if (c[k] == 0 || c[k] == 1) {
+                continue;
+            }
+            o = constant(a, c[k]);
+            if (o.kind == OPND_POOL) {
+                a->pool_reg[o.reg] = next_reg++;
+                free_regs--;
+            }
+        }
+    }
+
+    /* Prologue */
+    for (int i = 0; i < resident; i++) {
+        load(a, 4 + 2 * i, state_of(i, 0));
+        load(a, 5 + 2 * i, state_of(i, 1));
+    }
+    for (int i = 0; i < a->pool_size; i++) {
+        if (a->pool_reg[i] >= 0) {
+            opnd_t o = { OPND_POOL, i, 0 };
+            load(a, a->pool_reg[i], o);
+        }
+    }
+    byte(a, 0x85); byte(a, 0xC9);              /* test ecx, ecx */
+    byte(a, 0x0F); byte(a, 0x8E);              /* jle done */
+    skip_at = a->len;
+    dword(a, 0);
+    byte(a, 0x48); byte(a, 0x63); byte(a, 0xC9);  /* movsxd rcx, ecx */
+    byte(a, 0x31); byte(a, 0xC0);              /* xor eax, eax */
+
+    /* Sample loop */
+    loop_top = a->len;
+    load(a, X, x_at);
+    for (int i = 0; i < S; i++) {
+        int t;
+        if (i < resident) {
+            emit_section(a, &f->sections[i], X, Y, 4 + 2 * i, 5 + 2 * i);
+        } else {
+            load(a, SPILL_Z1, state_of(i, 0));
+            load(a, SPILL_Z2, state_of(i, 1));
+            emit_section(a, &f->sections[i], X, Y, SPILL_Z1, SPILL_Z2);
+            store(a, state_of(i, 0), SPILL_Z1);
+            store(a, state_of(i, 1), SPILL_Z2);
+        }
+        t = X;
+        X = Y;
+        Y = t;
+    }
+    store(a, y_at, X);
+    byte(a, 0x48); byte(a, 0xFF); byte(a, 0xC0);  /* inc rax */
+    byte(a, 0x48); byte(a, 0x39); byte(a, 0xC8);  /* cmp rax, rcx */
+    byte(a, 0x0F); byte(a, 0x8C);              /* jl loop_top */
+    dword(a, (int32_t)((long)loop_top - (long)(a->len + 4)));
+
+    /* Epilogue */
+    if (!a->overflow) {
+        int32_t rel = (int32_t)(a->len - (skip_at + 4));
+        memcpy(a->buf + skip_at, &rel, 4);
+    }
+    for (int i = 0; i < resident; i++) {
+        store(a, state_of(i, 0), 4 + 2 * i);
+        store(a, state_of(i, 1), 5 + 2 * i);
+    }
+    byte(a, 0xC3);                             /* ret */
+
+    /* Literal pool, aligned, then patch the RIP-relative references */
+    while (a->len % 16 != 0) {
+        byte(a, 0xCC);
+    }
+    pool_at = a->len;
+    for (int i = 0; i < a->pool_size; i++) {
+        for (size_t k = 0; k < sizeof(iirdsp_real); k++) {
+            byte(a, ((const unsigned char*)&a->pool[i])[k]);
+        }
+    }
+    if (a->overflow) {
+        return 0;
+    }
+    for (int i = 0; i < a->num_fixups; i++) {
+        size_t target = pool_at + (size_t)a->fixup_index[i] * sizeof(iirdsp_real);
+        int32_t rel = (int32_t)((long)target - (long)(a->fixups[i] + 4));
+        memcpy(a->buf + a->fixups[i], &rel, 4);
+    }
+    return a->len;
+}
+
+/**
+ * Generate, map and protect the kernel; returns 0 on success
+ */
+static int compile(iirdsp_jit_t* j, const iirdsp_filter_t* f, unsigned flags)
+{
+    asm_t* a;
+    size_t size;
+    void* mem;
+
+    a = (asm_t*)calloc(1, sizeof(*a));
+    if (a == NULL) {
+        return -1;
+    }
+    a->buf = (unsigned char*)malloc(CODE_CAPACITY);
+    if (a->buf == NULL) {
+        free(a);
+        return -1;
+    }
+    __builtin_cpu_init();
+    a->vex = !(flags & IIRDSP_JIT_NO_AVX) && __builtin_cpu_supports("avx");
+    a->fma = a->vex && (flags & IIRDSP_JIT_FMA) && __builtin_cpu_supports("fma");
+
+    size = generate(a, f);
+    mem = size > 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) : MAP_FAILED;
+    if (mem != MAP_FAILED) {
+        memcpy(mem, a->buf, size);
+        if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+            munmap(mem, size);
+            mem = MAP_FAILED;
+        }
+    }
+    free(a->buf);
+    if (mem == MAP_FAILED) {
+        free(a);
+        return -1;
+    }
+    j->code = mem;
+    j->code_size = size;
+    /* Object-to-function pointer conversion, as with dlsym() */
+    memcpy(&j->fn, &mem, sizeof(mem));
+    j->isa = a->fma ? "avx-fma" : a->vex ? "avx" : "sse2";
+    free(a);
+    return 0;
+}
+
+#endif /* JIT_X86_64 */
+
+/**
+ * Compile a kernel for a filter's coefficients
+ *
+ * @param f Filter whose coefficients are baked in
+ * @param flags IIRDSP_JIT_* flags
+ * @return New kernel, or NULL on failure
+ */
+iirdsp_jit_t* iirdsp_jit_create(const iirdsp_filter_t* f, unsigned flags)
+{
+    iirdsp_jit_t* j;
+
+    if (f == NULL || f->num_sections < 0 || f->num_sections > IIRDSP_MAX_SECTIONS) {
+        return NULL;
+    }
+    j = (iirdsp_jit_t*)calloc(1, sizeof(*j));
+    if (j == NULL) {
+        return NULL;
+    }
+    j->fn = iirdsp_process_buffer;
+    j->isa = "none";
+#ifdef JIT_X86_64
+    if (!(flags & IIRDSP_JIT_DISABLE)) {
+        /* On failure the fallback stays in place */
+        (void)compile(j, f, flags);
+    }
+#else
+    (void)flags;
+#endif
+    return j;
+}
+
+/**
+ * Free a kernel
+ *
+ * @param j Kernel, or NULL
+ */
+void iirdsp_jit_destroy(iirdsp_jit_t* j)
+{
+    if (j == NULL) {
+        return;
+    }
+#ifdef JIT_X86_64
+    if (j->code != NULL) {
+        munmap(j->code, j->code_size);
+    }
+#endif
+    free(j);
+}
+
+/**
+ * Function to call for processing
+ *
+ * @param j Kernel
+ * @return Compiled code or iirdsp_process_buffer
+ */
+iirdsp_process_fn iirdsp_jit_function(const iirdsp_jit_t* j)
+{
+    return j->fn;
+}
+
+/**
+ * Instruction set the kernel was generated for
+ *
+ * @param j Kernel
+ * @return ISA name, "none" for the fallback
+ */
+const char* iirdsp_jit_isa(const iirdsp_jit_t* j)
+{
+    return j->isa;
+}
+
+/**
+ * Process a buffer with the kernel
+ *
+ * @param j Kernel
+ * @param f Filter holding the state
+ * @param x Input signal
+ * @param y Output signal, can alias x
+ * @param N Number of samples
+ */
+void iirdsp_jit_process(
+    const iirdsp_jit_t* j,
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+)
+{
+    j->fn(f, x, y, N);
+}
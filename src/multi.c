@@ -0,0 +1,464 @@
+/**
+ * @file multi.c
+ * @brief Multi-channel filtering with channels in SIMD lanes
+ */
+
+#include "multi.h"
+#include <stdlib.h>
+
+#define L IIRDSP_LANES
+
+/**
+ * Load coefficients and state of up to IIRDSP_LANES filters into lanes
+ *
+ * @param l Lane group to fill
+ * @param filters First filter
+ * @param stride 0 for shared coefficients, 1 for one filter per lane
+ * @param count Number of lanes to fill
+ */
+void iirdsp_lanes_load(
+    iirdsp_lanes_t* l,
+    const iirdsp_filter_t* filters,
+    int stride,
+    int count
+)
+{
+    int num_sections = 0;
+
+    if (count > L) {
+        count = L;
+    }
+    for (int lane = 0; lane < count; lane++) {
+        int s = filters[lane * stride].num_sections;
+        if (s > num_sections) {
+            num_sections = s;
+        }
+    }
+
+    for (int i = 0; i < IIRDSP_MAX_SECTIONS; i++) {
+        for (int lane = 0; lane < L; lane++) {
+            const iirdsp_filter_t* f = lane < count ? &filters[lane * stride] : NULL;
+
+            if (f != NULL && i < f->num_sections) {
+                l->b0[i][lane] = f->sections[i].b0;
+                l->b1[i][lane] = f->sections[i].b1;
+                l->b2[i][lane] = f->sections[i].b2;
+                l->a1[i][lane] = f->sections[i].a1;
+                l->a2[i][lane] = f->sections[i].a2;
+                l->z1[i][lane] = f->sections[i].z1;
+                l->z2[i][lane] = f->sections[i].z2;
+            } else {
+                /* Identity section: y = x, state stays zero */
+                l->b0[i][lane] = 1.0;
+                l->b1[i][lane] = 0.0;
+                l->b2[i][lane] = 0.0;
+                l->a1[i][lane] = 0.0;
+                l->a2[i][lane] = 0.0;
+                l->z1[i][lane] = 0.0;
+                l->z2[i][lane] = 0.0;
+            }
+        }
+    }
+
+    l->num_sections = num_sections;
+    l->num_lanes = count;
+}
+
+/**
+ * Copy lane state back into the filters it was loaded from
+ *
+ * @param l Lane group
+ * @param filters One filter per active lane
+ */
+void iirdsp_lanes_store_state(const iirdsp_lanes_t* l, iirdsp_filter_t* filters)
+{
+    for (int lane = 0; lane < l->num_lanes; lane++) {
+        for (int i = 0; i < filters[lane].num_sections; i++) {
+            filters[lane].sections[i].z1 = l->z1[i][lane];
+            filters[lane].sections[i].z2 = l->z2[i][lane];
+        }
+    }
+}
+
+/**
+ * Zero the state of every lane
+ *
+ * @param l Lane group
+ */
+void iirdsp_lanes_reset(iirdsp_lanes_t* l)
+{
+    for (int i = 0; i < IIRDSP_MAX_SECTIONS; i++) {
+        for (int lane = 0; lane < L; lane++) {
+            l->z1[i][lane] = 0.0;
+            l->z2[i][lane] = 0.0;
+        }
+    }
+}
+
+/**
+ * Run one lane vector through every section, in place
+ *
+ * The lane loop has a compile-time trip count of IIRDSP_LANES, so each
+ * section update becomes a handful of vector multiply/adds.
+ */
+static inline void lanes_step(iirdsp_lanes_t* l, iirdsp_real* v)
+{
+    for (int i = 0; i < l->num_sections; i++) {
+        for (int lane = 0; lane < L; lane++) {
+            iirdsp_real in = v[lane];
+            iirdsp_real out = l->b0[i][lane] * in + l->z1[i][lane];
+            l->z1[i][lane] = l->b1[i][lane] * in - l->a1[i][lane] * out + l->z2[i][lane];
+            l->z2[i][lane] = l->b2[i][lane] * in - l->a2[i][lane] * out;
+            v[lane] = out;
+        }
+    }
+}
+
+/**
+ * Filter N lane vectors
+ *
+ * @param l Lane group
+ * @param x Input lane vectors
+ * @param y Output lane vectors, can alias x
+ * @param N Number of lane vectors
+ */
+void iirdsp_lanes_process(
+    iirdsp_lanes_t* l,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+)
+{
+    for (int n = 0; n < N; n++) {
+        iirdsp_real v[L];
+
+        for (int lane = 0; lane < L; lane++) {
+            v[lane] = x[n * L + lane];
+        }
+        lanes_step(l, v);
+        for (int lane = 0; lane < L; lane++) {
+            y[n * L + lane] = v[lane];
+        }
+    }
+}
+
+/**
+ * Workspace needed by iirdsp_filtfilt_multi()
+ *
+ * One lane group's forward pass: N lane vectors.
+ *
+ * @param N Samples per channel
+ * @return Number of iirdsp_real elements
+ */
+size_t iirdsp_filtfilt_multi_work_size(int N)
+{
+    return (size_t)(N > 0 ? N : 0) * L;
+}
+
+/**
+ * Zero-phase filtering of C channels in one call
+ *
+ * For each group of IIRDSP_LANES channels:
+ *   1. Gather x into lane vectors and filter forward → work
+ *   2. Reset lane state
+ *   3. Filter work from last to first vector, scattering into y
+ *
+ * A group's input is fully consumed before its output is written, and
+ * groups touch disjoint channels, so y may alias x.
+ *
+ * @param filters Filter coefficients (1 or channels entries)
+ * @param num_filters 1 for shared coefficients, or channels
+ * @param x Input samples
+ * @param y Output samples, can alias x
+ * @param channels Number of channels C
+ * @param N Samples per channel
+ * @param layout Sample layout of x and y
+ * @param work Workspace, or NULL to allocate internally
+ * @return 0 on success, negative error code on failure
+ */
+int iirdsp_filtfilt_multi(
+    const iirdsp_filter_t* filters,
+    int num_filters,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int channels,
+    int N,
+    iirdsp_layout_t layout,
+    iirdsp_real* work
+)
+{
+    if (filters == NULL || x == NULL || y == NULL || channels <= 0 || N < 0 ||
+        (num_filters != 1 && num_filters != channels)) {
+        return -1;  /* Invalid arguments */
+    }
+    if (N == 0) {
+        return 0;
+    }
+
+    iirdsp_real* owned = NULL;
+    if (work == NULL) {
+        owned = (iirdsp_real*)malloc(iirdsp_filtfilt_multi_work_size(N) * sizeof(iirdsp_real));
+        if (owned == NULL) {
+            return -2;  /* Out of memory */
+        }
+        work = owned;
+    }
+
+    /* Element (c, n) lives at c * ch_stride + n * n_stride */
+    const size_t ch_stride = layout == IIRDSP_LAYOUT_PLANAR ? (size_t)N : 1;
+    const size_t n_stride = layout == IIRDSP_LAYOUT_PLANAR ? 1 : (size_t)channels;
+    iirdsp_lanes_t lanes;
+
+    for (int c0 = 0; c0 < channels; c0 += L) {
+        int count = channels - c0 < L ? channels - c0 : L;
+        const iirdsp_filter_t* first = num_filters == 1 ? filters : filters + c0;
+
+        iirdsp_lanes_load(&lanes, first, num_filters == 1 ? 0 : 1, count);
+        iirdsp_lanes_reset(&lanes);
+
+        /* Forward pass: gather into work, filter in place */
+        for (int n = 0; n < N; n++) {
+            for (int lane = 0; lane < L; lane++) {
+                work[(size_t)n * L + lane] = lane < count
+                    ? x[(c0 + lane) * ch_stride + n * n_stride]
+                    : 0.0;
+            }
+        }
+        iirdsp_lanes_process(&lanes, work, work, N);
+
+        /* Backward pass: walk work from the end, filter, scatter into y */
+        iirdsp_lanes_reset(&lanes);
+        for (int n = N - 1; n >= 0; n--) {
+            iirdsp_real* v = work + (size_t)n * L;
+            lanes_step(&lanes, v);
+            for (int lane = 0; lane < count; lane++) {
+                y[(c0 + lane) * ch_stride + n * n_stride] = v[lane];
+            }
+        }
+    }
+
+    free(owned);
+    return 0;
+}
+
+/**
+ * Pick a tile shape for a cache hierarchy
+ *
+ * @param channels Number of channels
+ * @param layout Sample layout
+ * @param l1_bytes L1 data cache size, 0 for the default
+ * @param l2_bytes L2 cache size, 0 for the default
+ * @return Tile shape
+ */
+iirdsp_tiling_t iirdsp_tiling_choose(
+    int channels,
+    iirdsp_layout_t layout,
+    size_t l1_bytes,
+    size_t l2_bytes
+)
+{
+    iirdsp_tiling_t t;
+    size_t state = (l1_bytes > 0 ? l1_bytes : IIRDSP_L1_BYTES) / 2;
+    size_t data = (l2_bytes > 0 ? l2_bytes : IIRDSP_L2_BYTES) / 4;
+    int padded = (channels > 0 ? channels + L - 1 : L) / L * L;
+    size_t per_sample;
+    size_t len;
+
+    /* Group: the state of its lane groups in half of L1 */
+    t.group_channels = (int)(state / sizeof(iirdsp_lanes_t)) * L;
+    if (t.group_channels < L) {
+        t.group_channels = L;
+    }
+    if (t.group_channels > padded) {
+        t.group_channels = padded;
+    }
+
+    /* Tile: the input and output rows it covers in a quarter of L2 */
+    per_sample = 2 * sizeof(iirdsp_real) *
+        (size_t)(layout == IIRDSP_LAYOUT_INTERLEAVED ? padded : t.group_channels);
+    len = data / per_sample / 16 * 16;
+    t.tile_samples = len < 16 ? 16 : len > (1 << 20) ? (1 << 20) : (int)len;
+    return t;
+}
+
+static int group_of(const iirdsp_tiling_t* t)
+{
+    return (t->group_channels + L - 1) / L * L;
+}
+
+/**
+ * Workspace needed by iirdsp_process_multi()
+ *
+ * One lane group per IIRDSP_LANES channels, holding the channels' state
+ * for the whole call.
+ *
+ * @param channels Number of channels
+ * @return Number of iirdsp_lanes_t elements
+ */
+size_t iirdsp_process_multi_work_size(int channels)
+{
+    return (size_t)(channels > 0 ? (channels + L - 1) / L : 0);
+}
+
+/**
+ * One lane vector of lane group l at (b, n): gather, step, scatter
+ */
+static inline void tile_step(
+    iirdsp_lanes_t* l,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    size_t at,
+    size_t ch_stride,
+    int used
+)
+{
+    iirdsp_real v[L];
+
+    for (int lane = 0; lane < L; lane++) {
+        v[lane] = lane < used ? x[at + lane * ch_stride] : 0.0;
+    }
+    lanes_step(l, v);
+    for (int lane = 0; lane < used; lane++) {
+        y[at + lane * ch_stride] = v[lane];
+    }
+}
+
+/**
+ * Filter channels [c0, c0 + count) over samples [n0, n0 + len)
+ *
+ * Interleaved tiles are walked row by row, each row a contiguous run of
+ * the group's samples, with every lane group of the group live; planar
+ * tiles one lane group at a time, each reading IIRDSP_LANES contiguous
+ * streams.
+ */
+static void run_tile(
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    size_t ch_stride,
+    size_t n_stride,
+    int c0,
+    int count,
+    int n0,
+    int len,
+    iirdsp_lanes_t* lanes
+)
+{
+    const int blocks = (count + L - 1) / L;
+
+    lanes += c0 / L;
+    if (ch_stride == 1) {
+        const int full = count / L;
+
+        for (int n = n0; n < n0 + len; n++) {
+            const iirdsp_real* in = x + (size_t)n * n_stride + c0;
+            iirdsp_real* out = y + (size_t)n * n_stride + c0;
+
+            for (int k = 0; k < full; k++) {
+                iirdsp_real v[L];
+
+                for (int lane = 0; lane < L; lane++) {
+                    v[lane] = in[k * L + lane];
+                }
+                lanes_step(&lanes[k], v);
+                for (int lane = 0; lane < L; lane++) {
+                    out[k * L + lane] = v[lane];
+                }
+            }
+            if (full < blocks) {
+                tile_step(&lanes[full], x, y, (size_t)n * n_stride + (size_t)(c0 + full * L), 1, count - full * L);
+            }
+        }
+    } else {
+        for (int k = 0; k < blocks; k++) {
+            const int used = count - k * L < L ? count - k * L : L;
+            for (int n = n0; n < n0 + len; n++) {
+                tile_step(&lanes[k], x, y, (size_t)(c0 + k * L) * ch_stride + (size_t)n, ch_stride, used);
+            }
+        }
+    }
+}
+
+/**
+ * Stateful filtering of C channels in time x channel tiles
+ *
+ * The filters are loaded into lane groups (work) up front and their state
+ * stored back at the end. Every lane vector is read before it is written,
+ * and tiles are disjoint, so y may alias x.
+ *
+ * @param filters One filter per channel, updated
+ * @param x Input samples
+ * @param y Output samples, can alias x
+ * @param channels Number of channels C
+ * @param N Samples per channel
+ * @param layout Sample layout of x and y
+ * @param tiling Tile shape, or NULL for the default
+ * @param work Workspace, or NULL to allocate internally
+ * @return 0 on success, negative error code on failure
+ */
+int iirdsp_process_multi(
+    iirdsp_filter_t* filters,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int channels,
+    int N,
+    iirdsp_layout_t layout,
+    const iirdsp_tiling_t* tiling,
+    iirdsp_lanes_t* work
+)
+{
+    iirdsp_tiling_t t;
+
+    if (filters == NULL || x == NULL || y == NULL || channels <= 0 || N < 0) {
+        return -1;  /* Invalid arguments */
+    }
+    t = tiling != NULL ? *tiling : iirdsp_tiling_choose(channels, layout, 0, 0);
+    if (t.group_channels <= 0 || t.tile_samples <= 0) {
+        return -1;
+    }
+    if (N == 0) {
+        return 0;
+    }
+
+    iirdsp_lanes_t* owned = NULL;
+    if (work == NULL) {
+        owned = (iirdsp_lanes_t*)malloc(iirdsp_process_multi_work_size(channels) * sizeof(iirdsp_lanes_t));
+        if (owned == NULL) {
+            return -2;  /* Out of memory */
+        }
+        work = owned;
+    }
+
+    /* Element (c, n) lives at c * ch_stride + n * n_stride */
+    const size_t ch_stride = layout == IIRDSP_LAYOUT_PLANAR ? (size_t)N : 1;
+    const size_t n_stride = layout == IIRDSP_LAYOUT_PLANAR ? 1 : (size_t)channels;
+    const int G = group_of(&t);
+    const int T = t.tile_samples;
+
+    for (int c0 = 0; c0 < channels; c0 += L) {
+        iirdsp_lanes_load(&work[c0 / L], filters + c0, 1, channels - c0 < L ? channels - c0 : L);
+    }
+
+    if (layout == IIRDSP_LAYOUT_INTERLEAVED) {
+        /* Time-major: one tile's rows serve every group while in L2 */
+        for (int n0 = 0; n0 < N; n0 += T) {
+            for (int c0 = 0; c0 < channels; c0 += G) {
+                run_tile(x, y, ch_stride, n_stride, c0,
+                         channels - c0 < G ? channels - c0 : G, n0, N - n0 < T ? N - n0 : T, work);
+            }
+        }
+    } else {
+        /* Group-major: the group's lane state stays in L1 across its tiles */
+        for (int c0 = 0; c0 < channels; c0 += G) {
+            for (int n0 = 0; n0 < N; n0 += T) {
+                run_tile(x, y, ch_stride, n_stride, c0,
+                         channels - c0 < G ? channels - c0 : G, n0, N - n0 < T ? N - n0 : T, work);
+            }
+        }
+    }
+
+    for (int c0 = 0; c0 < channels; c0 += L) {
+        iirdsp_lanes_store_state(&work[c0 / L], filters + c0);
+    }
+    free(owned);
+    return 0;
+}
@@ -0,0 +1,674 @@
+/**
+ * @file numa_bank.c
+ * @brief NUMA-aware filter bank implementation
+ *
+ * Node memory (the group's filters, then its sample buffers) comes from
+ * a private anonymous mapping, so none of its pages has been touched
+ * before the node's first worker writes it; with the default local
+ * allocation policy that write places every page on the worker's node.
+ * malloc() could hand back pages another thread already touched.
+ *
+ * A run publishes its arguments under the bank lock, resets each node's
+ * task counter and bumps the generation. Workers claim tasks (runs of
+ * adjacent channels) from their own node's counter with an atomic add,
+ * then from the other nodes' counters in turn, and report back under the
+ * lock when nothing is left.
+ */
+
+#define _GNU_SOURCE
+
+#include "numa_bank.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define NODE_DIR "/sys/devices/system/node"
+#define MAX_NODES 64
+#define MAX_CPUS 1024
+#define TASKS_PER_THREAD 4
+
+/**
+ * Task counter of one node, alone on its cache line
+ */
+typedef struct {
+    int next;
+    char pad[IIRDSP_CACHE_LINE - sizeof(int)];
+} claim_t;
+
+typedef struct {
+    int id;                     /* System node number */
+    int num_cpus;
+    int cpus[MAX_CPUS];
+} topo_node_t;
+
+typedef struct {
+    int id;
+    int first_channel;
+    int num_channels;
+    int num_threads;
+    int chunk;                  /* Channels per task */
+    int num_tasks;
+    int num_cpus;
+    int* cpus;
+    void* mem;                  /* Node-local mapping */
+    size_t mem_size;
+    iirdsp_filter_t* filters;   /* num_channels */
+    iirdsp_real* buffers;       /* num_channels * buffer_stride */
+} node_t;
+
+typedef struct {
+    struct iirdsp_bank* b;
+    int node;
+    int cpu;                    /* -1 = not pinned */
+    int leader;                 /* Allocates the node's memory */
+    pthread_t thread;
+} worker_t;
+
+struct iirdsp_bank {
+    int channels;
+    int block_size;
+    int buffer_stride;
+    unsigned flags;
+    int num_nodes;
+    int num_workers;
+    int started;
+    node_t* nodes;
+    claim_t* claims;
+    worker_t* workers;
+    topo_node_t* topo;
+    const iirdsp_filter_t* init_filters;
+    int num_init_filters;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    unsigned generation;
+    int busy;                   /* Workers still in the current run */
+    int ready;                  /* Workers through start-up */
+    int failed;
+    int stop;
+    const iirdsp_real* x;       /* NULL = node-local buffers */
+    iirdsp_real* y;
+    int N;
+};
+
+/**
+ * Parse a sysfs cpulist ("0-3,8,10-11") and keep the allowed CPUs
+ */
+static int parse_cpulist(const char* s, const cpu_set_t* allowed, int* cpus)
+{
+    int count = 0;
+
+    while (*s != '\0' && *s != '\n') {
+        char* end;
+        long lo = strtol(s, &end, 10);
+        long hi = lo;
+
+        if (end == s) {
+            break;
+        }
+        s = end;
+        if (*s == '-') {
+            hi = strtol(s + 1, &end, 10);
+            s = end;
+        }
+        for (long c = lo; c <= hi && c < MAX_CPUS; c++) {
+            if (CPU_ISSET((int)c, allowed) && count < MAX_CPUS) {
+                cpus[count++] = (int)c;
+            }
+        }
+        if (*s == ',') {
+            s++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Read the nodes that have usable CPUs; falls back to one node holding
+ * every usable CPU
+ */
+static int detect_topology(topo_node_t* topo, const cpu_set_t* allowed)
+{
+    int count = 0;
+    DIR* dir = opendir(NODE_DIR);
+
+    if (dir != NULL) {
+        struct dirent* e;
+
+        while ((e = readdir(dir)) != NULL && count < MAX_NODES) {
+            char path[512];
+            char list[4096];
+            char* end;
+            long id;
+            FILE* fp;
+
+            if (strncmp(e->d_name, "node", 4) != 0) {
+                continue;
+            }
+            id = strtol(e->d_name + 4, &end, 10);
+            if (end == e->d_name + 4 || *end != '\0') {
+                continue;
+            }
+            snprintf(path, sizeof(path), NODE_DIR "/%s/cpulist", e->d_name);
+            fp = fopen(path, "r");
+            if (fp == NULL) {
+                continue;
+            }
+            if (fgets(list, sizeof(list), fp) != NULL) {
+                topo[count].id = (int)id;
+                topo[count].num_cpus = parse_cpulist(list, allowed, topo[count].cpus);
+                /* Memory-only nodes and nodes outside the affinity mask run nothing */
+                if (topo[count].num_cpus > 0) {
+                    count++;
+                }
+            }
+            fclose(fp);
+        }
+        closedir(dir);
+    }
+
+    /* readdir() order is arbitrary */
+    for (int i = 1; i < count; i++) {
+        for (int j = i; j > 0 && topo[j - 1].id > topo[j].id; j--) {
+            topo_node_t t = topo[j];
+            topo[j] = topo[j - 1];
+            topo[j - 1] = t;
+        }
+    }
+
+    if (count == 0) {
+        topo[0].id = 0;
+        topo[0].num_cpus = 0;
+        for (int c = 0; c < MAX_CPUS; c++) {
+            if (CPU_ISSET(c, allowed)) {
+                topo[0].cpus[topo[0].num_cpus++] = c;
+            }
+        }
+        count = 1;
+    }
+    return count;
+}
+
+/**
+ * Split the usable CPUs into num_nodes equal nodes
+ */
+static int emulate_topology(topo_node_t* topo, const cpu_set_t* allowed, int num_nodes)
+{
+    int cpus[MAX_CPUS];
+    int total = 0;
+
+    for (int c = 0; c < MAX_CPUS; c++) {
+        if (CPU_ISSET(c, allowed)) {
+            cpus[total++] = c;
+        }
+    }
+    for (int k = 0; k < num_nodes; k++) {
+        int lo = k * total / num_nodes;
+        int hi = (k + 1) * total / num_nodes;
+
+        topo[k].id = k;
+        topo[k].num_cpus = 0;
+        /* Fewer CPUs than nodes: nodes share them */
+        if (hi == lo) {
+            topo[k].cpus[topo[k].num_cpus++] = cpus[k % total];
+        }
+        for (int i = lo; i < hi; i++) {
+            topo[k].cpus[topo[k].num_cpus++] = cpus[i];
+        }
+    }
+    return num_nodes;
+}
+
+static size_t round_up(size_t n, size_t to)
+{
+    return (n + to - 1) / to * to;
+}
+
+/**
+ * Map and initialize one node's memory; the calling thread touches
+ * every page first
+ */
+static int node_alloc(iirdsp_bank_t* b, node_t* nd)
+{
+    size_t filters_size = round_up((size_t)nd->num_channels * sizeof(iirdsp_filter_t), IIRDSP_CACHE_LINE);
+    size_t buffers_size = (size_t)nd->num_channels * (size_t)b->buffer_stride * sizeof(iirdsp_real);
+    void* mem;
+
+    if (nd->num_channels == 0) {
+        return 0;
+    }
+    nd->mem_size = round_up(filters_size + buffers_size, (size_t)sysconf(_SC_PAGESIZE));
+    mem = mmap(NULL, nd->mem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        nd->mem_size = 0;
+        return -1;
+    }
+    nd->mem = mem;
+    nd->filters = (iirdsp_filter_t*)mem;
+    nd->buffers = (iirdsp_real*)((char*)mem + filters_size);
+    for (int i = 0; i < nd->num_channels; i++) {
+        int c = nd->first_channel + i;
+        nd->filters[i] = b->init_filters[b->num_init_filters == 1 ? 0 : c];
+    }
+    memset(nd->buffers, 0, buffers_size);
+    return 0;
+}
+
+static void run_task(iirdsp_bank_t* b, node_t* nd, int task)
+{
+    int lo = task * nd->chunk;
+    int hi = lo + nd->chunk < nd->num_channels ? lo + nd->chunk : nd->num_channels;
+    const size_t N = (size_t)b->N;
+
+    for (int i = lo; i < hi; i++) {
+        size_t c = (size_t)(nd->first_channel + i);
+
+        if (b->x != NULL) {
+            iirdsp_process_buffer(&nd->filters[i], b->x + c * N, b->y + c * N, b->N);
+        } else {
+            iirdsp_real* buf = nd->buffers + (size_t)i * (size_t)b->buffer_stride;
+            iirdsp_process_buffer(&nd->filters[i], buf, buf, b->N);
+        }
+    }
+}
+
+/**
+ * Drain the home node's queue, then help the other nodes
+ */
+static void run_tasks(iirdsp_bank_t* b, int home)
+{
+    for (int i = 0; i < b->num_nodes; i++) {
+        int k = (home + i) % b->num_nodes;
+        node_t* nd = &b->nodes[k];
+        int t;
+
+        while ((t = __atomic_fetch_add(&b->claims[k].next, 1, __ATOMIC_RELAXED)) < nd->num_tasks) {
+            run_task(b, nd, t);
+        }
+    }
+}
+
+static void* bank_worker(void* arg)
+{
+    worker_t* w = (worker_t*)arg;
+    iirdsp_bank_t* b = w->b;
+    unsigned seen = 0;
+    int failed = 0;
+
+    if (w->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->cpu, &set);
+        /* Best effort: an unpinned worker still computes correctly */
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (w->leader && !(b->flags & IIRDSP_BANK_CALLER_ALLOC)) {
+        failed = node_alloc(b, &b->nodes[w->node]) != 0;
+    }
+
+    pthread_mutex_lock(&b->lock);
+    b->failed |= failed;
+    b->ready++;
+    pthread_cond_broadcast(&b->done);
+    for (;;) {
+        while (!b->stop && b->generation == seen) {
+            pthread_cond_wait(&b->wake, &b->lock);
+        }
+        if (b->stop) {
+            break;
+        }
+        seen = b->generation;
+        pthread_mutex_unlock(&b->lock);
+
+        run_tasks(b, w->node);
+
+        pthread_mutex_lock(&b->lock);
+        if (--b->busy == 0) {
+            pthread_cond_signal(&b->done);
+        }
+    }
+    pthread_mutex_unlock(&b->lock);
+    return NULL;
+}
+
+/**
+ * Hand out threads to nodes in proportion to their CPUs (at least one
+ * each), then channels in proportion to threads
+ */
+static void lay_out(iirdsp_bank_t* b, int threads)
+{
+    int assigned = 0;
+
+    for (int k = 0; k < b->num_nodes; k++) {
+        b->nodes[k].num_threads = 1;
+    }
+    for (int r = b->num_nodes; r < threads; r++) {
+        int best = 0;
+        for (int k = 1; k < b->num_nodes; k++) {
+            /* Fewest threads per CPU gets the next one */
+            if ((long)b->nodes[k].num_threads * b->nodes[best].num_cpus <
+                (long)b->nodes[best].num_threads * b->nodes[k].num_cpus) {
+                best = k;
+            }
+        }
+        b->nodes[best].num_threads++;
+    }
+    for (int k = 0; k < b->num_nodes; k++) {
+        node_t* nd = &b->nodes[k];
+        int per_task;
+
+        nd->first_channel = (int)((long)b->channels * assigned / threads);
+        assigned += nd->num_threads;
+        nd->num_channels = (int)((long)b->channels * assigned / threads) - nd->first_channel;
+        per_task = nd->num_threads * TASKS_PER_THREAD;
+        nd->chunk = nd->num_channels / per_task > 0 ? nd->num_channels / per_task : 1;
+        nd->num_tasks = (nd->num_channels + nd->chunk - 1) / nd->chunk;
+    }
+}
+
+/**
+ * Lay out the channels over the nodes and start the workers
+ *
+ * @param filters One filter per channel, or a single filter used for all
+ * @param num_filters channels, or 1
+ * @param channels Number of channels
+ * @param block_size Samples per channel in the node-local buffers
+ * @param config Options, or NULL for defaults
+ * @return New bank, or NULL on failure
+ */
+iirdsp_bank_t* iirdsp_bank_create(
+    const iirdsp_filter_t* filters,
+    int num_filters,
+    int channels,
+    int block_size,
+    const iirdsp_bank_config_t* config
+)
+{
+    static const iirdsp_bank_config_t defaults = { 0, 0, 0 };
+    iirdsp_bank_t* b;
+    cpu_set_t allowed;
+    int usable = 0;
+    int threads;
+    int topo_count;
+    int w = 0;
+
+    if (config == NULL) {
+        config = &defaults;
+    }
+    if (filters == NULL || channels <= 0 || (num_filters != 1 && num_filters != channels) || block_size < 0 ||
+        config->num_threads < 0 || config->num_nodes < 0 || config->num_nodes > MAX_NODES) {
+        return NULL;
+    }
+    for (int i = 0; i < num_filters; i++) {
+        if (filters[i].num_sections < 0 || filters[i].num_sections > IIRDSP_MAX_SECTIONS) {
+            return NULL;
+        }
+    }
+
+    b = (iirdsp_bank_t*)calloc(1, sizeof(*b));
+    if (b == NULL) {
+        return NULL;
+    }
+    b->channels = channels;
+    b->block_size = block_size;
+    b->buffer_stride = (int)(round_up((size_t)block_size * sizeof(iirdsp_real), IIRDSP_CACHE_LINE) /
+                             sizeof(iirdsp_real));
+    b->flags = config->flags;
+    b->init_filters = filters;
+    b->num_init_filters = num_filters;
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->wake, NULL);
+    pthread_cond_init(&b->done, NULL);
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        CPU_ZERO(&allowed);
+        CPU_SET(0, &allowed);
+    }
+    for (int c = 0; c < MAX_CPUS; c++) {
+        usable += CPU_ISSET(c, &allowed) ? 1 : 0;
+    }
+    b->topo = (topo_node_t*)malloc(MAX_NODES * sizeof(topo_node_t));
+    if (b->topo == NULL) {
+        iirdsp_bank_destroy(b);
+        return NULL;
+    }
+    topo_count = config->num_nodes > 0 ? emulate_topology(b->topo, &allowed, config->num_nodes)
+                                       : detect_topology(b->topo, &allowed);
+
+    threads = config->num_threads > 0 ? config->num_threads : usable;
+    threads = threads < channels ? threads : channels;
+    b->num_nodes = topo_count < threads ? topo_count : threads;
+    b->num_workers = threads;
+    b->nodes = (node_t*)calloc((size_t)b->num_nodes, sizeof(node_t));
+    b->workers = (worker_t*)calloc((size_t)threads, sizeof(worker_t));
+    if (posix_memalign((void**)&b->claims, IIRDSP_CACHE_LINE, (size_t)b->num_nodes * sizeof(claim_t)) != 0) {
+        b->claims = NULL;
+    }
+    if (b->nodes == NULL || b->workers == NULL || b->claims == NULL) {
+        iirdsp_bank_destroy(b);
+        return NULL;
+    }
+    memset(b->claims, 0, (size_t)b->num_nodes * sizeof(claim_t));
+    for (int k = 0; k < b->num_nodes; k++) {
+        b->nodes[k].id = b->topo[k].id;
+        b->nodes[k].num_cpus = b->topo[k].num_cpus;
+        b->nodes[k].cpus = b->topo[k].cpus;
+    }
+    lay_out(b, threads);
+
+    if (b->flags & IIRDSP_BANK_CALLER_ALLOC) {
+        for (int k = 0; k < b->num_nodes; k++) {
+            if (node_alloc(b, &b->nodes[k]) != 0) {
+                iirdsp_bank_destroy(b);
+                return NULL;
+            }
+        }
+    }
+
+    for (int k = 0; k < b->num_nodes; k++) {
+        node_t* nd = &b->nodes[k];
+        for (int j = 0; j < nd->num_threads; j++, w++) {
+            worker_t* wk = &b->workers[w];
+
+            wk->b = b;
+            wk->node = k;
+            wk->cpu = (b->flags & IIRDSP_BANK_NO_PIN) ? -1 : nd->cpus[j % nd->num_cpus];
+            wk->leader = j == 0;
+            if (pthread_create(&wk->thread, NULL, bank_worker, wk) != 0) {
+                iirdsp_bank_destroy(b);
+                return NULL;
+            }
+            b->started++;
+        }
+    }
+
+    pthread_mutex_lock(&b->lock);
+    while (b->ready < b->started) {
+        pthread_cond_wait(&b->done, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+    b->init_filters = NULL;
+    if (b->failed) {
+        iirdsp_bank_destroy(b);
+        return NULL;
+    }
+    return b;
+}
+
+/**
+ * Stop the workers and free the bank
+ *
+ * @param b Bank, or NULL
+ */
+void iirdsp_bank_destroy(iirdsp_bank_t* b)
+{
+    if (b == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&b->lock);
+    b->stop = 1;
+    pthread_cond_broadcast(&b->wake);
+    pthread_mutex_unlock(&b->lock);
+    for (int i = 0; i < b->started; i++) {
+        pthread_join(b->workers[i].thread, NULL);
+    }
+    if (b->nodes != NULL) {
+        for (int k = 0; k < b->num_nodes; k++) {
+            if (b->nodes[k].mem != NULL) {
+                munmap(b->nodes[k].mem, b->nodes[k].mem_size);
+            }
+        }
+    }
+    pthread_cond_destroy(&b->done);
+    pthread_cond_destroy(&b->wake);
+    pthread_mutex_destroy(&b->lock);
+    free(b->claims);
+    free(b->workers);
+    free(b->nodes);
+    free(b->topo);
+    free(b);
+}
+
+/**
+ * Run every channel on the workers and wait for them
+ */
+static void dispatch(iirdsp_bank_t* b, const iirdsp_real* x, iirdsp_real* y, int N)
+{
+    pthread_mutex_lock(&b->lock);
+    b->x = x;
+    b->y = y;
+    b->N = N;
+    for (int k = 0; k < b->num_nodes; k++) {
+        b->claims[k].next = 0;
+    }
+    b->busy = b->num_workers;
+    b->generation++;
+    pthread_cond_broadcast(&b->wake);
+    while (b->busy > 0) {
+        pthread_cond_wait(&b->done, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
+/**
+ * Filter caller buffers
+ *
+ * @param b Bank
+ * @param x Input, planar
+ * @param y Output, planar, can alias x
+ * @param N Samples per channel
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_bank_process(iirdsp_bank_t* b, const iirdsp_real* x, iirdsp_real* y, int N)
+{
+    if (b == NULL || x == NULL || y == NULL || N < 0) {
+        return -1;
+    }
+    if (N > 0) {
+        dispatch(b, x, y, N);
+    }
+    return 0;
+}
+
+static node_t* node_of(const iirdsp_bank_t* b, int channel)
+{
+    for (int k = 0; k < b->num_nodes; k++) {
+        if (channel < b->nodes[k].first_channel + b->nodes[k].num_channels) {
+            return &b->nodes[k];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Node-local sample buffer of one channel
+ *
+ * @param b Bank
+ * @param channel Channel index
+ * @return block_size samples, or NULL
+ */
+iirdsp_real* iirdsp_bank_buffer(iirdsp_bank_t* b, int channel)
+{
+    node_t* nd;
+
+    if (b == NULL || b->block_size == 0 || channel < 0 || channel >= b->channels) {
+        return NULL;
+    }
+    nd = node_of(b, channel);
+    return nd->buffers + (size_t)(channel - nd->first_channel) * (size_t)b->buffer_stride;
+}
+
+/**
+ * Filter the first N samples of every node-local buffer in place
+ *
+ * @param b Bank
+ * @param N Samples per channel
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_bank_run(iirdsp_bank_t* b, int N)
+{
+    if (b == NULL || N < 0 || N > b->block_size) {
+        return -1;
+    }
+    if (N > 0) {
+        dispatch(b, NULL, NULL, N);
+    }
+    return 0;
+}
+
+/**
+ * Clear the state of every channel
+ *
+ * @param b Bank
+ */
+void iirdsp_bank_reset(iirdsp_bank_t* b)
+{
+    for (int k = 0; k < b->num_nodes; k++) {
+        for (int i = 0; i < b->nodes[k].num_channels; i++) {
+            iirdsp_filter_reset(&b->nodes[k].filters[i]);
+        }
+    }
+}
+
+/**
+ * Number of nodes the bank spreads over
+ *
+ * @param b Bank
+ * @return Node count
+ */
+int iirdsp_bank_num_nodes(const iirdsp_bank_t* b)
+{
+    return b->num_nodes;
+}
+
+/**
+ * Number of worker threads
+ *
+ * @param b Bank
+ * @return Worker count
+ */
+int iirdsp_bank_num_threads(const iirdsp_bank_t* b)
+{
+    return b->num_workers;
+}
+
+/**
+ * NUMA node holding a channel's state and buffer
+ *
+ * @param b Bank
+ * @param channel Channel index
+ * @return Node number, -1 if the channel is out of range
+ */
+int iirdsp_bank_node_of(const iirdsp_bank_t* b, int channel)
+{
+    if (b == NULL || channel < 0 || channel >= b->channels) {
+        return -1;
+    }
+    return node_of(b, channel)->id;
+}
@@ -0,0 +1,290 @@
+/**
+ * @file pipeline.c
+ * @brief Pipeline description compiler and fused executor
+ */
+
+#include "pipeline.h"
+#include "butter.h"
+#include "notch.h"
+#include <stdio.h>
+
+#define LINE_MAX_CHARS 128
+
+/**
+ * Append a designed cascade, merging into the previous cascade if it fits
+ *
+ * @return 0 on success, -3 if the operation list is full
+ */
+static int append_cascade(iirdsp_pipeline_t* p, const iirdsp_filter_t* f)
+{
+    iirdsp_pipeline_op_t* last = p->num_ops > 0 ? &p->ops[p->num_ops - 1] : NULL;
+
+    if (last != NULL && last->kind == IIRDSP_OP_CASCADE &&
+        last->filter.num_sections + f->num_sections <= IIRDSP_MAX_SECTIONS) {
+        for (int i = 0; i < f->num_sections; i++) {
+            last->filter.sections[last->filter.num_sections++] = f->sections[i];
+        }
+        return 0;
+    }
+
+    if (p->num_ops == IIRDSP_PIPELINE_MAX_OPS) {
+        return -3;
+    }
+    last = &p->ops[p->num_ops++];
+    last->kind = IIRDSP_OP_CASCADE;
+    last->filter = *f;
+    last->factor = 1;
+    last->phase = 0;
+    return 0;
+}
+
+/**
+ * Append a non-mergeable operation
+ *
+ * @return Pointer to the new operation, or NULL if the list is full
+ */
+static iirdsp_pipeline_op_t* append_op(iirdsp_pipeline_t* p, iirdsp_op_kind_t kind)
+{
+    iirdsp_pipeline_op_t* op;
+
+    if (p->num_ops == IIRDSP_PIPELINE_MAX_OPS) {
+        return NULL;
+    }
+    op = &p->ops[p->num_ops++];
+    op->kind = kind;
+    op->filter.num_sections = 0;
+    op->factor = 1;
+    op->phase = 0;
+    return op;
+}
+
+static int is_integer(double v)
+{
+    return v >= 1.0 && v == (double)(int)v;
+}
+
+/**
+ * Compile one stage line
+ *
+ * @return 0 on success (or an empty line), negative error code on failure
+ */
+static int compile_stage(iirdsp_pipeline_t* p, const char* line)
+{
+    char name[16];
+    char extra;
+    double a[3];
+    int argc;
+    iirdsp_filter_t f;
+    iirdsp_pipeline_op_t* op;
+    iirdsp_real fs = p->fs_out;
+
+    argc = sscanf(line, "%15s %lf %lf %lf %c", name, &a[0], &a[1], &a[2], &extra);
+    if (argc <= 0) {
+        return 0;  /* Blank */
+    }
+    argc--;
+
+    if (strcmp(name, "fs") == 0) {
+        if (argc != 1 || p->fs_in > 0.0 || a[0] <= 0.0) {
+            return -1;
+        }
+        p->fs_in = p->fs_out = (iirdsp_real)a[0];
+        return 0;
+    }
+    if (p->fs_in <= 0.0) {
+        return -1;  /* fs must come first */
+    }
+    p->num_stages++;
+
+    if (strcmp(name, "notch") == 0) {
+        if (argc != 2) {
+            return -1;
+        }
+        if (notch_filter_init(&f, (iirdsp_real)a[0], (iirdsp_real)a[1], fs) != 0) {
+            return -2;
+        }
+        return append_cascade(p, &f);
+    }
+    if (strcmp(name, "lowpass") == 0 || strcmp(name, "highpass") == 0) {
+        int err;
+        if (argc != 2 || !is_integer(a[0])) {
+            return -1;
+        }
+        err = name[0] == 'l'
+            ? butter_lowpass_init(&f, (int)a[0], (iirdsp_real)a[1], fs)
+            : butter_highpass_init(&f, (int)a[0], (iirdsp_real)a[1], fs);
+        if (err != 0) {
+            return -2;
+        }
+        return append_cascade(p, &f);
+    }
+    if (strcmp(name, "bandpass") == 0) {
+        if (argc != 3 || !is_integer(a[0])) {
+            return -1;
+        }
+        if (butter_bandpass_init(&f, (int)a[0], (iirdsp_real)a[1], (iirdsp_real)a[2], fs) != 0) {
+            return -2;
+        }
+        return append_cascade(p, &f);
+    }
+    if (strcmp(name, "baseline") == 0) {
+        if (argc != 1) {
+            return -1;
+        }
+        if (butter_lowpass_init(&f, 2, (iirdsp_real)a[0], fs) != 0) {
+            return -2;
+        }
+        op = append_op(p, IIRDSP_OP_BASELINE);
+        if (op == NULL) {
+            return -3;
+        }
+        op->filter = f;
+        return 0;
+    }
+    if (strcmp(name, "decimate") == 0) {
+        int factor;
+        int err;
+        if (argc != 1 || !is_integer(a[0])) {
+            return -1;
+        }
+        factor = (int)a[0];
+        if (factor == 1) {
+            return 0;
+        }
+        if (butter_lowpass_init(&f, IIRDSP_DECIMATE_ORDER, 0.4 * fs / factor, fs) != 0) {
+            return -2;
+        }
+        err = append_cascade(p, &f);
+        if (err != 0) {
+            return err;
+        }
+        op = append_op(p, IIRDSP_OP_DECIMATE);
+        if (op == NULL) {
+            return -3;
+        }
+        op->factor = factor;
+        p->fs_out = fs / factor;
+        p->decimation *= factor;
+        return 0;
+    }
+
+    return -1;  /* Unknown stage */
+}
+
+int iirdsp_pipeline_compile(iirdsp_pipeline_t* p, const char* text, int* error_line)
+{
+    int line_no = 1;
+
+    p->num_ops = 0;
+    p->num_stages = 0;
+    p->fs_in = 0.0;
+    p->fs_out = 0.0;
+    p->decimation = 1;
+    if (error_line != NULL) {
+        *error_line = 0;
+    }
+
+    while (*text != '\0') {
+        char line[LINE_MAX_CHARS];
+        size_t len = 0;
+        int err;
+
+        /* One stage: up to ';', newline or end; '#' comments out the rest of the line */
+        while (*text != '\0' && *text != '\n' && *text != ';' && *text != '#') {
+            if (len + 1 < sizeof(line)) {
+                line[len++] = *text;
+            }
+            text++;
+        }
+        line[len] = '\0';
+        if (*text == '#') {
+            while (*text != '\0' && *text != '\n') {
+                text++;
+            }
+        }
+
+        err = compile_stage(p, line);
+        if (err != 0) {
+            if (error_line != NULL) {
+                *error_line = line_no;
+            }
+            return err;
+        }
+
+        if (*text == '\n') {
+            line_no++;
+        }
+        if (*text != '\0') {
+            text++;
+        }
+    }
+
+    if (p->fs_in <= 0.0) {
+        if (error_line != NULL) {
+            *error_line = line_no;
+        }
+        return -1;  /* No fs */
+    }
+    return 0;
+}
+
+void iirdsp_pipeline_reset(iirdsp_pipeline_t* p)
+{
+    for (int i = 0; i < p->num_ops; i++) {
+        iirdsp_filter_reset(&p->ops[i].filter);
+        p->ops[i].phase = 0;
+    }
+}
+
+int iirdsp_pipeline_max_output(const iirdsp_pipeline_t* p, int N)
+{
+    return (N + p->decimation - 1) / p->decimation;
+}
+
+int iirdsp_pipeline_process(
+    iirdsp_pipeline_t* p,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_real* y
+)
+{
+    iirdsp_pipeline_op_t* ops = p->ops;
+    const int num_ops = p->num_ops;
+    int count = 0;
+
+    /* A pipeline that compiled to one cascade uses the buffer kernel */
+    if (num_ops == 1 && ops[0].kind == IIRDSP_OP_CASCADE) {
+        iirdsp_process_buffer(&ops[0].filter, x, y, N);
+        return N;
+    }
+
+    for (int n = 0; n < N; n++) {
+        iirdsp_real v = x[n];
+        int keep = 1;
+
+        for (int i = 0; i < num_ops && keep; i++) {
+            iirdsp_pipeline_op_t* op = &ops[i];
+
+            switch (op->kind) {
+            case IIRDSP_OP_CASCADE:
+                v = iirdsp_process_sample(&op->filter, v);
+                break;
+            case IIRDSP_OP_BASELINE:
+                v -= iirdsp_process_sample(&op->filter, v);
+                break;
+            case IIRDSP_OP_DECIMATE:
+                keep = op->phase == 0;
+                if (++op->phase == op->factor) {
+                    op->phase = 0;
+                }
+                break;
+            }
+        }
+
+        if (keep) {
+            y[count++] = v;
+        }
+    }
+
+    return count;
+}
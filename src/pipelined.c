@@ -0,0 +1,347 @@
+/**
+ * @file pipelined.c
+ * @brief Pipeline-parallel cascade implementation
+ *
+ * Blocks live in a ring of num_stages + 1 buffers and are filtered in
+ * place as they move along. Block sequence numbers double as the queue
+ * protocol: links[k].produced counts the blocks stage k has finished, is
+ * written only by stage k (release) and read only by stage k + 1 and,
+ * for the last stage, the caller (acquire). Each link is therefore a
+ * single-producer/single-consumer queue whose slots are the shared block
+ * ring, and no locks are taken. The caller never runs more than
+ * num_stages - 1 blocks ahead of the output it hands back, so the ring
+ * cannot be overrun.
+ *
+ * Idle threads spin briefly, then yield, then sleep in short naps, so an
+ * idle pipeline does not keep its cores busy.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "pipelined.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SPIN_PAUSES 1024
+#define SPIN_YIELDS 64
+#define NAP_NS 20000
+
+/**
+ * Progress of one stage, alone on its cache line
+ */
+typedef struct {
+    size_t produced;
+    char pad[IIRDSP_CACHE_LINE - sizeof(size_t)];
+} link_t;
+
+typedef struct {
+    struct iirdsp_pipelined* p;
+    int index;
+    iirdsp_filter_t* filters;  /* Groups of up to IIRDSP_MAX_SECTIONS sections */
+    int num_filters;
+    pthread_t thread;
+    int started;
+} stage_t;
+
+struct iirdsp_pipelined {
+    link_t links[IIRDSP_PIPELINED_MAX_STAGES];
+    stage_t stages[IIRDSP_PIPELINED_MAX_STAGES];
+    int num_stages;
+    int block_size;
+    int num_blocks;
+    iirdsp_real* blocks;       /* num_blocks * block_size */
+    size_t base;               /* Sequence number of the stream's first block */
+    size_t position;           /* Samples consumed since the stream started */
+    int fill;                  /* Samples staged in the current block */
+    int stop;
+};
+
+static void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * Wait step with escalating backoff
+ */
+static void backoff(unsigned* spins)
+{
+    if (*spins < SPIN_PAUSES) {
+        cpu_relax();
+    } else if (*spins < SPIN_PAUSES + SPIN_YIELDS) {
+        sched_yield();
+    } else {
+        struct timespec nap = { 0, NAP_NS };
+        nanosleep(&nap, NULL);
+    }
+    (*spins)++;
+}
+
+static iirdsp_real* block_at(const iirdsp_pipelined_t* p, size_t seq)
+{
+    return p->blocks + (seq % (size_t)p->num_blocks) * (size_t)p->block_size;
+}
+
+static void run_stage(stage_t* s, iirdsp_real* y, int N)
+{
+    for (int i = 0; i < s->num_filters; i++) {
+        iirdsp_process_buffer(&s->filters[i], y, y, N);
+    }
+}
+
+static void* stage_worker(void* arg)
+{
+    stage_t* s = (stage_t*)arg;
+    iirdsp_pipelined_t* p = s->p;
+    link_t* in = &p->links[s->index - 1];
+    link_t* out = &p->links[s->index];
+
+    for (;;) {
+        size_t seq = out->produced;
+        unsigned spins = 0;
+
+        while (__atomic_load_n(&in->produced, __ATOMIC_ACQUIRE) <= seq) {
+            if (__atomic_load_n(&p->stop, __ATOMIC_RELAXED)) {
+                return NULL;
+            }
+            backoff(&spins);
+        }
+        run_stage(s, block_at(p, seq), p->block_size);
+        __atomic_store_n(&out->produced, seq + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/**
+ * Split a cascade into stages and start the stage threads
+ *
+ * @param filters Cascade, in processing order
+ * @param num_filters Number of filters
+ * @param num_stages Number of stages
+ * @param block_size Samples per block
+ * @return New pipeline, or NULL on failure
+ */
+iirdsp_pipelined_t* iirdsp_pipelined_create(
+    const iirdsp_filter_t* filters,
+    int num_filters,
+    int num_stages,
+    int block_size
+)
+{
+    iirdsp_pipelined_t* p;
+    void* mem = NULL;
+    int total = 0;
+    int next_filter = 0;
+    int next_section = 0;
+
+    if (filters == NULL || num_filters <= 0 || num_stages < 1 || num_stages > IIRDSP_PIPELINED_MAX_STAGES ||
+        block_size <= 0) {
+        return NULL;
+    }
+    for (int i = 0; i < num_filters; i++) {
+        if (filters[i].num_sections < 0 || filters[i].num_sections > IIRDSP_MAX_SECTIONS) {
+            return NULL;
+        }
+        total += filters[i].num_sections;
+    }
+    if (num_stages > total) {
+        return NULL;
+    }
+
+    if (posix_memalign(&mem, IIRDSP_CACHE_LINE, sizeof(*p)) != 0) {
+        return NULL;
+    }
+    p = (iirdsp_pipelined_t*)mem;
+    memset(p, 0, sizeof(*p));
+    p->num_stages = num_stages;
+    p->block_size = block_size;
+    p->num_blocks = num_stages + 1;
+    mem = NULL;
+    if (posix_memalign(&mem, IIRDSP_CACHE_LINE,
+                       (size_t)p->num_blocks * (size_t)block_size * sizeof(iirdsp_real)) != 0) {
+        free(p);
+        return NULL;
+    }
+    p->blocks = (iirdsp_real*)mem;
+
+    /* Stage k takes sections [k * total / S, (k + 1) * total / S) */
+    for (int k = 0; k < num_stages; k++) {
+        stage_t* s = &p->stages[k];
+        int count = (k + 1) * total / num_stages - k * total / num_stages;
+
+        s->p = p;
+        s->index = k;
+        s->filters = (iirdsp_filter_t*)calloc((size_t)(count + IIRDSP_MAX_SECTIONS - 1) / IIRDSP_MAX_SECTIONS,
+                                              sizeof(iirdsp_filter_t));
+        if (s->filters == NULL) {
+            iirdsp_pipelined_destroy(p);
+            return NULL;
+        }
+        for (int n = 0; n < count; n++) {
+            iirdsp_filter_t* g;
+
+            while (next_section == filters[next_filter].num_sections) {
+                next_filter++;
+                next_section = 0;
+            }
+            if (n % IIRDSP_MAX_SECTIONS == 0) {
+                s->num_filters++;
+            }
+            g = &s->filters[s->num_filters - 1];
+            g->sections[g->num_sections++] = filters[next_filter].sections[next_section++];
+        }
+    }
+
+    for (int k = 1; k < num_stages; k++) {
+        stage_t* s = &p->stages[k];
+        if (pthread_create(&s->thread, NULL, stage_worker, s) != 0) {
+            iirdsp_pipelined_destroy(p);
+            return NULL;
+        }
+        s->started = 1;
+    }
+    return p;
+}
+
+/**
+ * Stop the stage threads and free the pipeline
+ *
+ * @param p Pipeline, or NULL
+ */
+void iirdsp_pipelined_destroy(iirdsp_pipelined_t* p)
+{
+    if (p == NULL) {
+        return;
+    }
+    __atomic_store_n(&p->stop, 1, __ATOMIC_RELAXED);
+    for (int k = 0; k < p->num_stages; k++) {
+        if (p->stages[k].started) {
+            pthread_join(p->stages[k].thread, NULL);
+        }
+        free(p->stages[k].filters);
+    }
+    free(p->blocks);
+    free(p);
+}
+
+/**
+ * Delay of the output relative to the input
+ *
+ * @param p Pipeline
+ * @return Latency in samples
+ */
+int iirdsp_pipelined_latency(const iirdsp_pipelined_t* p)
+{
+    return (p->num_stages - 1) * p->block_size;
+}
+
+/**
+ * Copy finished output for the next count stream positions to y
+ */
+static void emit(iirdsp_pipelined_t* p, iirdsp_real* y, int count)
+{
+    const size_t latency = (size_t)iirdsp_pipelined_latency(p);
+    const size_t B = (size_t)p->block_size;
+    link_t* last = &p->links[p->num_stages - 1];
+    int i = 0;
+
+    /* Start of the stream: nothing has come out yet */
+    while (i < count && p->position + (size_t)i < latency) {
+        y[i++] = 0;
+    }
+    while (i < count) {
+        size_t j = p->position + (size_t)i - latency;
+        size_t seq = p->base + j / B;
+        size_t off = j % B;
+        int run = (int)(B - off) < count - i ? (int)(B - off) : count - i;
+        unsigned spins = 0;
+
+        while (__atomic_load_n(&last->produced, __ATOMIC_ACQUIRE) <= seq) {
+            backoff(&spins);
+        }
+        memcpy(y + i, block_at(p, seq) + off, (size_t)run * sizeof(iirdsp_real));
+        i += run;
+    }
+    p->position += (size_t)count;
+}
+
+/**
+ * Stream samples through the pipeline
+ *
+ * @param p Pipeline
+ * @param x Input samples (length N)
+ * @param y Output samples (length N), can alias x
+ * @param N Number of samples
+ * @return 0 on success, -1 on invalid arguments
+ */
+int iirdsp_pipelined_process(
+    iirdsp_pipelined_t* p,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+)
+{
+    int n = 0;
+
+    if (p == NULL || x == NULL || y == NULL || N < 0) {
+        return -1;
+    }
+    if (p->num_stages == 1) {
+        if (N > 0) {
+            iirdsp_process_buffer(&p->stages[0].filters[0], x, y, N);
+            for (int i = 1; i < p->stages[0].num_filters; i++) {
+                iirdsp_process_buffer(&p->stages[0].filters[i], y, y, N);
+            }
+        }
+        return 0;
+    }
+
+    while (n < N) {
+        size_t seq = p->links[0].produced;
+        iirdsp_real* cur = block_at(p, seq);
+        int take = p->block_size - p->fill < N - n ? p->block_size - p->fill : N - n;
+
+        /* Stage the input before writing y, which may alias x */
+        memcpy(cur + p->fill, x + n, (size_t)take * sizeof(iirdsp_real));
+        p->fill += take;
+        if (p->fill == p->block_size) {
+            run_stage(&p->stages[0], cur, p->block_size);
+            __atomic_store_n(&p->links[0].produced, seq + 1, __ATOMIC_RELEASE);
+            p->fill = 0;
+        }
+        emit(p, y + n, take);
+        n += take;
+    }
+    return 0;
+}
+
+/**
+ * Wait for the blocks in flight, then clear all filter state and restart
+ * the stream
+ *
+ * @param p Pipeline
+ */
+void iirdsp_pipelined_reset(iirdsp_pipelined_t* p)
+{
+    size_t submitted = p->links[0].produced;
+    unsigned spins = 0;
+
+    /* Once the last stage has caught up every worker is idle, waiting on its input */
+    while (__atomic_load_n(&p->links[p->num_stages - 1].produced, __ATOMIC_ACQUIRE) < submitted) {
+        backoff(&spins);
+    }
+    for (int k = 0; k < p->num_stages; k++) {
+        for (int i = 0; i < p->stages[k].num_filters; i++) {
+            iirdsp_filter_reset(&p->stages[k].filters[i]);
+        }
+    }
+    p->base = submitted;
+    p->position = 0;
+    p->fill = 0;
+}
@@ -0,0 +1,516 @@
+/**
+ * @file plan.c
+ * @brief Execution plans with measured kernel selection and wisdom files
+ *
+ * Wisdom text format, one entry per line after a header that pins the
+ * precision and lane count of the build:
+ *
+ *   iirdsp-wisdom 1 double 4
+ *   <sections> <channels> <block_size> <planar|interleaved> <kernel> <tile>
+ */
+
+#include "plan.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define L IIRDSP_LANES
+
+#ifdef IIRDSP_USE_FLOAT
+#define PRECISION_NAME "float"
+#else
+#define PRECISION_NAME "double"
+#endif
+
+#define WISDOM_VERSION 1
+#define WISDOM_MAX 256
+
+/**
+ * One remembered planning decision
+ */
+typedef struct {
+    int sections;
+    int channels;
+    int block_size;
+    iirdsp_layout_t layout;
+    iirdsp_kernel_t kernel;
+    int tile;
+} wisdom_entry_t;
+
+static wisdom_entry_t wisdom[WISDOM_MAX];
+static int wisdom_count = 0;
+static pthread_mutex_t wisdom_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char* const kernel_names[IIRDSP_KERNEL_COUNT] = {
+    "scalar", "wavefront", "tiled", "stream", "lanes"
+};
+
+const char* iirdsp_kernel_name(iirdsp_kernel_t k)
+{
+    if ((int)k < 0 || k >= IIRDSP_KERNEL_COUNT) {
+        return "unknown";
+    }
+    return kernel_names[k];
+}
+
+/**
+ * Find an entry by shape; caller holds wisdom_lock
+ */
+static wisdom_entry_t* wisdom_find(int sections, int channels, int block_size,
+                                   iirdsp_layout_t layout)
+{
+    for (int i = 0; i < wisdom_count; i++) {
+        wisdom_entry_t* e = &wisdom[i];
+        if (e->sections == sections && e->channels == channels &&
+            e->block_size == block_size && e->layout == layout) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Insert or replace an entry; caller holds wisdom_lock
+ *
+ * @return 0 on success, -1 if the table is full
+ */
+static int wisdom_store(const wisdom_entry_t* entry)
+{
+    wisdom_entry_t* e = wisdom_find(entry->sections, entry->channels,
+                                    entry->block_size, entry->layout);
+    if (e == NULL) {
+        if (wisdom_count == WISDOM_MAX) {
+            return -1;
+        }
+        e = &wisdom[wisdom_count++];
+    }
+    *e = *entry;
+    return 0;
+}
+
+void iirdsp_wisdom_forget(void)
+{
+    pthread_mutex_lock(&wisdom_lock);
+    wisdom_count = 0;
+    pthread_mutex_unlock(&wisdom_lock);
+}
+
+/**
+ * snprintf() onto the end of a buffer that may already be full
+ */
+static void append(char* buf, size_t size, int* len, const char* fmt, ...)
+{
+    va_list ap;
+    size_t used = (size_t)*len;
+    int n;
+
+    va_start(ap, fmt);
+    n = vsnprintf(used < size ? buf + used : NULL, used < size ? size - used : 0, fmt, ap);
+    va_end(ap);
+    if (n > 0) {
+        *len += n;
+    }
+}
+
+int iirdsp_wisdom_export(char* buf, size_t size)
+{
+    int len = 0;
+
+    if (buf != NULL && size > 0) {
+        buf[0] = '\0';
+    }
+
+    pthread_mutex_lock(&wisdom_lock);
+    append(buf, size, &len, "iirdsp-wisdom %d %s %d\n", WISDOM_VERSION, PRECISION_NAME, L);
+    for (int i = 0; i < wisdom_count; i++) {
+        const wisdom_entry_t* e = &wisdom[i];
+        append(buf, size, &len, "%d %d %d %s %s %d\n",
+               e->sections, e->channels, e->block_size,
+               e->layout == IIRDSP_LAYOUT_PLANAR ? "planar" : "interleaved",
+               kernel_names[e->kernel], e->tile);
+    }
+    pthread_mutex_unlock(&wisdom_lock);
+
+    return len;
+}
+
+int iirdsp_wisdom_import(const char* text)
+{
+    wisdom_entry_t entries[WISDOM_MAX];
+    int count = 0;
+    int version;
+    int lanes;
+    char precision[16];
+    const char* line = text;
+    int imported = 0;
+
+    if (text == NULL ||
+        sscanf(text, "iirdsp-wisdom %d %15s %d", &version, precision, &lanes) != 3 ||
+        version != WISDOM_VERSION || strcmp(precision, PRECISION_NAME) != 0 || lanes != L) {
+        return -1;
+    }
+
+    /* Parse everything first so a malformed file changes nothing */
+    while ((line = strchr(line, '\n')) != NULL) {
+        char layout[16];
+        char kernel[16];
+        wisdom_entry_t e;
+        int k;
+
+        line++;
+        while (*line == ' ' || *line == '\t' || *line == '\r') {
+            line++;
+        }
+        if (*line == '\0' || *line == '\n') {
+            continue;
+        }
+        if (sscanf(line, "%d %d %d %15s %15s %d", &e.sections, &e.channels,
+                   &e.block_size, layout, kernel, &e.tile) != 6) {
+            return -1;
+        }
+        if (strcmp(layout, "planar") == 0) {
+            e.layout = IIRDSP_LAYOUT_PLANAR;
+        } else if (strcmp(layout, "interleaved") == 0) {
+            e.layout = IIRDSP_LAYOUT_INTERLEAVED;
+        } else {
+            return -1;
+        }
+        for (k = 0; k < IIRDSP_KERNEL_COUNT; k++) {
+            if (strcmp(kernel, kernel_names[k]) == 0) {
+                break;
+            }
+        }
+        if (k == IIRDSP_KERNEL_COUNT || e.sections < 0 || e.channels < 1 || e.block_size < 1) {
+            return -1;
+        }
+        e.kernel = (iirdsp_kernel_t)k;
+        if (count < WISDOM_MAX) {
+            entries[count++] = e;
+        }
+    }
+
+    pthread_mutex_lock(&wisdom_lock);
+    for (int i = 0; i < count; i++) {
+        if (wisdom_store(&entries[i]) == 0) {
+            imported++;
+        }
+    }
+    pthread_mutex_unlock(&wisdom_lock);
+
+    return imported;
+}
+
+int iirdsp_wisdom_export_to_file(const char* path)
+{
+    char* text = NULL;
+    int len = iirdsp_wisdom_export(NULL, 0);
+    FILE* fp;
+    int ok;
+
+    /* Entries may be added between the length query and the export */
+    for (;;) {
+        char* grown = (char*)realloc(text, (size_t)len + 1);
+        int n;
+
+        if (grown == NULL) {
+            free(text);
+            return -1;
+        }
+        text = grown;
+        n = iirdsp_wisdom_export(text, (size_t)len + 1);
+        if (n <= len) {
+            len = n;
+            break;
+        }
+        len = n;
+    }
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        free(text);
+        return -1;
+    }
+    ok = fwrite(text, 1, (size_t)len, fp) == (size_t)len;
+    ok = (fclose(fp) == 0) && ok;
+    free(text);
+
+    return ok ? 0 : -1;
+}
+
+int iirdsp_wisdom_import_from_file(const char* path)
+{
+    FILE* fp = fopen(path, "r");
+    char* text;
+    long size;
+    int result;
+
+    if (fp == NULL) {
+        return -1;
+    }
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return -1;
+    }
+    text = (char*)malloc((size_t)size + 1);
+    if (text == NULL) {
+        fclose(fp);
+        return -1;
+    }
+    size = (long)fread(text, 1, (size_t)size, fp);
+    text[size] = '\0';
+    fclose(fp);
+
+    result = iirdsp_wisdom_import(text);
+    free(text);
+    return result;
+}
+
+/**
+ * Run one contiguous channel through a per-channel kernel
+ */
+static void run_channel(iirdsp_kernel_t kernel, int tile, iirdsp_filter_t* f,
+                        const iirdsp_real* x, iirdsp_real* y, int N)
+{
+    switch (kernel) {
+    case IIRDSP_KERNEL_WAVEFRONT:
+        iirdsp_process_buffer_wavefront(f, x, y, N);
+        break;
+    case IIRDSP_KERNEL_TILED:
+        iirdsp_process_buffer_tiled(f, x, y, N, tile);
+        break;
+    case IIRDSP_KERNEL_STREAM:
+        iirdsp_process_buffer_stream(f, x, y, N);
+        break;
+    default:
+        iirdsp_process_buffer(f, x, y, N);
+        break;
+    }
+}
+
+/**
+ * Filter one block of all channels with the given kernel
+ *
+ * work holds block_size samples for per-channel kernels on interleaved
+ * data, or block_size lane vectors for the lane kernel.
+ */
+static void run_kernel(iirdsp_kernel_t kernel, int tile, iirdsp_filter_t* filters,
+                       int channels, int B, iirdsp_layout_t layout,
+                       iirdsp_real* work, const iirdsp_real* x, iirdsp_real* y)
+{
+    const size_t ch_stride = layout == IIRDSP_LAYOUT_PLANAR ? (size_t)B : 1;
+    const size_t n_stride = layout == IIRDSP_LAYOUT_PLANAR ? 1 : (size_t)channels;
+
+    if (kernel == IIRDSP_KERNEL_LANES) {
+        for (int first = 0; first < channels; first += L) {
+            int count = channels - first < L ? channels - first : L;
+            iirdsp_lanes_t lanes;
+
+            iirdsp_lanes_load(&lanes, &filters[first], 1, count);
+            for (int n = 0; n < B; n++) {
+                for (int lane = 0; lane < L; lane++) {
+                    work[(size_t)n * L + lane] = lane < count
+                        ? x[(first + lane) * ch_stride + n * n_stride] : 0.0;
+                }
+            }
+            iirdsp_lanes_process(&lanes, work, work, B);
+            for (int n = 0; n < B; n++) {
+                for (int lane = 0; lane < count; lane++) {
+                    y[(first + lane) * ch_stride + n * n_stride] = work[(size_t)n * L + lane];
+                }
+            }
+            iirdsp_lanes_store_state(&lanes, &filters[first]);
+        }
+        return;
+    }
+
+    for (int c = 0; c < channels; c++) {
+        if (layout == IIRDSP_LAYOUT_PLANAR || channels == 1) {
+            run_channel(kernel, tile, &filters[c], x + c * ch_stride, y + c * ch_stride, B);
+        } else {
+            for (int n = 0; n < B; n++) {
+                work[n] = x[c + n * n_stride];
+            }
+            run_channel(kernel, tile, &filters[c], work, work, B);
+            for (int n = 0; n < B; n++) {
+                y[c + n * n_stride] = work[n];
+            }
+        }
+    }
+}
+
+/**
+ * Heuristic choice without timing
+ */
+static iirdsp_kernel_t estimate_kernel(int channels, int block_size)
+{
+    if (channels >= 2) {
+        return IIRDSP_KERNEL_LANES;
+    }
+    if (IIRDSP_STREAM_THRESHOLD > 0 && block_size >= IIRDSP_STREAM_THRESHOLD) {
+        return IIRDSP_KERNEL_STREAM;
+    }
+    return IIRDSP_KERNEL_SCALAR;
+}
+
+/**
+ * Time every applicable kernel on copies of the filters
+ *
+ * @return 0 on success, -1 if scratch memory cannot be allocated
+ */
+static int measure_kernel(const iirdsp_plan_t* p, iirdsp_kernel_t* best_kernel, int* best_tile)
+{
+    const size_t total = (size_t)p->channels * p->block_size;
+    iirdsp_filter_t* trial = (iirdsp_filter_t*)malloc((size_t)p->channels * sizeof(iirdsp_filter_t));
+    iirdsp_real* buf = (iirdsp_real*)malloc(total * sizeof(iirdsp_real));
+    double best_time = -1.0;
+    int tile;
+
+    if (trial == NULL || buf == NULL) {
+        free(trial);
+        free(buf);
+        return -1;
+    }
+
+    tile = iirdsp_tile_autotune(&p->filters[0], buf, p->block_size);
+
+    for (int k = 0; k < IIRDSP_KERNEL_COUNT; k++) {
+        iirdsp_kernel_t kernel = (iirdsp_kernel_t)k;
+        int reps = 0;
+        clock_t start;
+        clock_t elapsed;
+        double per_rep;
+
+        if (kernel == IIRDSP_KERNEL_LANES && p->channels < 2) {
+            continue;
+        }
+
+        for (int c = 0; c < p->channels; c++) {
+            trial[c] = p->filters[c];
+            iirdsp_filter_init(&trial[c]);
+        }
+        for (size_t i = 0; i < total; i++) {
+            buf[i] = (i & 1) ? 1.0 : -1.0;
+        }
+
+        /* Repeat until the measurement is well above clock() resolution */
+        start = clock();
+        do {
+            run_kernel(kernel, tile, trial, p->channels, p->block_size, p->layout,
+                       p->work, buf, buf);
+            reps++;
+            elapsed = clock() - start;
+        } while (elapsed < CLOCKS_PER_SEC / 50 && reps < 1000);
+
+        per_rep = (double)elapsed / reps;
+        if (best_time < 0.0 || per_rep < best_time) {
+            best_time = per_rep;
+            *best_kernel = kernel;
+        }
+    }
+
+    *best_tile = tile;
+    free(trial);
+    free(buf);
+    return 0;
+}
+
+iirdsp_plan_t* iirdsp_plan_create(
+    iirdsp_filter_t* filters,
+    int channels,
+    int block_size,
+    unsigned flags
+)
+{
+    iirdsp_plan_t* p;
+    wisdom_entry_t entry;
+    wisdom_entry_t* known;
+    int sections = 0;
+
+    if (filters == NULL || channels < 1 || block_size < 1) {
+        return NULL;
+    }
+
+    p = (iirdsp_plan_t*)malloc(sizeof(*p));
+    if (p == NULL) {
+        return NULL;
+    }
+    p->filters = filters;
+    p->channels = channels;
+    p->block_size = block_size;
+    p->layout = (flags & IIRDSP_PLAN_INTERLEAVED) ? IIRDSP_LAYOUT_INTERLEAVED : IIRDSP_LAYOUT_PLANAR;
+    p->kernel = estimate_kernel(channels, block_size);
+    p->tile = IIRDSP_TILE_DEFAULT;
+    p->work = NULL;
+
+    /* Lane vectors cover the interleaved gather buffer as well */
+    if (channels > 1) {
+        p->work = (iirdsp_real*)malloc((size_t)block_size * L * sizeof(iirdsp_real));
+        if (p->work == NULL) {
+            free(p);
+            return NULL;
+        }
+    }
+
+    for (int c = 0; c < channels; c++) {
+        if (filters[c].num_sections > sections) {
+            sections = filters[c].num_sections;
+        }
+    }
+
+    pthread_mutex_lock(&wisdom_lock);
+    known = wisdom_find(sections, channels, block_size, p->layout);
+    if (known != NULL) {
+        p->kernel = known->kernel;
+        p->tile = known->tile;
+    }
+    pthread_mutex_unlock(&wisdom_lock);
+
+    if (known == NULL) {
+        if (flags & IIRDSP_PLAN_WISDOM_ONLY) {
+            iirdsp_plan_destroy(p);
+            return NULL;
+        }
+        if (flags & IIRDSP_PLAN_MEASURE) {
+            if (measure_kernel(p, &p->kernel, &p->tile) != 0) {
+                iirdsp_plan_destroy(p);
+                return NULL;
+            }
+            entry.sections = sections;
+            entry.channels = channels;
+            entry.block_size = block_size;
+            entry.layout = p->layout;
+            entry.kernel = p->kernel;
+            entry.tile = p->tile;
+            pthread_mutex_lock(&wisdom_lock);
+            (void)wisdom_store(&entry);
+            pthread_mutex_unlock(&wisdom_lock);
+        }
+    }
+
+    /* Wisdom may pick lanes for a single channel */
+    if (p->work == NULL && p->kernel == IIRDSP_KERNEL_LANES) {
+        p->work = (iirdsp_real*)malloc((size_t)block_size * L * sizeof(iirdsp_real));
+        if (p->work == NULL) {
+            iirdsp_plan_destroy(p);
+            return NULL;
+        }
+    }
+
+    return p;
+}
+
+void iirdsp_plan_execute(const iirdsp_plan_t* p, const iirdsp_real* x, iirdsp_real* y)
+{
+    run_kernel(p->kernel, p->tile, p->filters, p->channels, p->block_size, p->layout,
+               p->work, x, y);
+}
+
+void iirdsp_plan_destroy(iirdsp_plan_t* p)
+{
+    if (p != NULL) {
+        free(p->work);
+        free(p);
+    }
+}
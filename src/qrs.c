@@ -0,0 +1,311 @@
+/**
+ * @file qrs.c
+ * @brief Streaming Pan-Tompkins QRS detector implementation
+ *
+ * Pipeline per sample:
+ *   1. Band-pass 5-15 Hz (order-2 Butterworth cascade)
+ *   2. Five-point derivative: d[n] = 2x[n] + x[n-1] - x[n-3] - 2x[n-4]
+ *   3. Squaring
+ *   4. Moving-window integration over 150 ms
+ *   5. Adaptive thresholding of integrated-signal peaks (SPKI / NPKI),
+ *      with a 200 ms refractory period
+ *
+ * Steps 1-4 are fused into one loop; in the bank they run across SIMD
+ * lanes. The R peak is placed at the largest |band-pass| sample of the
+ * integrated-signal peak, shifted back by the band-pass group delay.
+ * Search-back for missed beats is not implemented.
+ */
+
+#include "qrs.h"
+#include "butter.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define L IIRDSP_LANES
+
+/**
+ * Phase of the cascade response at a normalized frequency (cycles/sample)
+ */
+static iirdsp_real cascade_phase(const iirdsp_filter_t* f, iirdsp_real freq)
+{
+    iirdsp_real w = 2.0 * M_PI * freq;
+    iirdsp_real phase = 0.0;
+
+    for (int i = 0; i < f->num_sections; i++) {
+        const iirdsp_biquad_t* s = &f->sections[i];
+        iirdsp_real num_re = s->b0 + s->b1 * cos(w) + s->b2 * cos(2.0 * w);
+        iirdsp_real num_im = -s->b1 * sin(w) - s->b2 * sin(2.0 * w);
+        iirdsp_real den_re = 1.0 + s->a1 * cos(w) + s->a2 * cos(2.0 * w);
+        iirdsp_real den_im = -s->a1 * sin(w) - s->a2 * sin(2.0 * w);
+        phase += atan2(num_im, num_re) - atan2(den_im, den_re);
+    }
+
+    return phase;
+}
+
+/**
+ * Group delay (samples) of the cascade at a normalized frequency
+ */
+static iirdsp_real group_delay(const iirdsp_filter_t* f, iirdsp_real freq)
+{
+    const iirdsp_real df = 1e-4;
+    iirdsp_real dphi = cascade_phase(f, freq + df) - cascade_phase(f, freq - df);
+
+    /* Unwrap a single 2*pi jump across the difference */
+    while (dphi > M_PI) dphi -= 2.0 * M_PI;
+    while (dphi < -M_PI) dphi += 2.0 * M_PI;
+
+    return -dphi / (2.0 * M_PI * 2.0 * df);
+}
+
+/**
+ * Set up the shared front end: band-pass design and integrator length
+ *
+ * @return Integrator length in samples, or -1 if fs_hz is unsupported
+ */
+static int front_end_design(iirdsp_filter_t* bp, iirdsp_real fs_hz)
+{
+    int window = (int)(0.150 * fs_hz + 0.5);
+
+    if (fs_hz <= 40.0 || window < 1 || window > IIRDSP_QRS_MAX_WINDOW) {
+        return -1;
+    }
+    if (butter_bandpass_init(bp, 2, 5.0, 15.0, fs_hz) != 0) {
+        return -1;
+    }
+    return window;
+}
+
+/**
+ * Reset the threshold logic for one channel
+ */
+static void detect_init(iirdsp_qrs_detect_t* d, const iirdsp_filter_t* bp, iirdsp_real fs_hz)
+{
+    d->n = 0;
+    d->learn_until = (long)(2.0 * fs_hz);
+    d->refractory = (long)(0.200 * fs_hz);
+    d->last_qrs = -d->refractory - 1;
+    d->spki = 0.0;
+    d->npki = 0.0;
+    d->threshold = 0.0;
+    d->learn_max = 0.0;
+    d->learn_sum = 0.0;
+    d->peak_val = 0.0;
+    d->peak_n = 0;
+    d->bp_max = 0.0;
+    d->bp_max_n = 0;
+    d->rising = 1;
+    d->delay = (long)(group_delay(bp, 10.0 / fs_hz) + 0.5);
+}
+
+/**
+ * Advance one channel's threshold logic by one sample
+ *
+ * @param d Detector state
+ * @param mwi Integrated-signal sample
+ * @param bp Band-pass output sample
+ * @param r_peak Set to the R-peak index when a QRS is confirmed
+ * @return 1 if a QRS was confirmed at this sample, 0 otherwise
+ */
+static int detect_step(iirdsp_qrs_detect_t* d, iirdsp_real mwi, iirdsp_real bp, long* r_peak)
+{
+    const long n = d->n++;
+    iirdsp_real abs_bp = fabs(bp);
+    int found = 0;
+
+    /* Training: thresholds come from the first seconds of signal. The peak
+     * search below keeps running so a peak straddling the end is whole. */
+    const int training = n < d->learn_until;
+    if (training) {
+        d->learn_max = mwi > d->learn_max ? mwi : d->learn_max;
+        d->learn_sum += mwi;
+        if (n + 1 == d->learn_until) {
+            d->spki = d->learn_max / 3.0;
+            d->npki = d->learn_sum / d->learn_until / 2.0;
+            d->threshold = d->npki + 0.25 * (d->spki - d->npki);
+        }
+    }
+
+    if (d->rising) {
+        if (abs_bp > d->bp_max) {
+            d->bp_max = abs_bp;
+            d->bp_max_n = n;
+        }
+        if (mwi > d->peak_val) {
+            d->peak_val = mwi;
+            d->peak_n = n;
+        } else if (mwi < 0.5 * d->peak_val) {
+            /* Peak complete: classify it */
+            if (training) {
+                /* Thresholds not ready yet */
+            } else if (d->peak_val > d->threshold && d->peak_n - d->last_qrs > d->refractory) {
+                d->spki = 0.125 * d->peak_val + 0.875 * d->spki;
+                d->last_qrs = d->peak_n;
+                *r_peak = d->bp_max_n - d->delay;
+                found = 1;
+            } else {
+                d->npki = 0.125 * d->peak_val + 0.875 * d->npki;
+            }
+            d->threshold = d->npki + 0.25 * (d->spki - d->npki);
+            d->rising = 0;
+            d->peak_val = mwi;
+        }
+    } else if (mwi > d->peak_val) {
+        /* Valley passed: start searching for the next peak */
+        d->rising = 1;
+        d->peak_val = mwi;
+        d->peak_n = n;
+        d->bp_max = abs_bp;
+        d->bp_max_n = n;
+    } else {
+        d->peak_val = mwi;
+    }
+
+    return found;
+}
+
+int iirdsp_qrs_init(iirdsp_qrs_t* q, iirdsp_real fs_hz)
+{
+    int window = front_end_design(&q->bandpass, fs_hz);
+    if (window < 0) {
+        return -1;
+    }
+
+    q->window = window;
+    q->pos = 0;
+    q->sum = 0.0;
+    for (int i = 0; i < 4; i++) {
+        q->hist[i] = 0.0;
+    }
+    for (int i = 0; i < IIRDSP_QRS_MAX_WINDOW; i++) {
+        q->ring[i] = 0.0;
+    }
+    detect_init(&q->det, &q->bandpass, fs_hz);
+    return 0;
+}
+
+int iirdsp_qrs_process(
+    iirdsp_qrs_t* q,
+    const iirdsp_real* x,
+    int N,
+    long* peaks,
+    int max_peaks
+)
+{
+    const iirdsp_real inv_window = 1.0 / q->window;
+    int count = 0;
+
+    for (int n = 0; n < N; n++) {
+        /* Fused front end: band-pass, derivative, square, integrate */
+        iirdsp_real bp = iirdsp_process_sample(&q->bandpass, x[n]);
+        iirdsp_real d = 2.0 * bp + q->hist[0] - q->hist[2] - 2.0 * q->hist[3];
+        iirdsp_real sq = d * d;
+
+        q->hist[3] = q->hist[2];
+        q->hist[2] = q->hist[1];
+        q->hist[1] = q->hist[0];
+        q->hist[0] = bp;
+
+        q->sum += sq - q->ring[q->pos];
+        q->ring[q->pos] = sq;
+        if (++q->pos == q->window) {
+            q->pos = 0;
+        }
+
+        long r_peak;
+        if (detect_step(&q->det, q->sum * inv_window, bp, &r_peak) && count < max_peaks) {
+            peaks[count++] = r_peak;
+        }
+    }
+
+    return count;
+}
+
+int iirdsp_qrs_bank_init(iirdsp_qrs_bank_t* b, int channels, iirdsp_real fs_hz)
+{
+    iirdsp_filter_t bp;
+    int window;
+
+    if (channels <= 0 || channels > L) {
+        return -1;
+    }
+    window = front_end_design(&bp, fs_hz);
+    if (window < 0) {
+        return -1;
+    }
+
+    iirdsp_lanes_load(&b->bandpass, &bp, 0, channels);
+    b->window = window;
+    b->pos = 0;
+    b->channels = channels;
+    for (int lane = 0; lane < L; lane++) {
+        for (int i = 0; i < 4; i++) {
+            b->hist[i][lane] = 0.0;
+        }
+        for (int i = 0; i < IIRDSP_QRS_MAX_WINDOW; i++) {
+            b->ring[i][lane] = 0.0;
+        }
+        b->sum[lane] = 0.0;
+    }
+    for (int c = 0; c < channels; c++) {
+        detect_init(&b->det[c], &bp, fs_hz);
+    }
+    return 0;
+}
+
+int iirdsp_qrs_bank_process(
+    iirdsp_qrs_bank_t* b,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_layout_t layout,
+    iirdsp_qrs_peak_t* peaks,
+    int max_peaks
+)
+{
+    const size_t ch_stride = layout == IIRDSP_LAYOUT_PLANAR ? (size_t)N : 1;
+    const size_t n_stride = layout == IIRDSP_LAYOUT_PLANAR ? 1 : (size_t)b->channels;
+    const iirdsp_real inv_window = 1.0 / b->window;
+    int count = 0;
+
+    for (int n = 0; n < N; n++) {
+        iirdsp_real v[L];
+        iirdsp_real mwi[L];
+
+        for (int lane = 0; lane < L; lane++) {
+            v[lane] = lane < b->channels ? x[lane * ch_stride + n * n_stride] : 0.0;
+        }
+
+        /* Fused front end across lanes */
+        iirdsp_lanes_process(&b->bandpass, v, v, 1);
+        iirdsp_real* slot = b->ring[b->pos];
+        for (int lane = 0; lane < L; lane++) {
+            iirdsp_real d = 2.0 * v[lane] + b->hist[0][lane] - b->hist[2][lane] - 2.0 * b->hist[3][lane];
+            iirdsp_real sq = d * d;
+            b->hist[3][lane] = b->hist[2][lane];
+            b->hist[2][lane] = b->hist[1][lane];
+            b->hist[1][lane] = b->hist[0][lane];
+            b->hist[0][lane] = v[lane];
+            b->sum[lane] += sq - slot[lane];
+            slot[lane] = sq;
+            mwi[lane] = b->sum[lane] * inv_window;
+        }
+        if (++b->pos == b->window) {
+            b->pos = 0;
+        }
+
+        /* Per-channel threshold logic */
+        for (int c = 0; c < b->channels; c++) {
+            long r_peak;
+            if (detect_step(&b->det[c], mwi[c], v[c], &r_peak) && count < max_peaks) {
+                peaks[count].channel = c;
+                peaks[count].index = r_peak;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
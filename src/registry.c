@@ -0,0 +1,466 @@
+/**
+ * @file registry.c
+ * @brief Shared-memory coefficient registry
+ *
+ * Segment layout: one cache line of header, then a power-of-two array of
+ * cache-line aligned entries probed linearly from hash & mask. An entry
+ * moves through three states:
+ *   - hash == 0: empty. An inserter claims it by CAS-ing its hash in.
+ *   - state == WRITING: the claimer records its pid in owner and designs
+ *     the filter into it.
+ *   - state == READY (or FAILED): published with a release store; the
+ *     entry never changes again.
+ * Readers stop at the first empty slot, so lookups need no lock and
+ * never block. Entries are never removed.
+ *
+ * A process that dies while its entry is WRITING would leave inserters of
+ * that spec waiting forever, so waiters check the owner: once kill(owner,
+ * 0) reports ESRCH (or no owner was recorded before the wait timed out),
+ * a waiter takes the entry over with a CAS on owner and designs it itself.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "registry.h"
+#include "butter.h"
+#include "notch.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define REGISTRY_MAGIC 0x3167657270736469ULL  /* "idspreg1" */
+#define REGISTRY_VERSION 2
+#define CACHE_LINE 64
+
+/* sched_yield() rounds to wait for a concurrent design before giving up */
+#define WAIT_LIMIT 1000000
+
+/* Rounds between checks that the owner of a WRITING entry is alive */
+#define OWNER_CHECK 1024
+
+enum { ENTRY_WRITING = 0, ENTRY_READY = 1, ENTRY_FAILED = 2 };
+
+typedef struct {
+    uint64_t magic;          /* Stored last by the creator */
+    uint32_t version;
+    uint32_t real_size;      /* sizeof(iirdsp_real) of the creator */
+    uint32_t max_sections;
+    uint32_t slots;          /* Power of two */
+    int32_t capacity;
+    int32_t claimed;         /* Entries claimed, atomic */
+    int32_t published;       /* Entries READY, atomic */
+} reg_header_t;
+
+typedef struct {
+    uint64_t hash;           /* 0 while empty */
+    uint32_t state;
+    int32_t owner;           /* pid designing it, 0 until recorded, atomic */
+    iirdsp_spec_t spec;
+    iirdsp_filter_t filter;
+} reg_entry_t;
+
+struct iirdsp_registry {
+    reg_header_t* header;
+    char* entries;
+    size_t map_size;
+    size_t stride;
+    uint32_t mask;
+    int writable;
+};
+
+static size_t round_up(size_t n, size_t to)
+{
+    return (n + to - 1) / to * to;
+}
+
+static size_t header_bytes(void)
+{
+    return round_up(sizeof(reg_header_t), CACHE_LINE);
+}
+
+static size_t entry_stride(void)
+{
+    return round_up(sizeof(reg_entry_t), CACHE_LINE);
+}
+
+static reg_entry_t* entry_at(const iirdsp_registry_t* r, uint32_t i)
+{
+    return (reg_entry_t*)(r->entries + (size_t)i * r->stride);
+}
+
+/**
+ * Copy of a spec with fields the design ignores cleared
+ */
+static iirdsp_spec_t normalize(const iirdsp_spec_t* spec)
+{
+    iirdsp_spec_t s = *spec;
+
+    if (s.kind == IIRDSP_SPEC_NOTCH) {
+        s.order = 0;
+    } else if (s.kind != IIRDSP_SPEC_BANDPASS) {
+        s.f2 = 0.0;
+    }
+    /* -0.0 and 0.0 must hash alike */
+    s.f1 += 0.0;
+    s.f2 += 0.0;
+    s.fs += 0.0;
+    return s;
+}
+
+static int same_spec(const iirdsp_spec_t* a, const iirdsp_spec_t* b)
+{
+    return a->kind == b->kind && a->order == b->order && a->f1 == b->f1 && a->f2 == b->f2 && a->fs == b->fs;
+}
+
+static uint64_t mix(uint64_t h, uint64_t v)
+{
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static uint64_t double_bits(double v)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+uint64_t iirdsp_spec_hash(const iirdsp_spec_t* spec)
+{
+    iirdsp_spec_t s = normalize(spec);
+    uint64_t h = 0;
+
+    h = mix(h, (uint64_t)(uint32_t)s.kind);
+    h = mix(h, (uint64_t)(uint32_t)s.order);
+    h = mix(h, double_bits(s.f1));
+    h = mix(h, double_bits(s.f2));
+    h = mix(h, double_bits(s.fs));
+    return h != 0 ? h : 1;
+}
+
+int iirdsp_spec_design(const iirdsp_spec_t* spec, iirdsp_filter_t* f)
+{
+    switch (spec->kind) {
+    case IIRDSP_SPEC_LOWPASS:
+        return butter_lowpass_init(f, spec->order, (iirdsp_real)spec->f1, (iirdsp_real)spec->fs);
+    case IIRDSP_SPEC_HIGHPASS:
+        return butter_highpass_init(f, spec->order, (iirdsp_real)spec->f1, (iirdsp_real)spec->fs);
+    case IIRDSP_SPEC_BANDPASS:
+        return butter_bandpass_init(f, spec->order, (iirdsp_real)spec->f1, (iirdsp_real)spec->f2,
+                                    (iirdsp_real)spec->fs);
+    case IIRDSP_SPEC_NOTCH:
+        return notch_filter_init(f, (iirdsp_real)spec->f1, (iirdsp_real)spec->f2, (iirdsp_real)spec->fs);
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Map a segment and wrap it in a handle
+ */
+static iirdsp_registry_t* map_segment(int fd, size_t size, int writable)
+{
+    iirdsp_registry_t* r = (iirdsp_registry_t*)calloc(1, sizeof(*r));
+    void* mem;
+
+    if (r == NULL) {
+        return NULL;
+    }
+    mem = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        free(r);
+        return NULL;
+    }
+    r->header = (reg_header_t*)mem;
+    r->entries = (char*)mem + header_bytes();
+    r->map_size = size;
+    r->stride = entry_stride();
+    r->writable = writable;
+    return r;
+}
+
+iirdsp_registry_t* iirdsp_registry_create(const char* name, int capacity)
+{
+    iirdsp_registry_t* r;
+    uint32_t slots = 2;
+    size_t size;
+    int fd;
+
+    if (name == NULL || capacity <= 0 || capacity > (1 << 24)) {
+        return NULL;
+    }
+    while (slots < 2u * (uint32_t)capacity) {
+        slots *= 2;
+    }
+    size = header_bytes() + (size_t)slots * entry_stride();
+
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    r = map_segment(fd, size, 1);
+    close(fd);
+    if (r == NULL) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    /* ftruncate() zero-filled the table: every entry is empty */
+    r->header->version = REGISTRY_VERSION;
+    r->header->real_size = (uint32_t)sizeof(iirdsp_real);
+    r->header->max_sections = IIRDSP_MAX_SECTIONS;
+    r->header->slots = slots;
+    r->header->capacity = capacity;
+    r->mask = slots - 1;
+    __atomic_store_n(&r->header->magic, REGISTRY_MAGIC, __ATOMIC_RELEASE);
+    return r;
+}
+
+iirdsp_registry_t* iirdsp_registry_open(const char* name, int writable)
+{
+    iirdsp_registry_t* r;
+    reg_header_t h;
+    struct stat st;
+    int fd;
+
+    if (name == NULL) {
+        return NULL;
+    }
+    fd = shm_open(name, writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < header_bytes()) {
+        close(fd);
+        return NULL;
+    }
+    r = map_segment(fd, (size_t)st.st_size, writable);
+    close(fd);
+    if (r == NULL) {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&r->header->magic, __ATOMIC_ACQUIRE) != REGISTRY_MAGIC) {
+        iirdsp_registry_close(r);
+        return NULL;
+    }
+    h = *r->header;
+    if (h.version != REGISTRY_VERSION || h.real_size != sizeof(iirdsp_real) ||
+        h.max_sections != IIRDSP_MAX_SECTIONS || h.slots == 0 || (h.slots & (h.slots - 1)) != 0 ||
+        header_bytes() + (size_t)h.slots * r->stride > r->map_size) {
+        iirdsp_registry_close(r);
+        return NULL;
+    }
+    r->mask = h.slots - 1;
+    return r;
+}
+
+void iirdsp_registry_close(iirdsp_registry_t* r)
+{
+    if (r == NULL) {
+        return;
+    }
+    munmap(r->header, r->map_size);
+    free(r);
+}
+
+int iirdsp_registry_unlink(const char* name)
+{
+    return shm_unlink(name) == 0 ? 0 : -1;
+}
+
+/**
+ * Probe for a spec
+ *
+ * @param slot Receives the first empty slot reached (UINT32_MAX if none)
+ * @return Entry holding the spec (in any state), or NULL
+ */
+static reg_entry_t* probe(const iirdsp_registry_t* r, const iirdsp_spec_t* spec, uint64_t hash, uint32_t* slot)
+{
+    uint32_t i = (uint32_t)hash & r->mask;
+
+    for (uint32_t n = 0; n <= r->mask; n++, i = (i + 1) & r->mask) {
+        reg_entry_t* e = entry_at(r, i);
+        uint64_t h = __atomic_load_n(&e->hash, __ATOMIC_ACQUIRE);
+
+        if (h == 0) {
+            *slot = i;
+            return NULL;
+        }
+        if (h != hash) {
+            continue;
+        }
+        /* Same hash: the spec is only stable once published */
+        if (__atomic_load_n(&e->state, __ATOMIC_ACQUIRE) == ENTRY_WRITING) {
+            return e;
+        }
+        if (same_spec(&e->spec, spec)) {
+            return e;
+        }
+    }
+    *slot = UINT32_MAX;
+    return NULL;
+}
+
+const iirdsp_filter_t* iirdsp_registry_lookup(const iirdsp_registry_t* r, const iirdsp_spec_t* spec)
+{
+    iirdsp_spec_t s = normalize(spec);
+    uint64_t hash = iirdsp_spec_hash(&s);
+    uint32_t i = (uint32_t)hash & r->mask;
+
+    /* Like probe(), but skip entries still being written */
+    for (uint32_t n = 0; n <= r->mask; n++, i = (i + 1) & r->mask) {
+        const reg_entry_t* e = entry_at(r, i);
+        uint64_t h = __atomic_load_n(&e->hash, __ATOMIC_ACQUIRE);
+
+        if (h == 0) {
+            return NULL;
+        }
+        if (h == hash && __atomic_load_n(&e->state, __ATOMIC_ACQUIRE) == ENTRY_READY &&
+            same_spec(&e->spec, &s)) {
+            return &e->filter;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Design a claimed entry and publish it
+ *
+ * @return Published filter, or NULL if the design fails
+ */
+static const iirdsp_filter_t* publish(iirdsp_registry_t* r, reg_entry_t* e, const iirdsp_spec_t* s)
+{
+    e->spec = *s;
+    if (iirdsp_spec_design(s, &e->filter) != 0) {
+        __atomic_store_n(&e->state, ENTRY_FAILED, __ATOMIC_RELEASE);
+        return NULL;
+    }
+    iirdsp_filter_init(&e->filter);
+    __atomic_store_n(&e->state, ENTRY_READY, __ATOMIC_RELEASE);
+    __atomic_add_fetch(&r->header->published, 1, __ATOMIC_RELAXED);
+    return &e->filter;
+}
+
+/**
+ * Take a WRITING entry over from its owner
+ *
+ * @return 1 if this process now owns the entry
+ */
+static int take_over(reg_entry_t* e, int32_t owner)
+{
+    return __atomic_compare_exchange_n(&e->owner, &owner, (int32_t)getpid(), 0,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Wait for a concurrent insert to finish
+ *
+ * @param e Entry another process is writing
+ * @param reclaimed Set to 1 if its owner died and this process took the
+ *                  entry over; the caller must then publish it
+ * @return Final state, or ENTRY_WRITING if it did not finish in time or
+ *         was reclaimed
+ */
+static uint32_t wait_published(reg_entry_t* e, int* reclaimed)
+{
+    uint32_t state = __atomic_load_n(&e->state, __ATOMIC_ACQUIRE);
+    int32_t owner = 0;
+
+    *reclaimed = 0;
+    for (int n = 0; state == ENTRY_WRITING && n < WAIT_LIMIT; n++) {
+        if (n % OWNER_CHECK == 0) {
+            owner = __atomic_load_n(&e->owner, __ATOMIC_ACQUIRE);
+            if (owner != 0 && kill(owner, 0) != 0 && errno == ESRCH) {
+                /* A dead owner cannot publish any more, so the state is final */
+                state = __atomic_load_n(&e->state, __ATOMIC_ACQUIRE);
+                if (state != ENTRY_WRITING || take_over(e, owner)) {
+                    *reclaimed = state == ENTRY_WRITING;
+                    return state;
+                }
+                /* Another waiter took it over: wait for that one instead */
+            }
+        }
+        sched_yield();
+        state = __atomic_load_n(&e->state, __ATOMIC_ACQUIRE);
+    }
+    if (state == ENTRY_WRITING && owner == 0) {
+        /* The claimer never got as far as recording itself */
+        *reclaimed = take_over(e, 0);
+    }
+    return state;
+}
+
+const iirdsp_filter_t* iirdsp_registry_get(iirdsp_registry_t* r, const iirdsp_spec_t* spec)
+{
+    iirdsp_spec_t s = normalize(spec);
+    uint64_t hash = iirdsp_spec_hash(&s);
+    const iirdsp_filter_t* found = iirdsp_registry_lookup(r, &s);
+
+    if (found != NULL || !r->writable) {
+        return found;
+    }
+
+    for (;;) {
+        uint32_t slot = UINT32_MAX;
+        reg_entry_t* e = probe(r, &s, hash, &slot);
+        uint64_t expected = 0;
+
+        if (e != NULL) {
+            int reclaimed;
+            uint32_t state = wait_published(e, &reclaimed);
+
+            if (reclaimed) {
+                /* Same hash, so the entry can hold this spec instead */
+                return publish(r, e, &s);
+            }
+            if (state == ENTRY_WRITING) {
+                return NULL;
+            }
+            if (same_spec(&e->spec, &s)) {
+                return state == ENTRY_READY ? &e->filter : NULL;
+            }
+            continue;  /* Hash collision with another spec: probe again */
+        }
+        if (slot == UINT32_MAX) {
+            return NULL;
+        }
+
+        e = entry_at(r, slot);
+        if (!__atomic_compare_exchange_n(&e->hash, &expected, hash, 0,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            continue;  /* Another process took the slot first */
+        }
+        if (!take_over(e, 0)) {
+            continue;  /* Reclaimed already: wait for it like any other writer */
+        }
+        if (__atomic_add_fetch(&r->header->claimed, 1, __ATOMIC_RELAXED) > r->header->capacity) {
+            /* Keep the slot (probe chains must stay intact) but mark it unusable */
+            e->spec = s;
+            __atomic_store_n(&e->state, ENTRY_FAILED, __ATOMIC_RELEASE);
+            return NULL;
+        }
+        return publish(r, e, &s);
+    }
+}
+
+int iirdsp_registry_count(const iirdsp_registry_t* r)
+{
+    return __atomic_load_n(&r->header->published, __ATOMIC_RELAXED);
+}
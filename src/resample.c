@@ -0,0 +1,143 @@
+/**
+ * @file resample.c
+ * @brief Rational sample-rate conversion implementation
+ *
+ * Per input sample x[n], for each of the L intermediate samples
+ * (x[n] * L followed by L - 1 zeros):
+ *   1. Run the anti-alias cascade; for the inserted zeros the first
+ *      section reduces to its feedback terms
+ *   2. On every M-th intermediate sample, pass the result through the
+ *      post cascade and write it out
+ */
+
+#include "resample.h"
+#include "butter.h"
+
+static int gcd(int a, int b)
+{
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int iirdsp_resampler_init(
+    iirdsp_resampler_t* r,
+    int fs_in_hz,
+    int fs_out_hz,
+    int order,
+    iirdsp_real cutoff_hz,
+    const iirdsp_filter_t* post
+)
+{
+    int g;
+
+    if (fs_in_hz <= 0 || fs_out_hz <= 0 || order < 0) {
+        return -1;
+    }
+
+    g = gcd(fs_in_hz, fs_out_hz);
+    r->up = fs_out_hz / g;
+    r->down = fs_in_hz / g;
+    r->skip = 0;
+
+    if (order == 0) {
+        if (r->up != 1 || r->down != 1) {
+            return -1;
+        }
+        r->aa.num_sections = 0;
+    } else {
+        iirdsp_real low = fs_in_hz < fs_out_hz ? (iirdsp_real)fs_in_hz : (iirdsp_real)fs_out_hz;
+
+        if (cutoff_hz <= 0.0) {
+            cutoff_hz = 0.4 * low;
+        }
+        if (cutoff_hz >= 0.5 * low) {
+            return -1;
+        }
+        if (butter_lowpass_init(&r->aa, order, cutoff_hz,
+                                (iirdsp_real)fs_in_hz * r->up) != 0) {
+            return -2;
+        }
+    }
+
+    if (post != NULL) {
+        r->post = *post;
+        r->has_post = 1;
+    } else {
+        r->post.num_sections = 0;
+        r->has_post = 0;
+    }
+    return 0;
+}
+
+void iirdsp_resampler_reset(iirdsp_resampler_t* r)
+{
+    iirdsp_filter_reset(&r->aa);
+    iirdsp_filter_reset(&r->post);
+    r->skip = 0;
+}
+
+int iirdsp_resampler_max_output(const iirdsp_resampler_t* r, int N)
+{
+    long total = (long)N * r->up;
+
+    return (int)((total + r->down - 1) / r->down);
+}
+
+/**
+ * Run the anti-alias cascade on an inserted zero
+ *
+ * The first section sees input 0, so only its state and feedback terms
+ * contribute; later sections see a non-zero signal.
+ */
+static inline iirdsp_real cascade_zero(iirdsp_filter_t* f)
+{
+    iirdsp_biquad_t* s = &f->sections[0];
+    iirdsp_real y = s->z1;
+
+    s->z1 = s->z2 - s->a1 * y;
+    s->z2 = -s->a2 * y;
+    for (int i = 1; i < f->num_sections; i++) {
+        y = iirdsp_biquad_process(&f->sections[i], y);
+    }
+    return y;
+}
+
+int iirdsp_resampler_process(
+    iirdsp_resampler_t* r,
+    const iirdsp_real* x,
+    int N,
+    iirdsp_real* y
+)
+{
+    const iirdsp_real gain = (iirdsp_real)r->up;
+    int skip = r->skip;
+    int count = 0;
+
+    for (int n = 0; n < N; n++) {
+        for (int j = 0; j < r->up; j++) {
+            iirdsp_real v;
+
+            if (j == 0) {
+                v = iirdsp_process_sample(&r->aa, x[n] * gain);
+            } else {
+                v = cascade_zero(&r->aa);
+            }
+
+            if (skip == 0) {
+                if (r->has_post) {
+                    v = iirdsp_process_sample(&r->post, v);
+                }
+                y[count++] = v;
+                skip = r->down;
+            }
+            skip--;
+        }
+    }
+
+    r->skip = skip;
+    return count;
+}
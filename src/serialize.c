@@ -0,0 +1,339 @@
+/**
+ * @file serialize.c
+ * @brief Binary filter snapshots
+ *
+ * Values go through their IEEE-754 bit patterns and are written byte by
+ * byte, least significant first, so the format does not depend on the
+ * host byte order.
+ */
+
+#include "serialize.h"
+#include <stdint.h>
+#include <string.h>
+
+#define FLAG_FLOAT32 0x4
+#define SINGLE_HEADER 8
+#define BANK_HEADER 12
+
+#ifdef IIRDSP_USE_FLOAT
+#define NATIVE_FLAGS FLAG_FLOAT32
+#define NATIVE_BYTES 4
+#else
+#define NATIVE_FLAGS 0
+#define NATIVE_BYTES 8
+#endif
+
+static const unsigned char single_magic[4] = { 'I', 'I', 'R', 'S' };
+static const unsigned char bank_magic[4] = { 'I', 'I', 'R', 'B' };
+
+static int valid_parts(int what)
+{
+    return what > 0 && (what & ~IIRDSP_SERIAL_ALL) == 0;
+}
+
+static int valid_sections(int n)
+{
+    return n > 0 && n <= IIRDSP_MAX_SECTIONS;
+}
+
+/**
+ * Bytes per section for the given parts and value width
+ */
+static long section_bytes(int what, int value_bytes)
+{
+    int values = ((what & IIRDSP_SERIAL_COEFFS) ? 5 : 0) + ((what & IIRDSP_SERIAL_STATE) ? 2 : 0);
+    return (long)values * value_bytes;
+}
+
+static unsigned char* put_real(unsigned char* p, iirdsp_real v)
+{
+#ifdef IIRDSP_USE_FLOAT
+    uint32_t bits;
+#else
+    uint64_t bits;
+#endif
+
+    memcpy(&bits, &v, sizeof(bits));
+    for (int i = 0; i < NATIVE_BYTES; i++) {
+        *p++ = (unsigned char)(bits >> (8 * i));
+    }
+    return p;
+}
+
+static const unsigned char* get_real(const unsigned char* p, int float32, iirdsp_real* v)
+{
+    if (float32) {
+        uint32_t bits = 0;
+        float x;
+
+        for (int i = 0; i < 4; i++) {
+            bits |= (uint32_t)p[i] << (8 * i);
+        }
+        memcpy(&x, &bits, sizeof(x));
+        *v = (iirdsp_real)x;
+        return p + 4;
+    } else {
+        uint64_t bits = 0;
+        double x;
+
+        for (int i = 0; i < 8; i++) {
+            bits |= (uint64_t)p[i] << (8 * i);
+        }
+        memcpy(&x, &bits, sizeof(x));
+        *v = (iirdsp_real)x;
+        return p + 8;
+    }
+}
+
+static unsigned char* put_sections(unsigned char* p, const iirdsp_filter_t* f, int what)
+{
+    for (int i = 0; i < f->num_sections; i++) {
+        const iirdsp_biquad_t* s = &f->sections[i];
+
+        if (what & IIRDSP_SERIAL_COEFFS) {
+            p = put_real(p, s->b0);
+            p = put_real(p, s->b1);
+            p = put_real(p, s->b2);
+            p = put_real(p, s->a1);
+            p = put_real(p, s->a2);
+        }
+        if (what & IIRDSP_SERIAL_STATE) {
+            p = put_real(p, s->z1);
+            p = put_real(p, s->z2);
+        }
+    }
+    return p;
+}
+
+/**
+ * Check one record's sections against its target and the bytes left
+ *
+ * @return Record payload size, or a negative iirdsp_deserialize() code
+ */
+static long check_record(const iirdsp_filter_t* f, int what, int num_sections, int float32, size_t avail)
+{
+    long bytes;
+
+    if (!valid_sections(num_sections)) {
+        return -1;
+    }
+    bytes = section_bytes(what, float32 ? 4 : 8) * num_sections;
+    if ((size_t)bytes > avail) {
+        return -2;
+    }
+    if (!(what & IIRDSP_SERIAL_COEFFS) && f->num_sections != num_sections) {
+        return -3;
+    }
+    return bytes;
+}
+
+static const unsigned char* get_sections(
+    const unsigned char* p,
+    iirdsp_filter_t* f,
+    int what,
+    int num_sections,
+    int float32
+)
+{
+    if (what & IIRDSP_SERIAL_COEFFS) {
+        f->num_sections = num_sections;
+    }
+    for (int i = 0; i < num_sections; i++) {
+        iirdsp_biquad_t* s = &f->sections[i];
+
+        if (what & IIRDSP_SERIAL_COEFFS) {
+            p = get_real(p, float32, &s->b0);
+            p = get_real(p, float32, &s->b1);
+            p = get_real(p, float32, &s->b2);
+            p = get_real(p, float32, &s->a1);
+            p = get_real(p, float32, &s->a2);
+        }
+        if (what & IIRDSP_SERIAL_STATE) {
+            p = get_real(p, float32, &s->z1);
+            p = get_real(p, float32, &s->z2);
+        } else {
+            s->z1 = 0.0;
+            s->z2 = 0.0;
+        }
+    }
+    return p;
+}
+
+/**
+ * Parse flags shared by both headers
+ *
+ * @return Parts present, or -1 if the flags are not understood
+ */
+static int parse_flags(unsigned char version, unsigned char flags, int* float32)
+{
+    int what = flags & IIRDSP_SERIAL_ALL;
+
+    if (version != IIRDSP_SERIAL_VERSION || (flags & ~(IIRDSP_SERIAL_ALL | FLAG_FLOAT32)) != 0 ||
+        !valid_parts(what)) {
+        return -1;
+    }
+    *float32 = (flags & FLAG_FLOAT32) != 0;
+    return what;
+}
+
+long iirdsp_serialized_size(const iirdsp_filter_t* f, int what)
+{
+    return SINGLE_HEADER + section_bytes(what, NATIVE_BYTES) * f->num_sections;
+}
+
+long iirdsp_serialize(const iirdsp_filter_t* f, int what, unsigned char* buf, size_t size)
+{
+    long bytes;
+    unsigned char* p = buf;
+
+    if (f == NULL || buf == NULL || !valid_parts(what) || !valid_sections(f->num_sections)) {
+        return -1;
+    }
+    bytes = iirdsp_serialized_size(f, what);
+    if ((size_t)bytes > size) {
+        return -2;
+    }
+
+    memcpy(p, single_magic, 4);
+    p[4] = IIRDSP_SERIAL_VERSION;
+    p[5] = (unsigned char)(what | NATIVE_FLAGS);
+    p[6] = (unsigned char)f->num_sections;
+    p[7] = 0;
+    put_sections(p + SINGLE_HEADER, f, what);
+    return bytes;
+}
+
+long iirdsp_deserialize(iirdsp_filter_t* f, const unsigned char* buf, size_t size)
+{
+    int float32;
+    int what;
+    long bytes;
+
+    if (f == NULL || buf == NULL) {
+        return -1;
+    }
+    if (size < SINGLE_HEADER) {
+        return size >= 4 && memcmp(buf, single_magic, 4) != 0 ? -1 : -2;
+    }
+    if (memcmp(buf, single_magic, 4) != 0) {
+        return -1;
+    }
+    what = parse_flags(buf[4], buf[5], &float32);
+    if (what < 0) {
+        return -1;
+    }
+
+    bytes = check_record(f, what, buf[6], float32, size - SINGLE_HEADER);
+    if (bytes < 0) {
+        return bytes;
+    }
+    get_sections(buf + SINGLE_HEADER, f, what, buf[6], float32);
+    return SINGLE_HEADER + bytes;
+}
+
+long iirdsp_bank_serialized_size(const iirdsp_filter_t* filters, int count, int what)
+{
+    long bytes = BANK_HEADER;
+
+    for (int k = 0; k < count; k++) {
+        bytes += 1 + section_bytes(what, NATIVE_BYTES) * filters[k].num_sections;
+    }
+    return bytes;
+}
+
+long iirdsp_serialize_bank(
+    const iirdsp_filter_t* filters,
+    int count,
+    int what,
+    unsigned char* buf,
+    size_t size
+)
+{
+    long bytes;
+    unsigned char* p = buf;
+
+    if ((filters == NULL && count > 0) || count < 0 || buf == NULL || !valid_parts(what)) {
+        return -1;
+    }
+    for (int k = 0; k < count; k++) {
+        if (!valid_sections(filters[k].num_sections)) {
+            return -1;
+        }
+    }
+    bytes = iirdsp_bank_serialized_size(filters, count, what);
+    if ((size_t)bytes > size) {
+        return -2;
+    }
+
+    memcpy(p, bank_magic, 4);
+    p[4] = IIRDSP_SERIAL_VERSION;
+    p[5] = (unsigned char)(what | NATIVE_FLAGS);
+    p[6] = 0;
+    p[7] = 0;
+    for (int i = 0; i < 4; i++) {
+        p[8 + i] = (unsigned char)((uint32_t)count >> (8 * i));
+    }
+    p += BANK_HEADER;
+    for (int k = 0; k < count; k++) {
+        *p++ = (unsigned char)filters[k].num_sections;
+        p = put_sections(p, &filters[k], what);
+    }
+    return bytes;
+}
+
+long iirdsp_deserialize_bank(
+    iirdsp_filter_t* filters,
+    int max_count,
+    const unsigned char* buf,
+    size_t size,
+    int* count
+)
+{
+    const unsigned char* p;
+    size_t offset = BANK_HEADER;
+    uint32_t n = 0;
+    int float32;
+    int what;
+
+    if (buf == NULL || count == NULL || max_count < 0 || (filters == NULL && max_count > 0)) {
+        return -1;
+    }
+    if (size < BANK_HEADER) {
+        return size >= 4 && memcmp(buf, bank_magic, 4) != 0 ? -1 : -2;
+    }
+    if (memcmp(buf, bank_magic, 4) != 0) {
+        return -1;
+    }
+    what = parse_flags(buf[4], buf[5], &float32);
+    if (what < 0) {
+        return -1;
+    }
+    for (int i = 0; i < 4; i++) {
+        n |= (uint32_t)buf[8 + i] << (8 * i);
+    }
+    if (n > (uint32_t)max_count) {
+        return -3;
+    }
+
+    /* Validate every record before touching any filter */
+    for (uint32_t k = 0; k < n; k++) {
+        long bytes;
+
+        if (offset >= size) {
+            return -2;
+        }
+        bytes = check_record(&filters[k], what, buf[offset], float32, size - offset - 1);
+        if (bytes < 0) {
+            return bytes;
+        }
+        offset += 1 + (size_t)bytes;
+    }
+
+    p = buf + BANK_HEADER;
+    for (uint32_t k = 0; k < n; k++) {
+        int num_sections = *p++;
+        p = get_sections(p, &filters[k], what, num_sections, float32);
+    }
+    *count = (int)n;
+    return (long)offset;
+}
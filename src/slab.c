@@ -0,0 +1,404 @@
+/**
+ * @file slab.c
+ * @brief Fixed-size slab allocator implementation
+ *
+ * Memory comes in pages aligned to their size: IIRDSP_SLAB_PAGE_BYTES, or
+ * the next power of two holding MIN_PER_PAGE objects for large objects.
+ * Each page starts with a header (owning slab, live bitmap) followed by
+ * cache-line padded objects. Free objects form a singly linked list
+ * through their first word:
+ *   - each thread has a magazine (a small array) it allocates from and
+ *     frees to without locking;
+ *   - an empty magazine takes IIRDSP_SLAB_MAGAZINE objects from the
+ *     shared depot under the slab mutex, and a full one gives the same
+ *     number back.
+ * The live bitmap is updated atomically on alloc and free so
+ * iirdsp_slab_foreach() can walk live objects in address order.
+ *
+ * All slabs share one thread-specific key, whose value is the thread's
+ * list of magazines (one per slab it has used, most recent first), so the
+ * number of slabs is not limited by PTHREAD_KEYS_MAX. Magazines are
+ * matched by the slab's serial number. Destroying a slab zeroes the
+ * serial of its magazines instead of freeing them; the owning thread
+ * frees them the next time it walks its list, or when it exits.
+ */
+
+#include "slab.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Objects per page are capped so a default page of single-line objects fills the bitmap */
+#define MAX_PER_PAGE (IIRDSP_SLAB_PAGE_BYTES / IIRDSP_CACHE_LINE)
+#define MIN_PER_PAGE 8
+#define BITMAP_WORDS (IIRDSP_SLAB_PAGE_BYTES / IIRDSP_CACHE_LINE / 64)
+
+typedef struct {
+    iirdsp_slab_t* slab;
+    uint64_t live[BITMAP_WORDS];
+} slab_page_t;
+
+/**
+ * Per-thread object cache
+ */
+typedef struct magazine {
+    iirdsp_slab_t* slab;
+    uint64_t serial;         /* The slab's serial; 0 once it is destroyed */
+    struct magazine* prev;   /* Registration list, for slab destroy */
+    struct magazine* next;
+    struct magazine* thread_next;  /* Owning thread's list */
+    int count;
+    void* objs[2 * IIRDSP_SLAB_MAGAZINE];
+} magazine_t;
+
+struct iirdsp_slab {
+    size_t object_size;      /* Padded to the cache line */
+    size_t header_size;      /* Page header, padded to the cache line */
+    size_t page_size;        /* Power of two, pages aligned to it */
+    int per_page;
+
+    pthread_mutex_t lock;    /* Guards everything below */
+    void* depot;             /* Free list */
+    slab_page_t** pages;     /* In creation order */
+    int num_pages;
+    int page_capacity;
+    magazine_t* magazines;
+
+    uint64_t serial;         /* Unique per slab, never 0 */
+    long live;               /* Updated atomically */
+};
+
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_key;     /* Head of this thread's magazine list */
+static int key_status = -1;          /* 0 once thread_key exists */
+static uint64_t last_serial = 0;
+
+/* Held while a slab orphans its magazines and while an exiting thread
+   releases its own, so neither sees the other's slab half gone */
+static pthread_mutex_t orphan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t round_up(size_t n, size_t to)
+{
+    return (n + to - 1) / to * to;
+}
+
+static slab_page_t* page_of(const iirdsp_slab_t* s, const void* obj)
+{
+    return (slab_page_t*)((uintptr_t)obj & ~(uintptr_t)(s->page_size - 1));
+}
+
+static void set_live(iirdsp_slab_t* s, void* obj, int live)
+{
+    slab_page_t* page = page_of(s, obj);
+    size_t index = ((char*)obj - (char*)page - s->header_size) / s->object_size;
+    uint64_t bit = (uint64_t)1 << (index % 64);
+
+    if (live) {
+        __atomic_fetch_or(&page->live[index / 64], bit, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s->live, 1, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_and(&page->live[index / 64], ~bit, __ATOMIC_RELAXED);
+        __atomic_fetch_sub(&s->live, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Add a page and push its objects onto the depot; caller holds the lock
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+static int add_page(iirdsp_slab_t* s)
+{
+    void* mem = NULL;
+    slab_page_t* page;
+    char* base;
+
+    if (s->num_pages == s->page_capacity) {
+        int cap = s->page_capacity > 0 ? 2 * s->page_capacity : 16;
+        slab_page_t** grown = (slab_page_t**)realloc(s->pages, (size_t)cap * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        s->pages = grown;
+        s->page_capacity = cap;
+    }
+    if (posix_memalign(&mem, s->page_size, s->page_size) != 0) {
+        return -1;
+    }
+    page = (slab_page_t*)mem;
+    page->slab = s;
+    memset(page->live, 0, sizeof(page->live));
+    s->pages[s->num_pages++] = page;
+
+    /* Push in reverse so allocation proceeds in address order */
+    base = (char*)page + s->header_size;
+    for (int i = s->per_page - 1; i >= 0; i--) {
+        void* obj = base + (size_t)i * s->object_size;
+        *(void**)obj = s->depot;
+        s->depot = obj;
+    }
+    return 0;
+}
+
+/**
+ * Return a magazine's objects to its slab's depot and free it
+ */
+static void magazine_release(magazine_t* mag)
+{
+    iirdsp_slab_t* s = mag->slab;
+
+    pthread_mutex_lock(&s->lock);
+    for (int i = 0; i < mag->count; i++) {
+        *(void**)mag->objs[i] = s->depot;
+        s->depot = mag->objs[i];
+    }
+    if (mag->prev != NULL) {
+        mag->prev->next = mag->next;
+    } else {
+        s->magazines = mag->next;
+    }
+    if (mag->next != NULL) {
+        mag->next->prev = mag->prev;
+    }
+    pthread_mutex_unlock(&s->lock);
+    free(mag);
+}
+
+/**
+ * Release an exiting thread's magazines
+ */
+static void thread_release(void* arg)
+{
+    magazine_t* mag = (magazine_t*)arg;
+
+    pthread_mutex_lock(&orphan_lock);
+    while (mag != NULL) {
+        magazine_t* next = mag->thread_next;
+
+        if (__atomic_load_n(&mag->serial, __ATOMIC_ACQUIRE) != 0) {
+            magazine_release(mag);
+        } else {
+            free(mag);
+        }
+        mag = next;
+    }
+    pthread_mutex_unlock(&orphan_lock);
+}
+
+static void create_key(void)
+{
+    key_status = pthread_key_create(&thread_key, thread_release) == 0 ? 0 : -1;
+}
+
+static magazine_t* get_magazine(iirdsp_slab_t* s)
+{
+    magazine_t* head = (magazine_t*)pthread_getspecific(thread_key);
+    magazine_t* prev = NULL;
+    magazine_t* mag = head;
+
+    while (mag != NULL) {
+        uint64_t serial = __atomic_load_n(&mag->serial, __ATOMIC_ACQUIRE);
+        magazine_t* next = mag->thread_next;
+
+        if (serial == s->serial) {
+            /* Move to the front so the slab in use is found first */
+            if (prev != NULL) {
+                prev->thread_next = next;
+                mag->thread_next = head;
+                pthread_setspecific(thread_key, mag);
+            }
+            return mag;
+        }
+        if (serial == 0) {
+            /* Orphaned by iirdsp_slab_destroy() */
+            if (prev != NULL) {
+                prev->thread_next = next;
+            } else {
+                head = next;
+                pthread_setspecific(thread_key, head);
+            }
+            free(mag);
+        } else {
+            prev = mag;
+        }
+        mag = next;
+    }
+
+    mag = (magazine_t*)calloc(1, sizeof(*mag));
+    if (mag == NULL) {
+        return NULL;
+    }
+    mag->slab = s;
+    mag->serial = s->serial;
+    pthread_mutex_lock(&s->lock);
+    mag->next = s->magazines;
+    if (s->magazines != NULL) {
+        s->magazines->prev = mag;
+    }
+    s->magazines = mag;
+    pthread_mutex_unlock(&s->lock);
+    mag->thread_next = head;
+    if (pthread_setspecific(thread_key, mag) != 0) {
+        magazine_release(mag);
+        return NULL;
+    }
+    return mag;
+}
+
+iirdsp_slab_t* iirdsp_slab_create(size_t object_size)
+{
+    iirdsp_slab_t* s;
+    size_t header = round_up(sizeof(slab_page_t), IIRDSP_CACHE_LINE);
+    size_t page = IIRDSP_SLAB_PAGE_BYTES;
+    size_t per_page;
+
+    if (object_size == 0 || object_size > ((size_t)1 << 30)) {
+        return NULL;
+    }
+    object_size = round_up(object_size, IIRDSP_CACHE_LINE);
+    while ((page - header) / object_size < MIN_PER_PAGE) {
+        page *= 2;
+    }
+    per_page = (page - header) / object_size;
+    if (per_page > MAX_PER_PAGE) {
+        per_page = MAX_PER_PAGE;
+    }
+
+    pthread_once(&key_once, create_key);
+    if (key_status != 0) {
+        return NULL;
+    }
+    s = (iirdsp_slab_t*)calloc(1, sizeof(*s));
+    if (s == NULL) {
+        return NULL;
+    }
+    s->serial = __atomic_add_fetch(&last_serial, 1, __ATOMIC_RELAXED);
+    pthread_mutex_init(&s->lock, NULL);
+    s->object_size = object_size;
+    s->header_size = header;
+    s->page_size = page;
+    s->per_page = (int)per_page;
+    return s;
+}
+
+void iirdsp_slab_destroy(iirdsp_slab_t* s)
+{
+    if (s == NULL) {
+        return;
+    }
+
+    /* Magazines belong to their threads' lists; orphan them for the
+       owners to free. The object pointers in them die with the pages. */
+    pthread_mutex_lock(&orphan_lock);
+    while (s->magazines != NULL) {
+        magazine_t* next = s->magazines->next;
+        __atomic_store_n(&s->magazines->serial, 0, __ATOMIC_RELEASE);
+        s->magazines = next;
+    }
+    pthread_mutex_unlock(&orphan_lock);
+    for (int i = 0; i < s->num_pages; i++) {
+        free(s->pages[i]);
+    }
+    free(s->pages);
+    pthread_mutex_destroy(&s->lock);
+    free(s);
+}
+
+void* iirdsp_slab_alloc(iirdsp_slab_t* s)
+{
+    magazine_t* mag = get_magazine(s);
+    void* obj;
+
+    if (mag == NULL) {
+        return NULL;
+    }
+
+    if (mag->count == 0) {
+        pthread_mutex_lock(&s->lock);
+        while (mag->count < IIRDSP_SLAB_MAGAZINE) {
+            if (s->depot == NULL && add_page(s) != 0) {
+                break;
+            }
+            mag->objs[mag->count++] = s->depot;
+            s->depot = *(void**)s->depot;
+        }
+        pthread_mutex_unlock(&s->lock);
+        if (mag->count == 0) {
+            return NULL;
+        }
+        /* Hand out in address order */
+        for (int i = 0, j = mag->count - 1; i < j; i++, j--) {
+            void* t = mag->objs[i];
+            mag->objs[i] = mag->objs[j];
+            mag->objs[j] = t;
+        }
+    }
+
+    obj = mag->objs[--mag->count];
+    set_live(s, obj, 1);
+    return obj;
+}
+
+void iirdsp_slab_free(iirdsp_slab_t* s, void* obj)
+{
+    magazine_t* mag;
+
+    if (obj == NULL) {
+        return;
+    }
+    set_live(s, obj, 0);
+
+    mag = get_magazine(s);
+    if (mag == NULL) {
+        /* No magazine for this thread: go straight to the depot */
+        pthread_mutex_lock(&s->lock);
+        *(void**)obj = s->depot;
+        s->depot = obj;
+        pthread_mutex_unlock(&s->lock);
+        return;
+    }
+
+    if (mag->count == 2 * IIRDSP_SLAB_MAGAZINE) {
+        pthread_mutex_lock(&s->lock);
+        for (int i = 0; i < IIRDSP_SLAB_MAGAZINE; i++) {
+            void* o = mag->objs[--mag->count];
+            *(void**)o = s->depot;
+            s->depot = o;
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+    mag->objs[mag->count++] = obj;
+}
+
+long iirdsp_slab_foreach(iirdsp_slab_t* s, iirdsp_slab_visit_fn visit, void* user)
+{
+    long visited = 0;
+
+    for (int i = 0; i < s->num_pages; i++) {
+        const slab_page_t* page = s->pages[i];
+        char* base = (char*)page + s->header_size;
+
+        for (int w = 0; w < BITMAP_WORDS; w++) {
+            uint64_t bits = page->live[w];
+
+            while (bits != 0) {
+                int b = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                visit(user, base + (size_t)(w * 64 + b) * s->object_size);
+                visited++;
+            }
+        }
+    }
+    return visited;
+}
+
+long iirdsp_slab_live(const iirdsp_slab_t* s)
+{
+    return __atomic_load_n(&s->live, __ATOMIC_RELAXED);
+}
+
+size_t iirdsp_slab_object_size(const iirdsp_slab_t* s)
+{
+    return s->object_size;
+}
@@ -7,6 +7,96 @@
 #include <string.h>
 #include <math.h>
 #include <stdlib.h>
+#include <time.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IIRDSP_HAVE_STREAM 1
+#endif
+
+/* Bytes per streaming store; outputs are grouped into this many bytes */
+#define STREAM_BYTES 16
+#define STREAM_LANES ((int)(STREAM_BYTES / sizeof(iirdsp_real)))
+
+/* Samples per 64-byte cache line, used to issue one prefetch per line */
+#define LINE_SAMPLES ((int)(64 / sizeof(iirdsp_real)))
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IIRDSP_PREFETCH(p) __builtin_prefetch((p), 0, 0)
+#else
+#define IIRDSP_PREFETCH(p) ((void)(p))
+#endif
+
+/**
+ * Store STREAM_LANES outputs to a 16-byte aligned address, bypassing cache
+ */
+static inline void stream_store(iirdsp_real* dst, const iirdsp_real* v)
+{
+#if defined(IIRDSP_HAVE_STREAM) && defined(IIRDSP_USE_FLOAT)
+    _mm_stream_ps(dst, _mm_loadu_ps(v));
+#elif defined(IIRDSP_HAVE_STREAM)
+    _mm_stream_pd(dst, _mm_loadu_pd(v));
+#else
+    for (int i = 0; i < STREAM_LANES; i++) {
+        dst[i] = v[i];
+    }
+#endif
+}
+
+/**
+ * Order streaming stores before any later ordinary stores
+ */
+static inline void stream_fence(void)
+{
+#if defined(IIRDSP_HAVE_STREAM)
+    _mm_sfence();
+#endif
+}
+
+/**
+ * Filter x[N-1] .. x[0] into y[N-1] .. y[0]
+ *
+ * Used by the filtfilt backward pass so neither buffer has to be reversed.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), must not alias x
+ * @param N Number of samples
+ * @param stream Nonzero to use prefetch and non-temporal stores
+ */
+static void process_buffer_reverse(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    int stream
+)
+{
+    int n = N - 1;
+
+    if (stream && ((uintptr_t)y % sizeof(iirdsp_real)) == 0) {
+        iirdsp_real v[STREAM_LANES];
+
+        /* Scalar until y + n + 1 is aligned, so groups end on a boundary */
+        for (; n >= 0 && ((uintptr_t)(y + n + 1) % STREAM_BYTES) != 0; n--) {
+            y[n] = iirdsp_process_sample(f, x[n]);
+        }
+        for (; n + 1 >= STREAM_LANES; n -= STREAM_LANES) {
+            if (((n + 1) % LINE_SAMPLES) < STREAM_LANES) {
+                IIRDSP_PREFETCH(x + n - IIRDSP_PREFETCH_DISTANCE);
+            }
+            for (int i = STREAM_LANES - 1; i >= 0; i--) {
+                v[i] = iirdsp_process_sample(f, x[n - (STREAM_LANES - 1) + i]);
+            }
+            stream_store(y + n - (STREAM_LANES - 1), v);
+        }
+        stream_fence();
+    }
+
+    for (; n >= 0; n--) {
+        y[n] = iirdsp_process_sample(f, x[n]);
+    }
+}
 
 /**
  * Process a buffer of samples through the filter
@@ -23,20 +113,549 @@ void iirdsp_process_buffer(
     int N
 )
 {
+    if (IIRDSP_STREAM_THRESHOLD > 0 && N >= IIRDSP_STREAM_THRESHOLD) {
+        iirdsp_process_buffer_stream(f, x, y, N);
+        return;
+    }
+
     for (int n = 0; n < N; n++) {
         y[n] = iirdsp_process_sample(f, x[n]);
     }
 }
 
+/**
+ * Process a large buffer with non-temporal output stores
+ *
+ * Outputs are produced STREAM_LANES at a time and written with one
+ * streaming store; the input is prefetched IIRDSP_PREFETCH_DISTANCE
+ * samples ahead, once per cache line.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ */
+void iirdsp_process_buffer_stream(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+)
+{
+    int n = 0;
+
+    if (((uintptr_t)y % sizeof(iirdsp_real)) == 0) {
+        iirdsp_real v[STREAM_LANES];
+
+        /* Scalar head until y + n is aligned for streaming stores */
+        for (; n < N && ((uintptr_t)(y + n) % STREAM_BYTES) != 0; n++) {
+            y[n] = iirdsp_process_sample(f, x[n]);
+        }
+        for (; n + STREAM_LANES <= N; n += STREAM_LANES) {
+            if ((n % LINE_SAMPLES) < STREAM_LANES) {
+                IIRDSP_PREFETCH(x + n + IIRDSP_PREFETCH_DISTANCE);
+            }
+            for (int i = 0; i < STREAM_LANES; i++) {
+                v[i] = iirdsp_process_sample(f, x[n + i]);
+            }
+            stream_store(y + n, v);
+        }
+        stream_fence();
+    }
+
+    for (; n < N; n++) {
+        y[n] = iirdsp_process_sample(f, x[n]);
+    }
+}
+
+/**
+ * Process a buffer with the wavefront (skewed-pipeline) kernel
+ *
+ * Each section owns one lane of a fixed-width lane vector. At step t,
+ * lane k filters sample t-k, taking its input from lane k-1's output of
+ * the previous step. After the lanes are shifted, lane S-1 holds output
+ * sample t-(S-1). The first S-1 steps (fill) and last S-1 steps (drain)
+ * mask inactive lanes so each section sees exactly samples 0..N-1, which
+ * keeps the result and the final state identical to the sample-major
+ * kernel.
+ *
+ * The lane loops have a compile-time trip count of IIRDSP_MAX_SECTIONS
+ * so the compiler can map them onto SIMD registers.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ */
+void iirdsp_process_buffer_wavefront(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N
+)
+{
+    const int S = f->num_sections;
+    iirdsp_real b0[IIRDSP_MAX_SECTIONS], b1[IIRDSP_MAX_SECTIONS], b2[IIRDSP_MAX_SECTIONS];
+    iirdsp_real a1[IIRDSP_MAX_SECTIONS], a2[IIRDSP_MAX_SECTIONS];
+    iirdsp_real z1[IIRDSP_MAX_SECTIONS], z2[IIRDSP_MAX_SECTIONS];
+    iirdsp_real in[IIRDSP_MAX_SECTIONS], out[IIRDSP_MAX_SECTIONS];
+
+    if (S <= 1 || N <= 0) {
+        iirdsp_process_buffer(f, x, y, N);
+        return;
+    }
+
+    /* Load sections into lanes; unused lanes are zero and never read back */
+    for (int k = 0; k < IIRDSP_MAX_SECTIONS; k++) {
+        if (k < S) {
+            b0[k] = f->sections[k].b0;
+            b1[k] = f->sections[k].b1;
+            b2[k] = f->sections[k].b2;
+            a1[k] = f->sections[k].a1;
+            a2[k] = f->sections[k].a2;
+            z1[k] = f->sections[k].z1;
+            z2[k] = f->sections[k].z2;
+        } else {
+            b0[k] = b1[k] = b2[k] = a1[k] = a2[k] = 0.0;
+            z1[k] = z2[k] = 0.0;
+        }
+        in[k] = 0.0;
+        out[k] = 0.0;
+    }
+
+    const int steps = N + S - 1;
+    int t = 0;
+
+    /* Fill: lane k becomes active once t >= k */
+    for (; t < S - 1 && t < N; t++) {
+        in[0] = x[t];
+        for (int k = 0; k <= t; k++) {
+            out[k] = b0[k] * in[k] + z1[k];
+            z1[k] = b1[k] * in[k] - a1[k] * out[k] + z2[k];
+            z2[k] = b2[k] * in[k] - a2[k] * out[k];
+        }
+        for (int k = S - 1; k > 0; k--) {
+            in[k] = out[k - 1];
+        }
+    }
+
+    /* Steady state: every lane active, one output per step */
+    for (; t < N; t++) {
+        in[0] = x[t];
+        for (int k = 0; k < IIRDSP_MAX_SECTIONS; k++) {
+            out[k] = b0[k] * in[k] + z1[k];
+            z1[k] = b1[k] * in[k] - a1[k] * out[k] + z2[k];
+            z2[k] = b2[k] * in[k] - a2[k] * out[k];
+        }
+        y[t - S + 1] = out[S - 1];
+        for (int k = IIRDSP_MAX_SECTIONS - 1; k > 0; k--) {
+            in[k] = out[k - 1];
+        }
+    }
+
+    /* Drain (also covers N < S - 1): lane k is active while t - k < N */
+    for (; t < steps; t++) {
+        int first = t - N + 1;
+        if (first < 0) {
+            first = 0;
+        }
+        int last = t < S - 1 ? t : S - 1;
+        for (int k = first; k <= last; k++) {
+            out[k] = b0[k] * in[k] + z1[k];
+            z1[k] = b1[k] * in[k] - a1[k] * out[k] + z2[k];
+            z2[k] = b2[k] * in[k] - a2[k] * out[k];
+        }
+        if (t >= S - 1) {
+            y[t - S + 1] = out[S - 1];
+        }
+        for (int k = S - 1; k > 0; k--) {
+            in[k] = out[k - 1];
+        }
+    }
+
+    for (int k = 0; k < S; k++) {
+        f->sections[k].z1 = z1[k];
+        f->sections[k].z2 = z2[k];
+    }
+}
+
+/**
+ * Run one biquad over a contiguous run of samples
+ *
+ * Coefficients and state live in locals for the whole run so the loop
+ * body is a single recursion the compiler can software-pipeline.
+ *
+ * @param s Biquad pointer (state updated)
+ * @param x Input samples (length n)
+ * @param y Output samples (length n), can alias x
+ * @param n Number of samples
+ */
+static void biquad_run(iirdsp_biquad_t* s, const iirdsp_real* x, iirdsp_real* y, int n)
+{
+    const iirdsp_real b0 = s->b0, b1 = s->b1, b2 = s->b2;
+    const iirdsp_real a1 = s->a1, a2 = s->a2;
+    iirdsp_real z1 = s->z1, z2 = s->z2;
+
+    for (int i = 0; i < n; i++) {
+        iirdsp_real in = x[i];
+        iirdsp_real out = b0 * in + z1;
+        z1 = b1 * in - a1 * out + z2;
+        z2 = b2 * in - a2 * out;
+        y[i] = out;
+    }
+
+    s->z1 = z1;
+    s->z2 = z2;
+}
+
+/**
+ * Process a buffer of samples section-major over cache-sized tiles
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ * @param tile Tile length in samples (<= 0 selects IIRDSP_TILE_DEFAULT)
+ */
+void iirdsp_process_buffer_tiled(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    int tile
+)
+{
+    if (tile <= 0) {
+        tile = IIRDSP_TILE_DEFAULT;
+    }
+    if (f->num_sections <= 0) {
+        if (y != x) {
+            memmove(y, x, N * sizeof(iirdsp_real));
+        }
+        return;
+    }
+
+    for (int start = 0; start < N; start += tile) {
+        int len = N - start < tile ? N - start : tile;
+
+        /* First section reads the input, the rest work in place on y */
+        biquad_run(&f->sections[0], x + start, y + start, len);
+        for (int i = 1; i < f->num_sections; i++) {
+            biquad_run(&f->sections[i], y + start, y + start, len);
+        }
+    }
+}
+
+/**
+ * Pick the fastest tile length for iirdsp_process_buffer_tiled()
+ *
+ * @param f Filter whose section count is tuned for
+ * @param work Scratch buffer (length N), overwritten
+ * @param N Scratch length
+ * @return Best tile length in samples
+ */
+int iirdsp_tile_autotune(
+    const iirdsp_filter_t* f,
+    iirdsp_real* work,
+    int N
+)
+{
+    int best_tile = IIRDSP_TILE_DEFAULT;
+    double best_time = -1.0;
+
+    if (N < 64) {
+        return best_tile;
+    }
+
+    for (int tile = 64; tile <= N; tile *= 2) {
+        iirdsp_filter_t trial = *f;
+        int reps = 0;
+        clock_t start;
+        clock_t elapsed;
+
+        for (int n = 0; n < N; n++) {
+            work[n] = (n & 1) ? 1.0 : -1.0;
+        }
+        iirdsp_filter_init(&trial);
+
+        /* Repeat until the measurement is well above clock() resolution */
+        start = clock();
+        do {
+            iirdsp_process_buffer_tiled(&trial, work, work, N, tile);
+            reps++;
+            elapsed = clock() - start;
+        } while (elapsed < CLOCKS_PER_SEC / 50 && reps < 1000);
+
+        double per_rep = (double)elapsed / reps;
+        if (best_time < 0.0 || per_rep < best_time) {
+            best_time = per_rep;
+            best_tile = tile;
+        }
+
+        if (tile > N / 2) {
+            break;
+        }
+    }
+
+    return best_tile;
+}
+
+/**
+ * DC gain of the whole cascade
+ *
+ * @param f Filter pointer
+ * @return Gain at 0 Hz
+ */
+iirdsp_real iirdsp_dc_gain(const iirdsp_filter_t* f)
+{
+    iirdsp_real gain = 1.0;
+
+    for (int i = 0; i < f->num_sections; i++) {
+        const iirdsp_biquad_t* s = &f->sections[i];
+        gain *= (s->b0 + s->b1 + s->b2) / (1.0 + s->a1 + s->a2);
+    }
+
+    return gain;
+}
+
+/**
+ * Process a buffer, skipping the cascade for idle (flat) channels
+ *
+ * For a constant input u, a DF2T section settles at
+ *   y  = g*u, with g = (b0 + b1 + b2) / (1 + a1 + a2)
+ *   z1 = y - b0*u
+ *   z2 = b2*u - a2*y
+ * and its output u' = y feeds the next section.
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), can alias x
+ * @param N Number of samples
+ * @param eps State tolerance below which the cascade counts as settled
+ * @param stats Counters to update, may be NULL
+ * @return 1 if the block was skipped, 0 if it was filtered
+ */
+int iirdsp_process_buffer_idle(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_real eps,
+    iirdsp_idle_stats_t* stats
+)
+{
+    iirdsp_real z1_ss[IIRDSP_MAX_SECTIONS];
+    iirdsp_real z2_ss[IIRDSP_MAX_SECTIONS];
+    int settled = N > 0;
+
+    if (stats != NULL) {
+        stats->blocks_total++;
+    }
+
+    /* Input must be exactly constant */
+    const iirdsp_real c = settled ? x[0] : 0.0;
+    for (int n = 1; n < N && settled; n++) {
+        settled = (x[n] == c);
+    }
+
+    /* Every section must sit within eps of its steady state */
+    iirdsp_real u = c;
+    for (int i = 0; i < f->num_sections && settled; i++) {
+        const iirdsp_biquad_t* s = &f->sections[i];
+        iirdsp_real den = 1.0 + s->a1 + s->a2;
+        iirdsp_real out;
+
+        if (u == 0.0) {
+            out = 0.0;
+        } else if (fabs(den) > 1e-12) {
+            out = (s->b0 + s->b1 + s->b2) / den * u;
+        } else {
+            settled = 0;  /* Pole at z = 1: no finite steady state */
+            break;
+        }
+
+        z1_ss[i] = out - s->b0 * u;
+        z2_ss[i] = s->b2 * u - s->a2 * out;
+        settled = fabs(s->z1 - z1_ss[i]) <= eps && fabs(s->z2 - z2_ss[i]) <= eps;
+        u = out;
+    }
+
+    if (!settled) {
+        iirdsp_process_buffer(f, x, y, N);
+        return 0;
+    }
+
+    for (int i = 0; i < f->num_sections; i++) {
+        f->sections[i].z1 = z1_ss[i];
+        f->sections[i].z2 = z2_ss[i];
+    }
+    for (int n = 0; n < N; n++) {
+        y[n] = u;
+    }
+
+    if (stats != NULL) {
+        stats->blocks_skipped++;
+        stats->samples_skipped += (unsigned long)N;
+    }
+    return 1;
+}
+
+/**
+ * Largest pole radius over all sections
+ *
+ * @param f Filter pointer
+ * @return Maximum pole magnitude
+ */
+iirdsp_real iirdsp_pole_radius(const iirdsp_filter_t* f)
+{
+    iirdsp_real r_max = 0.0;
+
+    for (int i = 0; i < f->num_sections; i++) {
+        iirdsp_real a1 = f->sections[i].a1;
+        iirdsp_real a2 = f->sections[i].a2;
+        iirdsp_real disc = a1 * a1 - 4.0 * a2;
+        iirdsp_real r;
+
+        if (disc < 0.0) {
+            r = sqrt(a2);  /* Complex pair: |p|^2 = a2 */
+        } else {
+            iirdsp_real sq = sqrt(disc);
+            iirdsp_real r1 = fabs((-a1 + sq) / 2.0);
+            iirdsp_real r2 = fabs((-a1 - sq) / 2.0);
+            r = r1 > r2 ? r1 : r2;
+        }
+        if (r > r_max) {
+            r_max = r;
+        }
+    }
+
+    return r_max;
+}
+
+/**
+ * Bound on the L1 norm of 1 / (1 + a1*z^-1 + a2*z^-2)
+ *
+ * The all-pole response is the convolution of p1^n and p2^n, so its L1
+ * norm is at most 1 / ((1 - |p1|) * (1 - |p2|)).
+ *
+ * @param s Section (must be stable)
+ * @return Upper bound on sum |g[n]|
+ */
+static double allpole_l1_bound(const iirdsp_biquad_t* s)
+{
+    double a1 = s->a1;
+    double a2 = s->a2;
+    double disc = a1 * a1 - 4.0 * a2;
+    double r1, r2;
+
+    if (disc < 0.0) {
+        r1 = r2 = sqrt(a2);
+    } else {
+        double sq = sqrt(disc);
+        r1 = fabs((-a1 + sq) / 2.0);
+        r2 = fabs((-a1 - sq) / 2.0);
+    }
+    return 1.0 / ((1.0 - r1) * (1.0 - r2));
+}
+
+/**
+ * Bound on the L1 mass of a cascade's zero-input response from its state
+ *
+ * With no input, a DF2T section outputs y[n] = z1*g[n] + z2*g[n-1], so its
+ * free response has L1 mass <= (|z1| + |z2|) * |g|_1. The response of a
+ * later section to the previous section's output adds at most
+ * (|b0| + |b1| + |b2|) * |g|_1 times that output's mass.
+ *
+ * @param h Filter holding the state
+ * @param g Per-section all-pole L1 bounds
+ * @return Upper bound on sum over n >= 0 of |y[n]| for zero input
+ */
+static double state_tail_bound(const iirdsp_filter_t* h, const double* g)
+{
+    double mass = 0.0;
+
+    for (int i = 0; i < h->num_sections; i++) {
+        const iirdsp_biquad_t* s = &h->sections[i];
+        double b = fabs((double)s->b0) + fabs((double)s->b1) + fabs((double)s->b2);
+        mass = g[i] * (fabs((double)s->z1) + fabs((double)s->z2) + b * mass);
+    }
+    return mass;
+}
+
+/**
+ * Effective impulse-response length for a given tolerance
+ *
+ * Two passes over the impulse response, so no storage is needed:
+ *   1. Simulate block by block until the remaining mass, bounded from the
+ *      cascade state (state_tail_bound()), is below tol/2. Record the
+ *      total |h| mass so far and that tail bound.
+ *   2. Re-simulate and return the first n whose remaining mass fits in tol.
+ *
+ * @param f Filter pointer
+ * @param tol L1 tail tolerance, > 0
+ * @return W in samples, or -1 if the filter is not stable or the tail does
+ *         not fall below tol within 2^28 samples
+ */
+int iirdsp_impulse_length(const iirdsp_filter_t* f, iirdsp_real tol)
+{
+    const long max_horizon = 1L << 28;
+    iirdsp_real r = iirdsp_pole_radius(f);
+    iirdsp_filter_t h = *f;
+    double g[IIRDSP_MAX_SECTIONS];
+    double total = 0.0;
+    double tail = 0.0;
+    long horizon = 0;
+
+    if (tol <= 0.0 || r >= 1.0) {
+        return -1;
+    }
+    if (f->num_sections <= 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < f->num_sections; i++) {
+        g[i] = allpole_l1_bound(&f->sections[i]);
+    }
+    long block = (long)(1.0 / (1.0 - r)) + 16;
+    if (block > 65536) {
+        block = 65536;
+    }
+
+    iirdsp_filter_init(&h);
+    for (;;) {
+        for (long n = 0; n < block; n++) {
+            total += fabs(iirdsp_process_sample(&h, horizon + n == 0 ? 1.0 : 0.0));
+        }
+        horizon += block;
+        tail = state_tail_bound(&h, g);
+        if (tail <= tol / 2.0) {
+            break;
+        }
+        if (horizon >= max_horizon) {
+            return -1;
+        }
+    }
+
+    /* Remaining mass from n onwards: (total - prefix) + tail */
+    double prefix = 0.0;
+    iirdsp_filter_init(&h);
+    for (long n = 0; n < horizon; n++) {
+        if (total - prefix + tail <= tol) {
+            return (int)n;
+        }
+        prefix += fabs(iirdsp_process_sample(&h, n == 0 ? 1.0 : 0.0));
+    }
+
+    return (int)horizon;
+}
+
 /**
  * Zero-phase filtering via forward-backward filtering (filtfilt)
  *
  * Algorithm:
  *   1. Forward filter x → temp
  *   2. Reset state
- *   3. Reverse temp
- *   4. Filter reversed → y
- *   5. Reverse y in-place
+ *   3. Filter temp from last to first sample → y
  *
  * @param f Filter pointer
  * @param x Input signal (length N)
@@ -63,21 +682,9 @@ void iirdsp_filtfilt(
     /* Reset state */
     iirdsp_filter_init(f);
 
-    /* Reverse temp in-place and filter backward */
-    for (int i = 0; i < N / 2; i++) {
-        iirdsp_real swap = temp[i];
-        temp[i] = temp[N - 1 - i];
-        temp[N - 1 - i] = swap;
-    }
-
-    iirdsp_process_buffer(f, temp, y, N);
-
-    /* Reverse y in-place */
-    for (int i = 0; i < N / 2; i++) {
-        iirdsp_real swap = y[i];
-        y[i] = y[N - 1 - i];
-        y[N - 1 - i] = swap;
-    }
+    /* Backward pass: walk temp from the end, writing y in place */
+    process_buffer_reverse(f, temp, y, N,
+                           IIRDSP_STREAM_THRESHOLD > 0 && N >= IIRDSP_STREAM_THRESHOLD);
 
     free(temp);
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+/**
+ * @file stats.c
+ * @brief Running output statistics fused into filtering
+ */
+
+#include "stats.h"
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * Start a new statistics window
+ *
+ * @param st Statistics to reset
+ * @param flags IIRDSP_STAT_* selection
+ */
+void iirdsp_stats_init(iirdsp_stats_t* st, unsigned flags)
+{
+    st->flags = flags;
+    st->count = 0;
+    st->sum = 0.0;
+    st->sum_sq = 0.0;
+    st->min = 0.0;
+    st->max = 0.0;
+    st->zero_crossings = 0;
+    st->last = 0.0;
+}
+
+iirdsp_real iirdsp_stats_mean(const iirdsp_stats_t* st)
+{
+    return st->count > 0 ? st->sum / st->count : 0.0;
+}
+
+iirdsp_real iirdsp_stats_rms(const iirdsp_stats_t* st)
+{
+    return st->count > 0 ? sqrt(st->sum_sq / st->count) : 0.0;
+}
+
+/**
+ * Accumulate one output sample
+ *
+ * The flag tests are loop-invariant, so the compiler can unswitch the
+ * calling loops into one specialized body per selection.
+ */
+static inline void stats_add(
+    unsigned flags,
+    iirdsp_real v,
+    iirdsp_real* sum,
+    iirdsp_real* sum_sq,
+    iirdsp_real* mn,
+    iirdsp_real* mx,
+    long* crossings,
+    iirdsp_real* last
+)
+{
+    if (flags & IIRDSP_STAT_SUM) {
+        *sum += v;
+    }
+    if (flags & IIRDSP_STAT_SUM_SQ) {
+        *sum_sq += v * v;
+    }
+    if (flags & IIRDSP_STAT_MIN) {
+        *mn = v < *mn ? v : *mn;
+    }
+    if (flags & IIRDSP_STAT_MAX) {
+        *mx = v > *mx ? v : *mx;
+    }
+    if (flags & IIRDSP_STAT_ZERO_CROSSINGS) {
+        *crossings += (v < 0.0) != (*last < 0.0);
+        *last = v;
+    }
+}
+
+/**
+ * Filter x into y while accumulating statistics
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), or NULL for stats only
+ * @param N Number of samples
+ * @param st Statistics to update
+ * @param reverse Nonzero to walk from x[N-1] to x[0]
+ */
+static void filter_with_stats(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_stats_t* st,
+    int reverse
+)
+{
+    if (N <= 0) {
+        return;
+    }
+
+    const unsigned flags = st->flags;
+    const int step = reverse ? -1 : 1;
+    iirdsp_real sum = st->sum, sum_sq = st->sum_sq;
+    iirdsp_real mn = st->min, mx = st->max;
+    long crossings = st->zero_crossings;
+    iirdsp_real last = st->last;
+    int n = reverse ? N - 1 : 0;
+    int k = 0;
+
+    /* The first sample of a window seeds min/max and the crossing sign */
+    if (st->count == 0) {
+        iirdsp_real v = iirdsp_process_sample(f, x[n]);
+        if (y != NULL) {
+            y[n] = v;
+        }
+        mn = mx = last = v;
+        stats_add(flags, v, &sum, &sum_sq, &mn, &mx, &crossings, &last);
+        n += step;
+        k = 1;
+    }
+
+    if (y != NULL) {
+        for (; k < N; k++, n += step) {
+            iirdsp_real v = iirdsp_process_sample(f, x[n]);
+            y[n] = v;
+            stats_add(flags, v, &sum, &sum_sq, &mn, &mx, &crossings, &last);
+        }
+    } else {
+        for (; k < N; k++, n += step) {
+            iirdsp_real v = iirdsp_process_sample(f, x[n]);
+            stats_add(flags, v, &sum, &sum_sq, &mn, &mx, &crossings, &last);
+        }
+    }
+
+    st->count += N;
+    st->sum = sum;
+    st->sum_sq = sum_sq;
+    st->min = mn;
+    st->max = mx;
+    st->zero_crossings = crossings;
+    st->last = last;
+}
+
+/**
+ * Filter a buffer and accumulate statistics over the output in one pass
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), or NULL for stats only
+ * @param N Number of samples
+ * @param st Statistics to update
+ */
+void iirdsp_process_buffer_stats(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_stats_t* st
+)
+{
+    filter_with_stats(f, x, y, N, st, 0);
+}
+
+/**
+ * Zero-phase filtering with statistics accumulated in the backward pass
+ *
+ * @param f Filter pointer
+ * @param x Input signal (length N)
+ * @param y Output signal (length N), or NULL for stats only
+ * @param N Number of samples
+ * @param st Statistics to update
+ * @return 0 on success, negative error code on failure
+ */
+int iirdsp_filtfilt_stats(
+    iirdsp_filter_t* f,
+    const iirdsp_real* x,
+    iirdsp_real* y,
+    int N,
+    iirdsp_stats_t* st
+)
+{
+    if (N <= 0) {
+        return 0;
+    }
+
+    iirdsp_real* temp = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+    if (temp == NULL) {
+        return -1;  /* Out of memory */
+    }
+
+    /* Forward pass: x → temp */
+    iirdsp_filter_init(f);
+    iirdsp_process_buffer(f, x, temp, N);
+
+    /* Backward pass: walk temp from the end, accumulating as we write y */
+    iirdsp_filter_init(f);
+    filter_with_stats(f, temp, y, N, st, 1);
+
+    free(temp);
+    return 0;
+}
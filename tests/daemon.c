@@ -0,0 +1,375 @@
+/**
+ * @file daemon.c
+ * @brief Filtering daemon test
+ *
+ * Starts iirdspd, opens streams (two sharing a spec), round-trips blocks
+ * of varying size through their rings and compares them with
+ * iirdsp_process_buffer(). Checks that rings cannot be resized, that a
+ * ring with a corrupted header and oversized block counts neither crashes
+ * the daemon nor disturbs other streams, that the stream limit is
+ * reported and recovered from, and that opening and closing many more
+ * distinct specs than the engine has coefficient sets keeps working.
+ *
+ * Usage: test_daemon path/to/iirdspd
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "iirdsp.h"
+#include "engine.h"
+#include "iirdspd.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-4
+#else
+#define TOL 1e-9
+#endif
+
+#define MAX_STREAMS 4
+#define SLOTS 4
+#define BLOCK 64
+#define ROUNDS 40
+
+typedef struct {
+    uint32_t id;
+    int fd;
+    iirdspd_ring_t* ring;
+    long fed;
+    iirdsp_filter_t ref;
+} test_stream_t;
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static void sleep_ms(int ms)
+{
+    struct timespec ts = { 0, ms * 1000000L };
+    nanosleep(&ts, NULL);
+}
+
+static iirdsp_spec_t lowpass(double fc)
+{
+    iirdsp_spec_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.kind = IIRDSP_SPEC_LOWPASS;
+    s.order = 4;
+    s.f1 = fc;
+    s.fs = 500.0;
+    return s;
+}
+
+/* Next reply to op, skipping DONE notifications; *fd_out gets a passed fd or -1 */
+static int await_reply(int sock, uint32_t op, iirdspd_reply_t* reply, int* fd_out)
+{
+    for (;;) {
+        struct msghdr msg;
+        struct iovec iov;
+        char control[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr* cm;
+
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base = reply;
+        iov.iov_len = sizeof(*reply);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(sock, &msg, 0) != (ssize_t)sizeof(*reply)) {
+            return -1;
+        }
+        if (reply->op != op) {
+            continue;
+        }
+        *fd_out = -1;
+        cm = CMSG_FIRSTHDR(&msg);
+        if (cm != NULL && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd_out, CMSG_DATA(cm), sizeof(int));
+        }
+        return 0;
+    }
+}
+
+static int request(int sock, uint32_t op, uint32_t stream, const iirdsp_spec_t* spec,
+                   iirdspd_reply_t* reply, int* fd_out)
+{
+    iirdspd_request_t req;
+    int fd = -1;
+
+    memset(&req, 0, sizeof(req));
+    req.op = op;
+    req.stream = stream;
+    req.slots = SLOTS;
+    req.slot_samples = BLOCK;
+    if (spec != NULL) {
+        req.spec = *spec;
+    }
+    if (send(sock, &req, sizeof(req), MSG_NOSIGNAL) != (ssize_t)sizeof(req) ||
+        await_reply(sock, op, reply, &fd) != 0) {
+        return -1;
+    }
+    if (fd_out != NULL) {
+        *fd_out = fd;
+    } else if (fd >= 0) {
+        close(fd);
+    }
+    return reply->status;
+}
+
+/* Open a stream and map its ring; returns the reply status, or -100 on transport errors */
+static int open_stream(int sock, test_stream_t* s, const iirdsp_spec_t* spec)
+{
+    iirdspd_reply_t reply;
+    void* mem;
+    int rc = request(sock, IIRDSPD_OP_OPEN, 0, spec, &reply, &s->fd);
+
+    if (rc != 0 || s->fd < 0) {
+        return rc != 0 ? rc : -100;
+    }
+    mem = mmap(NULL, iirdspd_ring_bytes(SLOTS, BLOCK), PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+    if (mem == MAP_FAILED) {
+        close(s->fd);
+        return -100;
+    }
+    s->id = reply.stream;
+    s->ring = (iirdspd_ring_t*)mem;
+    s->fed = 0;
+    iirdsp_spec_design(spec, &s->ref);
+    return 0;
+}
+
+static int close_stream(int sock, test_stream_t* s)
+{
+    iirdspd_reply_t reply;
+
+    munmap(s->ring, iirdspd_ring_bytes(SLOTS, BLOCK));
+    close(s->fd);
+    return request(sock, IIRDSPD_OP_CLOSE, s->id, NULL, &reply, NULL);
+}
+
+/* Submit slot i with count samples (the rest of the slot is zero) and kick;
+   the input is also copied to copy unless it is NULL */
+static void submit(int sock, test_stream_t* s, uint32_t i, uint32_t count, long start, iirdsp_real* copy)
+{
+    iirdspd_request_t req;
+    iirdsp_real* x = iirdspd_ring_samples(s->ring, SLOTS, BLOCK, i);
+    iirdspd_slot_t* slot = iirdspd_ring_slot(s->ring, i);
+
+    for (uint32_t n = 0; n < BLOCK; n++) {
+        x[n] = n < count ? (iirdsp_real)(sin(0.02 * (double)(start + n) * (1 + s->id)) + 0.3 * sin(0.9 * (double)(start + n))) : 0;
+    }
+    if (copy != NULL) {
+        memcpy(copy, x, BLOCK * sizeof(iirdsp_real));
+    }
+    slot->count = count;
+    __atomic_store_n(&slot->state, IIRDSPD_SLOT_SUBMITTED, __ATOMIC_SEQ_CST);
+
+    memset(&req, 0, sizeof(req));
+    req.op = IIRDSPD_OP_KICK;
+    req.stream = s->id;
+    send(sock, &req, sizeof(req), MSG_NOSIGNAL);
+}
+
+/* Wait up to five seconds for slot i to come back */
+static int await_done(test_stream_t* s, uint32_t i)
+{
+    iirdspd_slot_t* slot = iirdspd_ring_slot(s->ring, i);
+
+    for (int t = 0; t < 5000; t++) {
+        if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) == IIRDSPD_SLOT_DONE) {
+            return 1;
+        }
+        sleep_ms(1);
+    }
+    return 0;
+}
+
+/* Push one block of count samples through slot i and compare with the local reference */
+static int round_trip(int sock, test_stream_t* s, uint32_t i, uint32_t count)
+{
+    iirdsp_real ref[BLOCK];
+    const iirdsp_real* y = iirdspd_ring_samples(s->ring, SLOTS, BLOCK, i);
+    int ok;
+
+    submit(sock, s, i, count, s->fed, ref);
+    iirdsp_process_buffer(&s->ref, ref, ref, (int)count);
+    s->fed += count;
+    ok = await_done(s, i);
+    for (uint32_t n = 0; ok && n < count; n++) {
+        ok = fabs((double)(y[n] - ref[n])) <= TOL;
+    }
+    __atomic_store_n(&iirdspd_ring_slot(s->ring, i)->state, IIRDSPD_SLOT_FREE, __ATOMIC_RELEASE);
+    return ok;
+}
+
+static int connect_to(const char* path)
+{
+    struct sockaddr_un addr;
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    for (int t = 0; sock >= 0 && t < 500; t++) {
+        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            return sock;
+        }
+        sleep_ms(10);
+    }
+    if (sock >= 0) {
+        close(sock);
+    }
+    return -1;
+}
+
+int main(int argc, char** argv)
+{
+    test_stream_t s[MAX_STREAMS];
+    test_stream_t extra;
+    iirdsp_spec_t specs[3];
+    char path[64];
+    char nstreams[16];
+    pid_t pid;
+    int status = -1;
+    int sock;
+    int ok;
+
+    printf("iirdsp Daemon Test\n");
+    printf("==================\n\n");
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: test_daemon path/to/iirdspd\n");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "/tmp/iirdspd_test_%d.sock", (int)getpid());
+    snprintf(nstreams, sizeof(nstreams), "%d", MAX_STREAMS);
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout);
+        execl(argv[1], argv[1], "-S", path, "-n", nstreams, (char*)NULL);
+        _exit(127);
+    }
+    sock = pid > 0 ? connect_to(path) : -1;
+    if (sock < 0) {
+        printf("cannot start or reach the daemon\n");
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+        }
+        return 1;
+    }
+
+    printf("Open\n");
+    specs[0] = lowpass(40.0);
+    specs[1] = lowpass(40.0);
+    specs[2] = lowpass(90.0);
+    for (int k = 0; k < 3; k++) {
+        check(open_stream(sock, &s[k], &specs[k]) == 0, "open stream");
+    }
+    {
+        iirdspd_request_t req;
+        iirdspd_reply_t reply;
+
+        memset(&req, 0, sizeof(req));
+        req.op = IIRDSPD_OP_OPEN;
+        req.slots = 0;
+        req.slot_samples = BLOCK;
+        req.spec = specs[0];
+        send(sock, &req, sizeof(req), MSG_NOSIGNAL);
+        check(await_reply(sock, IIRDSPD_OP_OPEN, &reply, &ok) == 0 && reply.status == IIRDSPD_EINVAL,
+              "zero slots rejected");
+    }
+
+    printf("Sealed rings\n");
+    check(ftruncate(s[0].fd, 0) != 0 && errno == EPERM, "ring cannot shrink");
+    check(ftruncate(s[0].fd, (off_t)iirdspd_ring_bytes(SLOTS, BLOCK) * 2) != 0 && errno == EPERM,
+          "ring cannot grow");
+
+    printf("Round trips\n");
+    ok = 1;
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int k = 0; k < 3; k++) {
+            ok &= round_trip(sock, &s[k], (uint32_t)r % SLOTS, 1 + (uint32_t)(r * 37 + k * 11) % BLOCK);
+        }
+    }
+    check(ok, "blocks match iirdsp_process_buffer()");
+
+    printf("Stream limit\n");
+    check(open_stream(sock, &s[3], &specs[2]) == 0, "open last stream");
+    check(open_stream(sock, &extra, &specs[2]) == IIRDSPD_EFULL, "open beyond -n reports EFULL");
+    check(close_stream(sock, &s[3]) == 0, "close last stream");
+    check(open_stream(sock, &s[3], &specs[2]) == 0, "stream slot reused after close");
+
+    printf("Malformed ring\n");
+    s[3].ring->slots = 0;
+    s[3].ring->slot_samples = 0xffffffffu;
+    submit(sock, &s[3], 0, BLOCK, 0, NULL);
+    iirdspd_ring_slot(s[3].ring, 0)->count = 1000000000u;
+    submit(sock, &s[3], 1, 1000000000u, 0, NULL);
+    check(await_done(&s[3], 0) && await_done(&s[3], 1), "oversized blocks complete");
+    check(iirdspd_ring_slot(s[3].ring, 1)->count == 1000000000u, "client count left alone");
+    ok = 1;
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int k = 0; k < 3; k++) {
+            ok &= round_trip(sock, &s[k], (uint32_t)r % SLOTS, 1 + (uint32_t)(r * 13 + k) % BLOCK);
+        }
+    }
+    check(ok, "other streams unaffected");
+    check(waitpid(pid, &status, WNOHANG) == 0, "daemon still running");
+    check(close_stream(sock, &s[3]) == 0, "close malformed stream");
+
+    printf("Coefficient sets\n");
+    ok = 1;
+    for (int k = 0; k < 4 * IIRDSP_ENGINE_MAX_COEFFS; k++) {
+        iirdsp_spec_t spec = lowpass(10.0 + 0.5 * k);
+
+        ok &= open_stream(sock, &s[3], &spec) == 0 && round_trip(sock, &s[3], 0, BLOCK) &&
+              close_stream(sock, &s[3]) == 0;
+    }
+    check(ok, "distinct specs keep opening after close");
+    check(open_stream(sock, &s[3], &specs[2]) == 0, "open last stream");
+    for (int k = 0; k < IIRDSP_ENGINE_MAX_COEFFS && ok; k++) {
+        iirdsp_spec_t spec = lowpass(5.0 + 0.5 * k);
+
+        ok = open_stream(sock, &extra, &spec) == IIRDSPD_EFULL;
+    }
+    check(ok, "stream limit reported before any design");
+    check(close_stream(sock, &s[3]) == 0, "close last stream");
+    check(open_stream(sock, &s[3], &specs[0]) == 0 && round_trip(sock, &s[3], 0, BLOCK) &&
+          close_stream(sock, &s[3]) == 0, "open after refused opens");
+
+    for (int k = 0; k < 3; k++) {
+        check(close_stream(sock, &s[k]) == 0, "close stream");
+    }
+    close(sock);
+    kill(pid, SIGTERM);
+    check(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0,
+          "daemon exits cleanly");
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file design.c
+ * @brief Butterworth design test: stability and band-edge response
+ *
+ * Every supported order must give stable sections, unit gain in the pass
+ * band and -3 dB (1/sqrt(2)) at each cutoff frequency.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "iirdsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-3
+#else
+#define TOL 1e-6
+#endif
+
+static int failures = 0;
+
+static void check(int ok, const char* what, int order)
+{
+    if (!ok) {
+        printf("  FAILED: %s (order %d)\n", what, order);
+        failures++;
+    }
+}
+
+static double magnitude(const iirdsp_filter_t* f, double freq, double fs)
+{
+    double w = 2.0 * M_PI * freq / fs;
+    double h_re = 1.0, h_im = 0.0;
+
+    for (int i = 0; i < f->num_sections; i++) {
+        const iirdsp_biquad_t* s = &f->sections[i];
+        double num_re = s->b0 + s->b1 * cos(w) + s->b2 * cos(2.0 * w);
+        double num_im = -s->b1 * sin(w) - s->b2 * sin(2.0 * w);
+        double den_re = 1.0 + s->a1 * cos(w) + s->a2 * cos(2.0 * w);
+        double den_im = -s->a1 * sin(w) - s->a2 * sin(2.0 * w);
+        double d = den_re * den_re + den_im * den_im;
+        double sec_re = (num_re * den_re + num_im * den_im) / d;
+        double sec_im = (num_im * den_re - num_re * den_im) / d;
+        double re = h_re * sec_re - h_im * sec_im;
+        h_im = h_re * sec_im + h_im * sec_re;
+        h_re = re;
+    }
+
+    return sqrt(h_re * h_re + h_im * h_im);
+}
+
+int main(void)
+{
+    const double fs = 500.0;
+    const double half_power = 1.0 / sqrt(2.0);
+    iirdsp_filter_t f;
+
+    printf("iirdsp Butterworth Design Test\n");
+    printf("==============================\n\n");
+
+    for (int order = 1; order <= 2 * IIRDSP_MAX_SECTIONS; order++) {
+        check(butter_lowpass_init(&f, order, 40.0, fs) == 0, "low-pass init", order);
+        check(iirdsp_pole_radius(&f) < 1.0, "low-pass stable", order);
+        check(fabs(magnitude(&f, 40.0, fs) - half_power) < TOL, "low-pass -3 dB at cutoff", order);
+        check(fabs(magnitude(&f, 0.0, fs) - 1.0) < TOL, "low-pass unit DC gain", order);
+
+        check(butter_highpass_init(&f, order, 5.0, fs) == 0, "high-pass init", order);
+        check(iirdsp_pole_radius(&f) < 1.0, "high-pass stable", order);
+        check(fabs(magnitude(&f, 5.0, fs) - half_power) < TOL, "high-pass -3 dB at cutoff", order);
+        check(fabs(magnitude(&f, fs / 2.0, fs) - 1.0) < TOL, "high-pass unit Nyquist gain", order);
+    }
+
+    for (int order = 1; order <= IIRDSP_MAX_SECTIONS; order++) {
+        check(butter_bandpass_init(&f, order, 0.5, 40.0, fs) == 0, "band-pass init", order);
+        check(iirdsp_pole_radius(&f) < 1.0, "band-pass stable", order);
+        check(fabs(magnitude(&f, 0.5, fs) - half_power) < TOL, "band-pass -3 dB at low edge", order);
+        check(fabs(magnitude(&f, 40.0, fs) - half_power) < TOL, "band-pass -3 dB at high edge", order);
+        check(magnitude(&f, 5.0, fs) < 1.0 + TOL, "band-pass peak gain <= 1", order);
+    }
+
+    if (failures == 0) {
+        printf("✓ Test PASSED: all designs stable with correct band edges\n");
+        return 0;
+    }
+    printf("✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
@@ -0,0 +1,249 @@
+/**
+ * @file hotswap.c
+ * @brief Coefficient hot-swap test
+ *
+ * Checks each state policy against a hand-built reference, that a
+ * crossfade starts at the old output and ends on the new filter, and
+ * that a real-time thread processing blocks while another thread
+ * publishes thousands of updates only ever runs complete coefficient
+ * sets and every update is freed exactly once.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include "iirdsp.h"
+#include "hotswap.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-4
+#else
+#define TOL 1e-10
+#endif
+
+#define BLOCK 64
+#define BLOCKS 40
+#define UPDATES 5000
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static iirdsp_filter_t lp40;
+static iirdsp_filter_t lp150;
+
+static iirdsp_real input(int n)
+{
+    return 1.5 + sin(0.05 * n) + 0.4 * sin(0.9 * n);
+}
+
+static int same_coeffs(const iirdsp_filter_t* a, const iirdsp_filter_t* b)
+{
+    if (a->num_sections != b->num_sections) {
+        return 0;
+    }
+    for (int i = 0; i < a->num_sections; i++) {
+        const iirdsp_biquad_t* s = &a->sections[i];
+        const iirdsp_biquad_t* t = &b->sections[i];
+        if (s->b0 != t->b0 || s->b1 != t->b1 || s->b2 != t->b2 || s->a1 != t->a1 || s->a2 != t->a2) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void test_keep_and_reset(void)
+{
+    static iirdsp_real x[BLOCK * BLOCKS];
+    static iirdsp_real y[BLOCK * BLOCKS];
+    static iirdsp_real ref[BLOCK * BLOCKS];
+    iirdsp_hotswap_t* h = iirdsp_hotswap_create(&lp40);
+    iirdsp_filter_t f = lp40;
+    int half = BLOCK * BLOCKS / 2;
+    int ok = 1;
+
+    printf("Keep and reset policies\n");
+    for (int n = 0; n < BLOCK * BLOCKS; n++) {
+        x[n] = input(n);
+    }
+
+    /* Keep: the state carries over into the new coefficients */
+    for (int b = 0; b < BLOCKS; b++) {
+        if (b == BLOCKS / 2) {
+            check(iirdsp_hotswap_publish(h, &lp150, IIRDSP_SWAP_KEEP, 0) == 0, "publish");
+            check(iirdsp_hotswap_generation(h) == 0, "not adopted before the block boundary");
+        }
+        iirdsp_hotswap_process(h, x + b * BLOCK, y + b * BLOCK, BLOCK);
+    }
+    check(iirdsp_hotswap_generation(h) == 1, "adopted at the block boundary");
+    iirdsp_process_buffer(&f, x, ref, half);
+    for (int i = 0; i < f.num_sections; i++) {
+        iirdsp_biquad_t* s = &f.sections[i];
+        iirdsp_real z1 = s->z1;
+        iirdsp_real z2 = s->z2;
+        *s = lp150.sections[i];
+        s->z1 = z1;
+        s->z2 = z2;
+    }
+    iirdsp_process_buffer(&f, x + half, ref + half, half);
+    for (int n = 0; n < BLOCK * BLOCKS; n++) {
+        ok &= fabs(y[n] - ref[n]) <= TOL;
+    }
+    check(ok, "keep matches manual coefficient switch");
+
+    /* Reset: the new filter starts from zero state */
+    check(iirdsp_hotswap_publish(h, &lp40, IIRDSP_SWAP_RESET, 0) == 0, "publish");
+    iirdsp_hotswap_process(h, x, y, BLOCK);
+    f = lp40;
+    iirdsp_filter_init(&f);
+    iirdsp_process_buffer(&f, x, ref, BLOCK);
+    ok = 1;
+    for (int n = 0; n < BLOCK; n++) {
+        ok &= fabs(y[n] - ref[n]) <= TOL;
+    }
+    check(ok, "reset matches a fresh filter");
+    check(iirdsp_hotswap_reclaim(h) == 2, "both updates reclaimed");
+    check(iirdsp_hotswap_reclaim(h) == 0, "nothing left to reclaim");
+
+    check(iirdsp_hotswap_publish(h, &lp40, (iirdsp_swap_state_t)7, 0) == -1, "bad policy rejected");
+    check(iirdsp_hotswap_publish(h, &lp40, IIRDSP_SWAP_KEEP, -1) == -1, "bad crossfade rejected");
+    iirdsp_hotswap_destroy(h);
+}
+
+static void test_steady_and_crossfade(void)
+{
+    iirdsp_real x[BLOCK];
+    iirdsp_real y[BLOCK];
+    iirdsp_hotswap_t* h = iirdsp_hotswap_create(&lp40);
+    iirdsp_real prev;
+    int ok = 1;
+
+    printf("Steady-state remap and crossfade\n");
+
+    /* Settle on a DC level, then switch with the steady-state policy */
+    for (int n = 0; n < BLOCK; n++) {
+        x[n] = 2.0;
+    }
+    for (int b = 0; b < 50; b++) {
+        iirdsp_hotswap_process(h, x, y, BLOCK);
+    }
+    iirdsp_hotswap_publish(h, &lp150, IIRDSP_SWAP_STEADY, 0);
+    iirdsp_hotswap_process(h, x, y, BLOCK);
+    for (int n = 0; n < BLOCK; n++) {
+        ok &= fabs(y[n] - 2.0 * iirdsp_dc_gain(&lp150)) <= 1e-4;
+    }
+    check(ok, "steady-state remap leaves no transient on DC");
+    check(same_coeffs(iirdsp_hotswap_active(h), &lp150), "active coefficients switched");
+
+    /* Crossfade: first sample close to the old output, later samples follow the new filter */
+    for (int n = 0; n < BLOCK; n++) {
+        x[n] = input(n);
+    }
+    iirdsp_hotswap_process(h, x, y, BLOCK);
+    prev = y[BLOCK - 1];
+    iirdsp_hotswap_publish(h, &lp40, IIRDSP_SWAP_RESET, 32);
+    iirdsp_hotswap_process(h, x, y, BLOCK);
+    check(fabs(y[0] - prev) < 0.2, "crossfade starts near the old output");
+    {
+        iirdsp_filter_t f = lp40;
+        iirdsp_real ref[BLOCK];
+
+        iirdsp_filter_init(&f);
+        iirdsp_process_buffer(&f, x, ref, BLOCK);
+        ok = 1;
+        for (int n = 32; n < BLOCK; n++) {
+            ok &= fabs(y[n] - ref[n]) <= TOL;
+        }
+        check(ok, "after the fade the output is the new filter alone");
+    }
+    iirdsp_hotswap_destroy(h);
+}
+
+typedef struct {
+    iirdsp_hotswap_t* h;
+    volatile int stop;
+    int torn;
+    long blocks;
+} rt_ctx_t;
+
+static void* rt_thread(void* arg)
+{
+    rt_ctx_t* c = (rt_ctx_t*)arg;
+    iirdsp_real x[BLOCK];
+    iirdsp_real y[BLOCK];
+
+    for (int n = 0; n < BLOCK; n++) {
+        x[n] = input(n);
+    }
+    while (!__atomic_load_n(&c->stop, __ATOMIC_ACQUIRE)) {
+        const iirdsp_filter_t* f;
+
+        iirdsp_hotswap_process(c->h, x, y, BLOCK);
+        f = iirdsp_hotswap_active(c->h);
+        if (!same_coeffs(f, &lp40) && !same_coeffs(f, &lp150)) {
+            c->torn++;
+        }
+        c->blocks++;
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    rt_ctx_t c;
+    pthread_t rt;
+    int reclaimed = 0;
+    unsigned long gen;
+
+    printf("Concurrent publishing\n");
+    c.h = iirdsp_hotswap_create(&lp40);
+    c.stop = 0;
+    c.torn = 0;
+    c.blocks = 0;
+    pthread_create(&rt, NULL, rt_thread, &c);
+
+    for (int k = 0; k < UPDATES; k++) {
+        iirdsp_hotswap_publish(c.h, k % 2 ? &lp40 : &lp150, (iirdsp_swap_state_t)(k % 3), k % 4 * 8);
+        reclaimed += iirdsp_hotswap_reclaim(c.h);
+        if (k % 64 == 0) {
+            sched_yield();
+        }
+    }
+    __atomic_store_n(&c.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(rt, NULL);
+    reclaimed += iirdsp_hotswap_reclaim(c.h);
+    gen = iirdsp_hotswap_generation(c.h);
+
+    printf("  %ld blocks, %lu of %d updates adopted\n", c.blocks, gen, UPDATES);
+    check(c.torn == 0, "real-time thread never ran a torn coefficient set");
+    check((unsigned long)reclaimed == gen, "every adopted update reclaimed once");
+    iirdsp_hotswap_destroy(c.h);
+}
+
+int main(void)
+{
+    printf("iirdsp Coefficient Hot-Swap Test\n");
+    printf("================================\n\n");
+
+    butter_lowpass_init(&lp40, 4, 40.0, 500.0);
+    butter_lowpass_init(&lp150, 4, 150.0, 500.0);
+
+    test_keep_and_reset();
+    test_steady_and_crossfade();
+    test_concurrent();
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file kernels.c
+ * @brief Equivalence test for the alternative buffer-processing kernels
+ *
+ * Every kernel must produce the same output and leave the same filter
+ * state as the reference iirdsp_process_buffer(), including when a stream
+ * is split across calls of arbitrary length.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "iirdsp.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-4
+#define IDLE_EPS 1e-5
+#else
+#define TOL 1e-10
+#define IDLE_EPS 1e-9
+#endif
+
+typedef void (*kernel_fn)(iirdsp_filter_t*, const iirdsp_real*, iirdsp_real*, int);
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static iirdsp_real max_abs_diff(const iirdsp_real* a, const iirdsp_real* b, int N)
+{
+    iirdsp_real d = 0.0;
+    for (int i = 0; i < N; i++) {
+        iirdsp_real e = fabs(a[i] - b[i]);
+        if (!(e <= d)) {
+            d = e;  /* NaN propagates as a mismatch */
+        }
+    }
+    return d;
+}
+
+static iirdsp_real state_diff(const iirdsp_filter_t* a, const iirdsp_filter_t* b)
+{
+    iirdsp_real d = 0.0;
+    for (int i = 0; i < a->num_sections; i++) {
+        iirdsp_real e1 = fabs(a->sections[i].z1 - b->sections[i].z1);
+        iirdsp_real e2 = fabs(a->sections[i].z2 - b->sections[i].z2);
+        if (!(e1 <= d)) d = e1;
+        if (!(e2 <= d)) d = e2;
+    }
+    return d;
+}
+
+/* Run the reference and the kernel over x in chunks of the given lengths */
+static void compare_kernel(const char* name, kernel_fn kernel,
+                           const iirdsp_filter_t* design,
+                           const iirdsp_real* x, int N,
+                           const int* chunks, int num_chunks)
+{
+    iirdsp_real* y_ref = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+    iirdsp_real* y_k   = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+    iirdsp_filter_t ref = *design;
+    iirdsp_filter_t k = *design;
+    char what[128];
+
+    iirdsp_filter_init(&ref);
+    iirdsp_filter_init(&k);
+    iirdsp_process_buffer(&ref, x, y_ref, N);
+
+    int pos = 0;
+    for (int c = 0; pos < N; c = (c + 1) % num_chunks) {
+        int len = chunks[c];
+        if (pos + len > N) {
+            len = N - pos;
+        }
+        kernel(&k, x + pos, y_k + pos, len);
+        pos += len;
+    }
+
+    snprintf(what, sizeof(what), "%s output (%d sections)", name, design->num_sections);
+    check(max_abs_diff(y_ref, y_k, N) < TOL, what);
+    snprintf(what, sizeof(what), "%s state (%d sections)", name, design->num_sections);
+    check(state_diff(&ref, &k) < TOL, what);
+
+    free(y_ref);
+    free(y_k);
+}
+
+static int tile_length = 37;
+
+static void tiled_kernel(iirdsp_filter_t* f, const iirdsp_real* x, iirdsp_real* y, int N)
+{
+    iirdsp_process_buffer_tiled(f, x, y, N, tile_length);
+}
+
+int main(void)
+{
+    const iirdsp_real fs = 500.0;
+    const int N = 2000;
+    const int chunks[] = { 1, 7, 2, 300, 3, 64, 1000 };
+    const int num_chunks = (int)(sizeof(chunks) / sizeof(chunks[0]));
+    iirdsp_filter_t designs[4];
+    iirdsp_real* x = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+
+    printf("iirdsp Kernel Equivalence Test\n");
+    printf("==============================\n\n");
+
+    butter_bandpass_init(&designs[0], 4, 0.5, 40.0, fs);
+    butter_lowpass_init(&designs[1], 16, 40.0, fs);
+    butter_highpass_init(&designs[2], 3, 5.0, fs);
+    notch_filter_init(&designs[3], 50.0, 30.0, fs);
+
+    srand(1234);
+    for (int n = 0; n < N; n++) {
+        x[n] = sin(2.0 * 3.14159265358979 * 7.0 * n / fs) + (rand() / (iirdsp_real)RAND_MAX - 0.5);
+    }
+
+    for (int d = 0; d < 4; d++) {
+        compare_kernel("wavefront", iirdsp_process_buffer_wavefront,
+                       &designs[d], x, N, chunks, num_chunks);
+        compare_kernel("tiled", tiled_kernel,
+                       &designs[d], x, N, chunks, num_chunks);
+        compare_kernel("stream", iirdsp_process_buffer_stream,
+                       &designs[d], x, N, chunks, num_chunks);
+    }
+
+    iirdsp_real* work = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+    tile_length = iirdsp_tile_autotune(&designs[1], work, N);
+    printf("Autotuned tile length: %d samples\n", tile_length);
+    check(tile_length >= 64 && tile_length <= N, "autotuned tile in range");
+    compare_kernel("tiled (autotuned)", tiled_kernel,
+                   &designs[1], x, N, chunks, num_chunks);
+    free(work);
+
+    /* Idle-channel fast path: flat input on a settled cascade is skipped */
+    {
+        iirdsp_idle_stats_t stats = { 0, 0, 0 };
+        iirdsp_filter_t f = designs[3];
+        iirdsp_real flat[256];
+        iirdsp_real out[256];
+        iirdsp_real gain;
+
+        /* 50 Hz + 60 Hz notch cascade: two stable sections, unity DC gain */
+        notch_filter_init(&f, 60.0, 30.0, fs);
+        f.sections[1] = f.sections[0];
+        notch_filter_init(&f, 50.0, 30.0, fs);
+        f.num_sections = 2;
+        gain = iirdsp_dc_gain(&f);
+
+        for (int n = 0; n < 256; n++) {
+            flat[n] = 0.75;
+        }
+
+        /* Unsettled: filtered normally, then settles after enough blocks */
+        iirdsp_filter_init(&f);
+        check(iirdsp_process_buffer_idle(&f, flat, out, 256, IDLE_EPS, &stats) == 0,
+              "idle path filters an unsettled cascade");
+        for (int b = 0; b < 64; b++) {
+            iirdsp_process_buffer_idle(&f, flat, out, 256, IDLE_EPS, &stats);
+        }
+        check(iirdsp_process_buffer_idle(&f, flat, out, 256, IDLE_EPS, &stats) == 1,
+              "idle path skips a settled constant block");
+        check(fabs(out[0] - gain * 0.75) < TOL && fabs(out[255] - gain * 0.75) < TOL,
+              "skipped block equals DC gain times constant");
+
+        /* Zero input with decayed state */
+        for (int n = 0; n < 256; n++) {
+            flat[n] = 0.0;
+        }
+        iirdsp_filter_init(&f);
+        check(iirdsp_process_buffer_idle(&f, flat, out, 256, IDLE_EPS, &stats) == 1 && out[100] == 0.0,
+              "idle path skips a zero block on zero state");
+
+        /* Non-constant input is never skipped */
+        check(iirdsp_process_buffer_idle(&f, x, out, 256, IDLE_EPS, &stats) == 0,
+              "idle path filters a non-constant block");
+
+        check(stats.blocks_total == 68 && stats.blocks_skipped >= 2 &&
+              stats.samples_skipped == 256 * stats.blocks_skipped,
+              "idle counters");
+        printf("Idle path: skipped %lu of %lu blocks\n", stats.blocks_skipped, stats.blocks_total);
+    }
+
+    /* Fused statistics: identical output, stats match a separate pass */
+    {
+        iirdsp_filter_t a = designs[0], b = designs[0];
+        iirdsp_real* y1 = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+        iirdsp_real* y2 = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+        iirdsp_stats_t st, st_only;
+        iirdsp_real sum = 0.0, sum_sq = 0.0, mn = 0.0, mx = 0.0;
+        long crossings = 0;
+
+        iirdsp_stats_init(&st, IIRDSP_STAT_ALL);
+        iirdsp_stats_init(&st_only, IIRDSP_STAT_SUM_SQ | IIRDSP_STAT_MAX);
+        iirdsp_filter_init(&a);
+        iirdsp_filter_init(&b);
+        iirdsp_process_buffer(&a, x, y1, N);
+        for (int pos = 0, c = 0; pos < N; c = (c + 1) % num_chunks) {
+            int len = pos + chunks[c] > N ? N - pos : chunks[c];
+            iirdsp_process_buffer_stats(&b, x + pos, y2 + pos, len, &st);
+            pos += len;
+        }
+        check(max_abs_diff(y1, y2, N) == 0.0, "stats kernel output");
+
+        for (int n = 0; n < N; n++) {
+            sum += y1[n];
+            sum_sq += y1[n] * y1[n];
+            mn = (n == 0 || y1[n] < mn) ? y1[n] : mn;
+            mx = (n == 0 || y1[n] > mx) ? y1[n] : mx;
+            crossings += n > 0 && ((y1[n] < 0.0) != (y1[n - 1] < 0.0));
+        }
+        check(st.count == N && fabs(st.sum - sum) < TOL * N && fabs(st.sum_sq - sum_sq) < TOL * N,
+              "stats sum / sum of squares");
+        check(st.min == mn && st.max == mx && st.zero_crossings == crossings,
+              "stats min / max / zero crossings");
+
+        iirdsp_filter_init(&b);
+        iirdsp_process_buffer_stats(&b, x, NULL, N, &st_only);
+        check(fabs(iirdsp_stats_rms(&st_only) - sqrt(sum_sq / N)) < TOL && st_only.max == mx,
+              "stats-only mode");
+
+        iirdsp_stats_init(&st, IIRDSP_STAT_SUM_SQ);
+        iirdsp_filtfilt(&a, x, y1, N);
+        iirdsp_filtfilt_stats(&b, x, y2, N, &st);
+        sum_sq = 0.0;
+        for (int n = 0; n < N; n++) {
+            sum_sq += y1[n] * y1[n];
+        }
+        check(max_abs_diff(y1, y2, N) == 0.0 && fabs(st.sum_sq - sum_sq) < TOL * N,
+              "filtfilt with stats");
+
+        free(y1);
+        free(y2);
+    }
+
+    /* filtfilt against explicit forward / reverse / forward / reverse,
+     * once below and once above the streaming threshold */
+    const int ff_lengths[] = { N, IIRDSP_STREAM_THRESHOLD + 3 };
+    for (int t = 0; t < 2; t++) {
+        int M = ff_lengths[t];
+        iirdsp_real* in  = (iirdsp_real*)malloc(M * sizeof(iirdsp_real));
+        iirdsp_real* ref = (iirdsp_real*)malloc(M * sizeof(iirdsp_real));
+        iirdsp_real* out = (iirdsp_real*)malloc(M * sizeof(iirdsp_real));
+        iirdsp_filter_t f = designs[2];
+
+        for (int n = 0; n < M; n++) {
+            in[n] = x[n % N];
+        }
+
+        iirdsp_filter_init(&f);
+        iirdsp_process_buffer(&f, in, ref, M);
+        iirdsp_filter_init(&f);
+        for (int n = M - 1; n >= 0; n--) {
+            ref[n] = iirdsp_process_sample(&f, ref[n]);
+        }
+
+        iirdsp_filtfilt(&f, in, out, M);
+        check(max_abs_diff(ref, out, M) < TOL, "filtfilt matches explicit reversal");
+
+        free(in);
+        free(ref);
+        free(out);
+    }
+
+    free(x);
+
+    if (failures == 0) {
+        printf("✓ Test PASSED: all kernels match the reference\n");
+        return 0;
+    }
+    printf("✗ Test FAILED: %d mismatches\n", failures);
+    return -1;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file parallel.c
+ * @brief Impulse-length estimator and overlap-parallel filtering test
+ *
+ * Verifies that the L1 tail past iirdsp_impulse_length() is within the
+ * tolerance, and that chunked multi-threaded filtering stays within
+ * tol * max|x| of sequential filtering.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "iirdsp.h"
+#include "parallel.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-3  /* float round-off alone reaches ~1e-4 over long runs */
+#else
+#define TOL 1e-9
+#endif
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Brute-force L1 mass of the impulse response from sample W onwards */
+static double tail_mass(const iirdsp_filter_t* design, int W, int horizon)
+{
+    iirdsp_filter_t h = *design;
+    double mass = 0.0;
+
+    iirdsp_filter_init(&h);
+    for (int n = 0; n < horizon; n++) {
+        double v = fabs(iirdsp_process_sample(&h, n == 0 ? 1.0 : 0.0));
+        if (n >= W) {
+            mass += v;
+        }
+    }
+    return mass;
+}
+
+int main(void)
+{
+    const iirdsp_real fs = 500.0;
+    const int N = 100000;
+    iirdsp_filter_t designs[3];
+    const char* names[3] = { "band-pass 0.5-40", "low-pass 40", "high-pass 0.5" };
+
+    printf("iirdsp Parallel Filtering Test\n");
+    printf("==============================\n\n");
+
+    butter_bandpass_init(&designs[0], 4, 0.5, 40.0, fs);
+    butter_lowpass_init(&designs[1], 8, 40.0, fs);
+    butter_highpass_init(&designs[2], 2, 0.5, fs);
+
+    iirdsp_real* x  = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+    iirdsp_real* y1 = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+    iirdsp_real* y2 = (iirdsp_real*)malloc(N * sizeof(iirdsp_real));
+
+    srand(42);
+    for (int n = 0; n < N; n++) {
+        x[n] = 2.0 * (rand() / (iirdsp_real)RAND_MAX) - 1.0;
+    }
+
+    for (int d = 0; d < 3; d++) {
+        int W = iirdsp_impulse_length(&designs[d], TOL);
+        printf("%-18s radius %.6f  impulse length %d samples\n",
+               names[d], (double)iirdsp_pole_radius(&designs[d]), W);
+        check(W > 0, "impulse length found");
+        check(tail_mass(&designs[d], W, 4 * W + 1000) <= TOL, "tail past W within tolerance");
+        check(tail_mass(&designs[d], W > 0 ? W - 1 : 0, 4 * W + 1000) > TOL * 0.5,
+              "W is close to minimal");
+
+        iirdsp_filter_t seq = designs[d];
+        iirdsp_filter_t par = designs[d];
+        iirdsp_filter_init(&seq);
+        iirdsp_filter_init(&par);
+        iirdsp_process_buffer(&seq, x, y1, N);
+        check(iirdsp_process_buffer_parallel(&par, x, y2, N, 4, TOL) == 0, "parallel returns 0");
+
+        double err = 0.0;
+        for (int n = 0; n < N; n++) {
+            double e = fabs(y1[n] - y2[n]);
+            if (!(e <= err)) {
+                err = e;
+            }
+        }
+        printf("%-18s max parallel error %.3e (bound %.1e)\n", names[d], err, (double)TOL);
+        check(err <= TOL, "parallel error within bound");
+    }
+
+    /* An unstable section has no finite impulse length */
+    iirdsp_filter_t unstable = designs[1];
+    unstable.sections[0].a2 = 1.01;
+    check(iirdsp_impulse_length(&unstable, TOL) == -1, "unstable filter rejected");
+    check(iirdsp_process_buffer_parallel(&unstable, x, y2, N, 4, TOL) == -2,
+          "parallel rejects unstable filter");
+
+    /* A pole this close to 1 does not decay within the horizon cap */
+    iirdsp_filter_t slow = designs[0];
+    slow.num_sections = 1;
+    slow.sections[0].a1 = (iirdsp_real)-(1.0 - 1e-9);
+    slow.sections[0].a2 = 0.0;
+    check(iirdsp_impulse_length(&slow, TOL) == -1, "horizon cap reported as -1");
+
+    free(x);
+    free(y1);
+    free(y2);
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
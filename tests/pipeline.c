@@ -0,0 +1,144 @@
+/**
+ * @file pipeline.c
+ * @brief Pipeline compiler test against hand-chained iirdsp_* calls
+ *
+ * Checks stage merging, the fused loop against separate passes with
+ * intermediate buffers, block-split invariance across a decimation,
+ * in-place use, and error reporting.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "iirdsp.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-4
+#else
+#define TOL 1e-10
+#endif
+
+#define N 5000
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    static const char* ecg_chain =
+        "# ECG front end\n"
+        "fs 500\n"
+        "notch 50 30\n"
+        "bandpass 2 0.5 40   # order 2 -> 2 sections\n"
+        "baseline 0.7\n"
+        "decimate 2\n";
+    static iirdsp_real x[N];
+    static iirdsp_real a[N];
+    static iirdsp_real ref[N];
+    static iirdsp_real y[N];
+    iirdsp_pipeline_t p;
+    int err_line;
+    int n_ref;
+
+    printf("iirdsp Pipeline Test\n");
+    printf("====================\n\n");
+
+    for (int n = 0; n < N; n++) {
+        x[n] = sin(0.02 * n) + 0.5 * sin(2.0 * 3.14159265358979 * 50.0 * n / 500.0) +
+               0.3 * (n % 97) / 97.0;
+    }
+
+    /* Merging */
+    check(iirdsp_pipeline_compile(&p, "fs 500; notch 50 30; notch 60 30; lowpass 4 40", NULL) == 0,
+          "compile notch chain");
+    check(p.num_ops == 1 && p.ops[0].filter.num_sections == 4, "adjacent cascades merged");
+
+    check(iirdsp_pipeline_compile(&p, ecg_chain, &err_line) == 0 && err_line == 0, "compile ECG chain");
+    printf("  ECG chain: %d stages -> %d ops, %.0f Hz -> %.0f Hz\n",
+           p.num_stages, p.num_ops, (double)p.fs_in, (double)p.fs_out);
+    check(p.num_stages == 4 && p.num_ops == 4, "stage and op counts");
+    check(p.ops[0].kind == IIRDSP_OP_CASCADE && p.ops[0].filter.num_sections == 3, "notch + band-pass fused");
+    check(p.ops[1].kind == IIRDSP_OP_BASELINE, "baseline op");
+    check(p.ops[2].kind == IIRDSP_OP_CASCADE && p.ops[3].kind == IIRDSP_OP_DECIMATE, "anti-alias + decimate");
+    check(p.fs_out == 250.0 && p.decimation == 2, "output rate");
+
+    /* Reference: separate passes with intermediate buffers */
+    {
+        iirdsp_filter_t notch, bp, base, aa;
+        notch_filter_init(&notch, 50.0, 30.0, 500.0);
+        butter_bandpass_init(&bp, 2, 0.5, 40.0, 500.0);
+        butter_lowpass_init(&base, 2, 0.7, 500.0);
+        butter_lowpass_init(&aa, IIRDSP_DECIMATE_ORDER, 0.4 * 500.0 / 2, 500.0);
+
+        iirdsp_process_buffer(&notch, x, a, N);
+        iirdsp_process_buffer(&bp, a, a, N);
+        iirdsp_process_buffer(&base, a, ref, N);
+        for (int n = 0; n < N; n++) {
+            a[n] -= ref[n];
+        }
+        iirdsp_process_buffer(&aa, a, a, N);
+        n_ref = 0;
+        for (int n = 0; n < N; n += 2) {
+            ref[n_ref++] = a[n];
+        }
+    }
+
+    /* Fused, in uneven blocks */
+    {
+        int got = 0;
+        int ok = 1;
+
+        for (int n = 0; n < N;) {
+            int len = 1 + (n * 13) % 211;
+            if (len > N - n) {
+                len = N - n;
+            }
+            check(iirdsp_pipeline_max_output(&p, len) >= (len + 1) / 2, "max_output bound");
+            got += iirdsp_pipeline_process(&p, &x[n], len, &y[got]);
+            n += len;
+        }
+        for (int i = 0; i < n_ref; i++) {
+            ok &= fabs(y[i] - ref[i]) <= TOL;
+        }
+        check(got == n_ref && ok, "fused loop matches chained passes");
+    }
+
+    /* In place, after reset */
+    {
+        int got;
+        int ok = 1;
+
+        iirdsp_pipeline_reset(&p);
+        for (int n = 0; n < N; n++) {
+            a[n] = x[n];
+        }
+        got = iirdsp_pipeline_process(&p, a, N, a);
+        for (int i = 0; i < n_ref; i++) {
+            ok &= fabs(a[i] - ref[i]) <= TOL;
+        }
+        check(got == n_ref && ok, "in-place");
+    }
+
+    /* Errors */
+    check(iirdsp_pipeline_compile(&p, "notch 50 30\n", &err_line) == -1 && err_line == 1, "fs first");
+    check(iirdsp_pipeline_compile(&p, "fs 500\nnotch 50\n", &err_line) == -1 && err_line == 2, "argument count");
+    check(iirdsp_pipeline_compile(&p, "fs 500\n\nwarp 3\n", &err_line) == -1 && err_line == 3, "unknown stage");
+    check(iirdsp_pipeline_compile(&p, "fs 500\nlowpass 4 300\n", &err_line) == -2 && err_line == 2, "design failure");
+    check(iirdsp_pipeline_compile(&p, "fs 500\nbaseline 1;baseline 1;baseline 1;baseline 1;"
+                                      "baseline 1;baseline 1;baseline 1;baseline 1;baseline 1;"
+                                      "baseline 1;baseline 1;baseline 1;baseline 1;baseline 1;"
+                                      "baseline 1;baseline 1;baseline 1\n", &err_line) == -3, "op limit");
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
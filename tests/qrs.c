@@ -0,0 +1,168 @@
+/**
+ * @file qrs.c
+ * @brief Streaming QRS detector test on a synthetic ECG
+ *
+ * Beats are narrow Gaussian R waves with a broader T wave, on top of
+ * baseline wander, 50 Hz interference and noise. After the 2 s training
+ * period every beat must be found within 20 ms, with no false detections;
+ * block size must not change the result, and the SIMD bank must agree
+ * with the single-channel detector.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "iirdsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FS 500.0
+#define SECONDS 20
+#define N 10000  /* FS * SECONDS */
+#define MAX_BEATS 64
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* Synthetic ECG with R peaks every rr seconds starting at offset; returns beat count */
+static int make_ecg(iirdsp_real* x, iirdsp_real rr, iirdsp_real offset, iirdsp_real amp, long* beats)
+{
+    int num_beats = 0;
+
+    for (int n = 0; n < N; n++) {
+        iirdsp_real t = n / FS;
+        x[n] = 0.3 * sin(2.0 * M_PI * 0.2 * t) + 0.05 * sin(2.0 * M_PI * 50.0 * t)
+             + 0.02 * (rand() / (iirdsp_real)RAND_MAX - 0.5);
+    }
+    for (iirdsp_real tb = offset; tb < SECONDS - 0.5; tb += rr) {
+        beats[num_beats++] = (long)(tb * FS + 0.5);
+        for (int n = 0; n < N; n++) {
+            iirdsp_real dt = n / FS - tb;
+            x[n] += amp * exp(-dt * dt / (2.0 * 0.010 * 0.010));
+            x[n] += 0.25 * amp * exp(-(dt - 0.25) * (dt - 0.25) / (2.0 * 0.040 * 0.040));
+        }
+    }
+    return num_beats;
+}
+
+/* Every beat after training must be matched within tol samples, and vice versa */
+static void score(const char* name, const long* beats, int num_beats,
+                  const long* found, int num_found, long tol)
+{
+    const long settled = (long)(2.2 * FS);
+    int expected = 0, matched = 0, reported = 0;
+    char what[96];
+
+    for (int j = 0; j < num_found; j++) {
+        reported += found[j] >= settled - tol;
+    }
+    for (int i = 0; i < num_beats; i++) {
+        if (beats[i] < settled) {
+            continue;
+        }
+        expected++;
+        for (int j = 0; j < num_found; j++) {
+            if (labs(found[j] - beats[i]) <= tol) {
+                matched++;
+                break;
+            }
+        }
+    }
+    printf("%-22s %d detections, %d of %d beats matched\n", name, reported, matched, expected);
+    snprintf(what, sizeof(what), "%s finds every beat", name);
+    check(matched == expected, what);
+    snprintf(what, sizeof(what), "%s has no false detections", name);
+    check(reported == matched, what);
+}
+
+int main(void)
+{
+    static iirdsp_real x[3][N];
+    static iirdsp_real interleaved[3 * N];
+    long beats[3][MAX_BEATS];
+    int num_beats[3];
+    const iirdsp_real rr[3] = { 0.8, 0.6, 1.1 };
+    const iirdsp_real amp[3] = { 1.0, 0.4, 2.5 };
+    long found[3][MAX_BEATS];
+    int num_found[3];
+    iirdsp_qrs_t q;
+
+    printf("iirdsp QRS Detector Test\n");
+    printf("========================\n\n");
+
+    srand(7);
+    for (int c = 0; c < 3; c++) {
+        num_beats[c] = make_ecg(x[c], rr[c], 0.3 + 0.1 * c, amp[c], beats[c]);
+        for (int n = 0; n < N; n++) {
+            interleaved[n * 3 + c] = x[c][n];
+        }
+    }
+
+    /* Single channel, whole record and in small blocks */
+    for (int c = 0; c < 3; c++) {
+        char name[32];
+        long blocked[MAX_BEATS];
+        int num_blocked = 0;
+
+        check(iirdsp_qrs_init(&q, FS) == 0, "init");
+        num_found[c] = iirdsp_qrs_process(&q, x[c], N, found[c], MAX_BEATS);
+        snprintf(name, sizeof(name), "channel %d (%.0f bpm)", c, 60.0 / rr[c]);
+        score(name, beats[c], num_beats[c], found[c], num_found[c], (long)(0.020 * FS));
+
+        iirdsp_qrs_init(&q, FS);
+        for (int pos = 0; pos < N; pos += 37) {
+            int len = N - pos < 37 ? N - pos : 37;
+            num_blocked += iirdsp_qrs_process(&q, x[c] + pos, len,
+                                              blocked + num_blocked, MAX_BEATS - num_blocked);
+        }
+        int same = num_blocked == num_found[c];
+        for (int i = 0; same && i < num_blocked; i++) {
+            same = blocked[i] == found[c][i];
+        }
+        check(same, "block size does not change detections");
+    }
+
+    /* Multi-channel bank on interleaved input */
+    {
+        iirdsp_qrs_bank_t bank;
+        iirdsp_qrs_peak_t peaks[3 * MAX_BEATS];
+        int total;
+
+        check(iirdsp_qrs_bank_init(&bank, 3, FS) == 0, "bank init");
+        total = iirdsp_qrs_bank_process(&bank, interleaved, N, IIRDSP_LAYOUT_INTERLEAVED,
+                                        peaks, 3 * MAX_BEATS);
+        for (int c = 0; c < 3; c++) {
+            long mine[MAX_BEATS];
+            int count = 0;
+            for (int i = 0; i < total; i++) {
+                if (peaks[i].channel == c && count < MAX_BEATS) {
+                    mine[count++] = peaks[i].index;
+                }
+            }
+            int same = count == num_found[c];
+            for (int i = 0; same && i < count; i++) {
+                same = mine[i] == found[c][i];
+            }
+            check(same, "bank matches single-channel detector");
+        }
+        printf("Bank (3 channels):     %d detections\n", total);
+    }
+
+    check(iirdsp_qrs_init(&q, 10000.0) == -1, "rejects unsupported sampling rate");
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
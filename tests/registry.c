@@ -0,0 +1,221 @@
+/**
+ * @file registry.c
+ * @brief Shared-memory coefficient registry test
+ *
+ * Forked workers race to insert the same specs into one segment; every
+ * worker must get coefficients identical to a private design, each spec
+ * must be designed exactly once, and a read-only mapping must see them
+ * all without being able to insert. A worker killed while it inserts must
+ * not leave entries that block the others.
+ */
+
+#include <stdio.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "iirdsp.h"
+#include "registry.h"
+
+#define WORKERS 4
+#define SPECS 12
+#define KILLED_SPECS 1024
+#define KILL_ROUNDS 16
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static iirdsp_spec_t spec_at(int k)
+{
+    iirdsp_spec_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.kind = k % 4;
+    s.order = 2 + k % 3;
+    s.f1 = s.kind == IIRDSP_SPEC_NOTCH ? 50.0 : 5.0 + k;
+    s.f2 = s.kind == IIRDSP_SPEC_NOTCH ? 20.0 + k : s.kind == IIRDSP_SPEC_BANDPASS ? 40.0 + k : 0.0;
+    s.fs = 500.0;
+    return s;
+}
+
+static int same_coeffs(const iirdsp_filter_t* a, const iirdsp_filter_t* b)
+{
+    if (a->num_sections != b->num_sections) {
+        return 0;
+    }
+    for (int i = 0; i < a->num_sections; i++) {
+        const iirdsp_biquad_t* s = &a->sections[i];
+        const iirdsp_biquad_t* t = &b->sections[i];
+        if (s->b0 != t->b0 || s->b1 != t->b1 || s->b2 != t->b2 || s->a1 != t->a1 || s->a2 != t->a2 ||
+            s->z1 != 0.0 || s->z2 != 0.0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Worker: open the segment and fetch every spec, starting at a different one */
+static int worker(const char* name, int id)
+{
+    iirdsp_registry_t* r = iirdsp_registry_open(name, 1);
+    int ok = r != NULL;
+
+    for (int n = 0; n < SPECS && ok; n++) {
+        iirdsp_spec_t s = spec_at((n + id * 5) % SPECS);
+        const iirdsp_filter_t* shared = iirdsp_registry_get(r, &s);
+        iirdsp_filter_t mine;
+
+        iirdsp_spec_design(&s, &mine);
+        ok = shared != NULL && same_coeffs(shared, &mine);
+    }
+    iirdsp_registry_close(r);
+    return ok ? 0 : 1;
+}
+
+/* Spec for the killed-worker test: band-pass designs, all different */
+static iirdsp_spec_t killed_spec_at(int k)
+{
+    iirdsp_spec_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.kind = IIRDSP_SPEC_BANDPASS;
+    s.order = 8;
+    s.f1 = 1.0 + 0.001 * k;
+    s.f2 = 100.0;
+    s.fs = 1000.0;
+    return s;
+}
+
+int main(void)
+{
+    char name[64];
+    iirdsp_registry_t* r;
+    iirdsp_registry_t* ro;
+    pid_t pids[WORKERS];
+    int ok = 1;
+
+    printf("iirdsp Shared Coefficient Registry Test\n");
+    printf("=======================================\n\n");
+
+    snprintf(name, sizeof(name), "/iirdsp_test_%d", (int)getpid());
+    iirdsp_registry_unlink(name);
+    r = iirdsp_registry_create(name, SPECS + 1);
+    check(r != NULL, "create");
+    if (r == NULL) {
+        return 1;
+    }
+    check(iirdsp_registry_create(name, 4) == NULL, "create refuses an existing segment");
+
+    printf("Concurrent workers\n");
+    for (int w = 0; w < WORKERS; w++) {
+        pids[w] = fork();
+        if (pids[w] == 0) {
+            _exit(worker(name, w));
+        }
+    }
+    for (int w = 0; w < WORKERS; w++) {
+        int status = 1;
+        waitpid(pids[w], &status, 0);
+        ok &= WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    check(ok, "every worker got correct coefficients");
+    check(iirdsp_registry_count(r) == SPECS, "each spec designed once");
+
+    printf("Read-only mapping\n");
+    ro = iirdsp_registry_open(name, 0);
+    check(ro != NULL, "open read-only");
+    if (ro != NULL) {
+        iirdsp_spec_t s = spec_at(3);
+        iirdsp_spec_t missing = spec_at(0);
+        const iirdsp_filter_t* a = iirdsp_registry_lookup(ro, &s);
+        const iirdsp_filter_t* b = iirdsp_registry_lookup(r, &s);
+
+        check(a != NULL && b != NULL && same_coeffs(a, b), "read-only mapping sees published sets");
+        missing.fs = 360.0;
+        check(iirdsp_registry_get(ro, &missing) == NULL, "read-only mapping cannot insert");
+
+        /* Fields a design ignores do not change the key */
+        s = spec_at(3);
+        s.order = 9;
+        check(s.kind == IIRDSP_SPEC_NOTCH && iirdsp_registry_lookup(ro, &s) == a, "notch order ignored");
+        iirdsp_registry_close(ro);
+    }
+
+    printf("Capacity\n");
+    {
+        iirdsp_spec_t extra = spec_at(0);
+
+        extra.fs = 360.0;
+        check(iirdsp_registry_get(r, &extra) != NULL, "fill to capacity");
+        extra.fs = 250.0;
+        check(iirdsp_registry_get(r, &extra) == NULL, "full registry rejects new specs");
+        extra = spec_at(1);
+        check(iirdsp_registry_get(r, &extra) != NULL, "existing specs still found when full");
+        extra.kind = 17;
+        extra.fs = 1.0;
+        check(iirdsp_spec_design(&extra, NULL) == -1, "unknown kind");
+    }
+
+    printf("Killed workers\n");
+    ok = 1;
+    for (int round = 0; round < KILL_ROUNDS; round++) {
+        char killed_name[64];
+        iirdsp_registry_t* k;
+        pid_t pid;
+        int status;
+
+        snprintf(killed_name, sizeof(killed_name), "/iirdsp_test_killed_%d", (int)getpid());
+        iirdsp_registry_unlink(killed_name);
+        k = iirdsp_registry_create(killed_name, KILLED_SPECS);
+        if (k == NULL) {
+            ok = 0;
+            break;
+        }
+        pid = fork();
+        if (pid == 0) {
+            iirdsp_registry_t* c = iirdsp_registry_open(killed_name, 1);
+            for (int i = 0; c != NULL; i = (i + 1) % KILLED_SPECS) {
+                iirdsp_spec_t sp = killed_spec_at(i);
+                iirdsp_registry_get(c, &sp);
+            }
+            _exit(1);
+        }
+        /* Let it insert some, then kill it wherever it is; reap it so its
+           pid no longer exists */
+        while (iirdsp_registry_count(k) < 16 * (round + 1)) {
+            usleep(10);
+        }
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+
+        for (int i = 0; i < KILLED_SPECS; i++) {
+            iirdsp_spec_t sp = killed_spec_at(i);
+            const iirdsp_filter_t* shared = iirdsp_registry_get(k, &sp);
+            iirdsp_filter_t mine;
+
+            iirdsp_spec_design(&sp, &mine);
+            ok &= shared != NULL && same_coeffs(shared, &mine);
+        }
+        iirdsp_registry_close(k);
+        iirdsp_registry_unlink(killed_name);
+    }
+    check(ok, "every spec available after a worker died mid-insert");
+
+    iirdsp_registry_close(r);
+    check(iirdsp_registry_unlink(name) == 0, "unlink");
+    check(iirdsp_registry_open(name, 0) == NULL, "unlinked segment is gone");
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
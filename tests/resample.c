@@ -0,0 +1,147 @@
+/**
+ * @file resample.c
+ * @brief Rational resampler test
+ *
+ * Covers the archive rates (250, 360, 1000 Hz to 500 Hz): output length,
+ * tone amplitude through the passband, alias rejection when decimating,
+ * block-split invariance, and the fused post-filter against a separate
+ * iirdsp_process_buffer() pass.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "iirdsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-5
+#else
+#define TOL 1e-12
+#endif
+
+#define SECONDS 4
+#define MAX_IN (1000 * SECONDS)
+#define MAX_OUT (500 * SECONDS + 1)
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/* RMS over the second half, past the filter transient */
+static iirdsp_real tail_rms(const iirdsp_real* y, int n)
+{
+    iirdsp_real sum = 0.0;
+    for (int i = n / 2; i < n; i++) {
+        sum += y[i] * y[i];
+    }
+    return sqrt(sum / (n - n / 2));
+}
+
+int main(void)
+{
+    static const int rates[3] = { 250, 360, 1000 };
+    static iirdsp_real x[MAX_IN];
+    static iirdsp_real y[MAX_OUT];
+    static iirdsp_real y2[MAX_OUT];
+    static iirdsp_real ref[MAX_OUT];
+    const int fs_out = 500;
+
+    printf("iirdsp Resampler Test\n");
+    printf("=====================\n\n");
+
+    for (int k = 0; k < 3; k++) {
+        const int fs_in = rates[k];
+        const int n_in = fs_in * SECONDS;
+        iirdsp_resampler_t r;
+        iirdsp_real rms;
+        int n_out;
+
+        /* 10 Hz tone, amplitude 1: RMS 1/sqrt(2) at any rate */
+        for (int n = 0; n < n_in; n++) {
+            x[n] = sin(2.0 * M_PI * 10.0 * n / fs_in);
+        }
+        check(iirdsp_resampler_init(&r, fs_in, fs_out, 8, 0.0, NULL) == 0, "init");
+        n_out = iirdsp_resampler_process(&r, x, n_in, y);
+        rms = tail_rms(y, n_out);
+        printf("  %4d -> %d Hz: L/M = %d/%d, %d samples, tone RMS %.4f\n",
+               fs_in, fs_out, r.up, r.down, n_out, (double)rms);
+        check(n_out == fs_out * SECONDS, "output length");
+        check(n_out <= iirdsp_resampler_max_output(&r, n_in), "max_output bound");
+        check(fabs(rms - sqrt(0.5)) < 0.01, "passband tone amplitude");
+
+        /* Same input in uneven blocks */
+        {
+            int got = 0;
+            int ok = 1;
+
+            iirdsp_resampler_reset(&r);
+            for (int n = 0; n < n_in;) {
+                int len = 1 + (n * 7) % 113;
+                if (len > n_in - n) {
+                    len = n_in - n;
+                }
+                got += iirdsp_resampler_process(&r, &x[n], len, &y2[got]);
+                n += len;
+            }
+            for (int i = 0; i < n_out && ok; i++) {
+                ok = fabs(y2[i] - y[i]) <= TOL;
+            }
+            check(got == n_out && ok, "block-split invariance");
+        }
+
+        /* Fused post-filter == resample, then filter */
+        {
+            iirdsp_filter_t bp;
+            int ok = 1;
+            int got;
+
+            butter_bandpass_init(&bp, 2, 0.5, 40.0, (iirdsp_real)fs_out);
+            iirdsp_resampler_init(&r, fs_in, fs_out, 8, 0.0, &bp);
+            got = iirdsp_resampler_process(&r, x, n_in, y2);
+            iirdsp_process_buffer(&bp, y, ref, n_out);
+            for (int i = 0; i < n_out && ok; i++) {
+                ok = fabs(y2[i] - ref[i]) <= TOL;
+            }
+            check(got == n_out && ok, "fused post-filter");
+        }
+    }
+
+    /* 1000 -> 500 Hz: a 400 Hz tone would alias to 100 Hz */
+    {
+        iirdsp_resampler_t r;
+        int n_out;
+
+        for (int n = 0; n < MAX_IN; n++) {
+            x[n] = sin(2.0 * M_PI * 400.0 * n / 1000.0);
+        }
+        iirdsp_resampler_init(&r, 1000, 500, 8, 0.0, NULL);
+        n_out = iirdsp_resampler_process(&r, x, MAX_IN, y);
+        printf("  400 Hz alias at 500 Hz: RMS %.2e\n", (double)tail_rms(y, n_out));
+        check(tail_rms(y, n_out) < 0.01, "alias rejection");
+    }
+
+    /* Argument checks */
+    {
+        iirdsp_resampler_t r;
+        check(iirdsp_resampler_init(&r, 0, 500, 8, 0.0, NULL) == -1, "zero rate rejected");
+        check(iirdsp_resampler_init(&r, 360, 500, 0, 0.0, NULL) == -1, "missing anti-alias rejected");
+        check(iirdsp_resampler_init(&r, 360, 500, 8, 200.0, NULL) == -1, "cutoff above Nyquist rejected");
+        check(iirdsp_resampler_init(&r, 500, 500, 0, 0.0, NULL) == 0, "pass-through allowed");
+    }
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
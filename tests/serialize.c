@@ -0,0 +1,191 @@
+/**
+ * @file serialize.c
+ * @brief Filter snapshot round-trip and format test
+ *
+ * A filter restored from a snapshot must continue bit-identically to the
+ * original. Also checks the little-endian value layout, reading the
+ * other precision, state-only snapshots, bank snapshots and rejection of
+ * malformed input.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "iirdsp.h"
+
+#define SAMPLES 300
+#define BANK 16
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+static iirdsp_real input(int n)
+{
+    return sin(0.07 * n) + 0.5 * cos(0.31 * n) + 0.2;
+}
+
+/* Run both filters on the same input and compare outputs exactly */
+static int continues_identically(iirdsp_filter_t* a, iirdsp_filter_t* b)
+{
+    iirdsp_real x[SAMPLES];
+    iirdsp_real ya[SAMPLES];
+    iirdsp_real yb[SAMPLES];
+
+    for (int n = 0; n < SAMPLES; n++) {
+        x[n] = input(SAMPLES + n);
+    }
+    iirdsp_process_buffer(a, x, ya, SAMPLES);
+    iirdsp_process_buffer(b, x, yb, SAMPLES);
+    return memcmp(ya, yb, sizeof(ya)) == 0;
+}
+
+static void warm_up(iirdsp_filter_t* f)
+{
+    iirdsp_real x[SAMPLES];
+
+    for (int n = 0; n < SAMPLES; n++) {
+        x[n] = input(n);
+    }
+    iirdsp_process_buffer(f, x, x, SAMPLES);
+}
+
+static void test_single(void)
+{
+    unsigned char buf[1024];
+    iirdsp_filter_t f;
+    iirdsp_filter_t g;
+    iirdsp_filter_t saved;
+    long n;
+
+    printf("Single filter\n");
+    butter_bandpass_init(&f, 4, 0.5, 40.0, 500.0);
+    warm_up(&f);
+
+    n = iirdsp_serialize(&f, IIRDSP_SERIAL_ALL, buf, sizeof(buf));
+    check(n == 8 + 7L * (long)sizeof(iirdsp_real) * f.num_sections, "snapshot size");
+    check(n == iirdsp_serialized_size(&f, IIRDSP_SERIAL_ALL), "size query matches");
+    check(memcmp(buf, "IIRS", 4) == 0 && buf[4] == IIRDSP_SERIAL_VERSION, "header");
+
+    memset(&g, 0, sizeof(g));
+    check(iirdsp_deserialize(&g, buf, (size_t)n) == n, "deserialize consumes the snapshot");
+    check(continues_identically(&f, &g), "restored filter continues bit-identically");
+
+    /* State only: keeps the destination's coefficients */
+    n = iirdsp_serialize(&f, IIRDSP_SERIAL_STATE, buf, sizeof(buf));
+    check(n == 8 + 2L * (long)sizeof(iirdsp_real) * f.num_sections, "state-only size");
+    butter_bandpass_init(&g, 4, 0.5, 40.0, 500.0);
+    check(iirdsp_deserialize(&g, buf, (size_t)n) == n, "state-only restore");
+    check(continues_identically(&f, &g), "state-only restore continues bit-identically");
+    butter_lowpass_init(&g, 2, 40.0, 500.0);
+    saved = g;
+    check(iirdsp_deserialize(&g, buf, (size_t)n) == -3, "state-only section mismatch");
+    check(memcmp(&g, &saved, sizeof(g)) == 0, "filter unchanged on error");
+
+    /* Coefficients only: fresh state */
+    n = iirdsp_serialize(&f, IIRDSP_SERIAL_COEFFS, buf, sizeof(buf));
+    check(iirdsp_deserialize(&g, buf, (size_t)n) == n && g.num_sections == f.num_sections &&
+          g.sections[0].b0 == f.sections[0].b0 && g.sections[0].z1 == 0.0, "coefficient-only restore");
+
+    /* Malformed input */
+    n = iirdsp_serialize(&f, IIRDSP_SERIAL_ALL, buf, sizeof(buf));
+    check(iirdsp_serialize(&f, IIRDSP_SERIAL_ALL, buf, (size_t)n - 1) == -2, "small buffer");
+    check(iirdsp_serialize(&f, 0, buf, sizeof(buf)) == -1, "no parts rejected");
+    check(iirdsp_deserialize(&g, buf, (size_t)n - 1) == -2, "truncated");
+    check(iirdsp_deserialize(&g, buf, 3) == -2, "truncated header");
+    buf[4] = IIRDSP_SERIAL_VERSION + 1;
+    check(iirdsp_deserialize(&g, buf, (size_t)n) == -1, "future version rejected");
+    buf[4] = IIRDSP_SERIAL_VERSION;
+    buf[0] = 'X';
+    check(iirdsp_deserialize(&g, buf, (size_t)n) == -1, "bad magic rejected");
+}
+
+static void test_layout(void)
+{
+    /* One section, b0 = 1, all else 0, in both precisions */
+    static const unsigned char f64[8 + 7 * 8] = {
+        'I', 'I', 'R', 'S', 1, 0x3, 1, 0,
+        0, 0, 0, 0, 0, 0, 0xF0, 0x3F
+    };
+    static const unsigned char f32[8 + 7 * 4] = {
+        'I', 'I', 'R', 'S', 1, 0x7, 1, 0,
+        0, 0, 0x80, 0x3F
+    };
+    unsigned char buf[128];
+    iirdsp_filter_t f;
+    long n;
+
+    printf("Byte layout\n");
+    check(iirdsp_deserialize(&f, f64, sizeof(f64)) == (long)sizeof(f64) && f.num_sections == 1 &&
+          f.sections[0].b0 == 1.0 && f.sections[0].a1 == 0.0, "read double snapshot");
+    check(iirdsp_deserialize(&f, f32, sizeof(f32)) == (long)sizeof(f32) && f.num_sections == 1 &&
+          f.sections[0].b0 == 1.0 && f.sections[0].z2 == 0.0, "read float snapshot");
+
+    n = iirdsp_serialize(&f, IIRDSP_SERIAL_ALL, buf, sizeof(buf));
+#ifdef IIRDSP_USE_FLOAT
+    check(n == (long)sizeof(f32) && memcmp(buf, f32, sizeof(f32)) == 0, "float build writes little-endian floats");
+#else
+    check(n == (long)sizeof(f64) && memcmp(buf, f64, sizeof(f64)) == 0, "double build writes little-endian doubles");
+#endif
+}
+
+static void test_bank(void)
+{
+    static unsigned char buf[BANK * 8 * 7 * 8 + 64];
+    iirdsp_filter_t bank[BANK];
+    iirdsp_filter_t restored[BANK];
+    iirdsp_filter_t saved[BANK];
+    int count = 0;
+    int ok = 1;
+    long n;
+
+    printf("Filter bank\n");
+    for (int k = 0; k < BANK; k++) {
+        if (k % 3 == 0) {
+            butter_lowpass_init(&bank[k], 2 + k % 5, 20.0 + k, 500.0);
+        } else if (k % 3 == 1) {
+            butter_highpass_init(&bank[k], 2, 0.5 + 0.1 * k, 500.0);
+        } else {
+            notch_filter_init(&bank[k], 50.0, 30.0, 500.0);
+        }
+        warm_up(&bank[k]);
+    }
+
+    n = iirdsp_serialize_bank(bank, BANK, IIRDSP_SERIAL_ALL, buf, sizeof(buf));
+    check(n > 0 && n == iirdsp_bank_serialized_size(bank, BANK, IIRDSP_SERIAL_ALL), "bank size");
+    memset(restored, 0, sizeof(restored));
+    check(iirdsp_deserialize_bank(restored, BANK, buf, (size_t)n, &count) == n && count == BANK, "bank restore");
+    for (int k = 0; k < BANK; k++) {
+        ok &= continues_identically(&bank[k], &restored[k]);
+    }
+    check(ok, "every restored filter continues bit-identically");
+
+    memcpy(saved, restored, sizeof(saved));
+    check(iirdsp_deserialize_bank(restored, BANK - 1, buf, (size_t)n, &count) == -3, "bank too large");
+    check(iirdsp_deserialize_bank(restored, BANK, buf, (size_t)n - 1, &count) == -2, "truncated bank");
+    check(memcmp(saved, restored, sizeof(saved)) == 0, "bank unchanged on error");
+    check(iirdsp_deserialize(&restored[0], buf, (size_t)n) == -1, "bank is not a single snapshot");
+}
+
+int main(void)
+{
+    printf("iirdsp Serialization Test\n");
+    printf("=========================\n\n");
+
+    test_single();
+    test_layout();
+    test_bank();
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
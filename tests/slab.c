@@ -0,0 +1,277 @@
+/**
+ * @file slab.c
+ * @brief Slab allocator test: alignment, reuse, live iteration, threads
+ *
+ * Checks that objects are cache-line aligned and never overlap, that
+ * iirdsp_slab_foreach() visits exactly the live objects, that large
+ * objects get larger pages, that concurrent alloc/free from several
+ * threads keeps the live count consistent, and that more slabs than
+ * PTHREAD_KEYS_MAX can be used at once by threads that outlive some of
+ * them.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "slab.h"
+
+#define COUNT 5000
+#define THREADS 4
+#define ROUNDS 20000
+#define MANY_SLABS 1500
+
+static int failures = 0;
+
+static void check(int ok, const char* what)
+{
+    if (!ok) {
+        printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+typedef struct {
+    long tag;
+    double state[5];
+} object_t;
+
+static void* objs[COUNT];
+
+static void visit_sum(void* user, void* obj)
+{
+    *(long*)user += ((object_t*)obj)->tag;
+}
+
+static void test_alloc_free(void)
+{
+    iirdsp_slab_t* s = iirdsp_slab_create(sizeof(object_t));
+    long expect = 0;
+    long sum = 0;
+    int ok = 1;
+
+    printf("Alloc/free and iteration\n");
+    check(s != NULL, "create");
+    if (s == NULL) {
+        return;
+    }
+    check(iirdsp_slab_object_size(s) == IIRDSP_CACHE_LINE, "object padded to one cache line");
+    check(iirdsp_slab_create(0) == NULL, "zero size rejected");
+
+    for (int i = 0; i < COUNT; i++) {
+        objs[i] = iirdsp_slab_alloc(s);
+        ok &= objs[i] != NULL && (uintptr_t)objs[i] % IIRDSP_CACHE_LINE == 0;
+        if (objs[i] != NULL) {
+            memset(objs[i], 0, sizeof(object_t));
+            ((object_t*)objs[i])->tag = i;
+        }
+    }
+    check(ok, "objects allocated and cache-line aligned");
+
+    /* Writes through each object must not disturb any other */
+    for (int i = 0; i < COUNT; i++) {
+        ok &= ((object_t*)objs[i])->tag == i;
+    }
+    check(ok, "objects do not overlap");
+
+    /* Free every third object, then iterate */
+    for (int i = 0; i < COUNT; i += 3) {
+        iirdsp_slab_free(s, objs[i]);
+        objs[i] = NULL;
+    }
+    for (int i = 0; i < COUNT; i++) {
+        if (objs[i] != NULL) {
+            expect += i;
+        }
+    }
+    check(iirdsp_slab_live(s) == COUNT - (COUNT + 2) / 3, "live count after frees");
+    check(iirdsp_slab_foreach(s, visit_sum, &sum) == iirdsp_slab_live(s), "foreach visits live objects");
+    check(sum == expect, "foreach visits exactly the live objects");
+
+    /* Freed objects are reused before new pages */
+    for (int i = 0; i < COUNT; i += 3) {
+        objs[i] = iirdsp_slab_alloc(s);
+        ((object_t*)objs[i])->tag = i;
+    }
+    check(iirdsp_slab_live(s) == COUNT, "live count after realloc");
+    for (int i = 0; i < COUNT; i++) {
+        iirdsp_slab_free(s, objs[i]);
+    }
+    check(iirdsp_slab_live(s) == 0, "all freed");
+    sum = 0;
+    check(iirdsp_slab_foreach(s, visit_sum, &sum) == 0, "foreach on empty slab");
+    iirdsp_slab_destroy(s);
+}
+
+static void test_large_objects(void)
+{
+    size_t size = IIRDSP_SLAB_PAGE_BYTES / 3;
+    iirdsp_slab_t* s = iirdsp_slab_create(size);
+    char* p[20];
+    int ok = 1;
+
+    printf("Large objects\n");
+    check(s != NULL, "create");
+    if (s == NULL) {
+        return;
+    }
+    for (int i = 0; i < 20; i++) {
+        p[i] = (char*)iirdsp_slab_alloc(s);
+        ok &= p[i] != NULL;
+        if (p[i] != NULL) {
+            memset(p[i], i, size);
+        }
+    }
+    for (int i = 0; i < 20 && ok; i++) {
+        ok &= p[i][0] == i && p[i][size - 1] == i;
+    }
+    check(ok, "objects larger than a default page");
+    check(iirdsp_slab_live(s) == 20, "live count");
+    for (int i = 0; i < 20; i++) {
+        iirdsp_slab_free(s, p[i]);
+    }
+    iirdsp_slab_destroy(s);
+}
+
+typedef struct {
+    iirdsp_slab_t* slab;
+    int id;
+    int ok;
+} worker_t;
+
+static void* worker(void* arg)
+{
+    worker_t* w = (worker_t*)arg;
+    void* held[64] = { 0 };
+    unsigned rng = 7u + (unsigned)w->id;
+
+    w->ok = 1;
+    for (int r = 0; r < ROUNDS; r++) {
+        int k;
+
+        rng = rng * 1103515245u + 12345u;
+        k = (int)((rng >> 8) % 64);
+        if (held[k] == NULL) {
+            held[k] = iirdsp_slab_alloc(w->slab);
+            if (held[k] == NULL) {
+                w->ok = 0;
+                break;
+            }
+            ((object_t*)held[k])->tag = w->id * 64 + k;
+        } else {
+            w->ok &= ((object_t*)held[k])->tag == w->id * 64 + k;
+            iirdsp_slab_free(w->slab, held[k]);
+            held[k] = NULL;
+        }
+    }
+    /* Leave the odd slots live for the main thread to count */
+    for (int k = 0; k < 64; k++) {
+        if (held[k] != NULL && k % 2 == 0) {
+            iirdsp_slab_free(w->slab, held[k]);
+        }
+    }
+    return NULL;
+}
+
+static void visit_count_odd(void* user, void* obj)
+{
+    *(long*)user += ((object_t*)obj)->tag % 2;
+}
+
+static void test_threads(void)
+{
+    iirdsp_slab_t* s = iirdsp_slab_create(sizeof(object_t));
+    pthread_t threads[THREADS];
+    worker_t workers[THREADS];
+    long odd = 0;
+    long live;
+    int ok = 1;
+
+    printf("Concurrent alloc/free\n");
+    for (int t = 0; t < THREADS; t++) {
+        workers[t].slab = s;
+        workers[t].id = t;
+        pthread_create(&threads[t], NULL, worker, &workers[t]);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        ok &= workers[t].ok;
+    }
+    check(ok, "objects keep their contents while held");
+
+    live = iirdsp_slab_live(s);
+    check(iirdsp_slab_foreach(s, visit_count_odd, &odd) == live, "foreach matches live count");
+    check(odd == live, "only objects left live by the workers remain");
+    iirdsp_slab_destroy(s);
+}
+
+static iirdsp_slab_t* many[MANY_SLABS];
+
+/* Allocate and free one object from every slab that is still alive */
+static void* use_many(void* arg)
+{
+    int* ok = (int*)arg;
+
+    for (int i = 0; i < MANY_SLABS; i++) {
+        if (many[i] != NULL) {
+            object_t* o = (object_t*)iirdsp_slab_alloc(many[i]);
+            *ok &= o != NULL;
+            iirdsp_slab_free(many[i], o);
+        }
+    }
+    return NULL;
+}
+
+static void test_many_slabs(void)
+{
+    pthread_t thread;
+    int ok = 1;
+
+    printf("More slabs than thread-specific keys\n");
+    for (int i = 0; i < MANY_SLABS; i++) {
+        many[i] = iirdsp_slab_create(sizeof(object_t));
+        ok &= many[i] != NULL;
+    }
+    check(ok, "create");
+    if (!ok) {
+        return;
+    }
+    use_many(&ok);
+    pthread_create(&thread, NULL, use_many, &ok);
+    pthread_join(thread, NULL);
+    check(ok, "alloc/free on every slab from two threads");
+
+    /* The main thread keeps magazines of destroyed slabs in its list */
+    for (int i = 0; i < MANY_SLABS; i += 2) {
+        iirdsp_slab_destroy(many[i]);
+        many[i] = NULL;
+    }
+    use_many(&ok);
+    pthread_create(&thread, NULL, use_many, &ok);
+    pthread_join(thread, NULL);
+    check(ok, "alloc/free after destroying half the slabs");
+    for (int i = 0; i < MANY_SLABS; i++) {
+        ok &= many[i] == NULL || iirdsp_slab_live(many[i]) == 0;
+        iirdsp_slab_destroy(many[i]);
+        many[i] = NULL;
+    }
+    check(ok, "no objects left live");
+}
+
+int main(void)
+{
+    printf("iirdsp Slab Allocator Test\n");
+    printf("==========================\n\n");
+
+    test_alloc_free();
+    test_large_objects();
+    test_threads();
+    test_many_slabs();
+
+    if (failures == 0) {
+        printf("\n✓ Test PASSED\n");
+        return 0;
+    }
+    printf("\n✗ Test FAILED: %d checks\n", failures);
+    return -1;
+}
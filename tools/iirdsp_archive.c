@@ -0,0 +1,724 @@
+/**
+ * @file iirdsp_archive.c
+ * @brief Batch zero-phase filtering of record files with io_uring
+ *
+ * Each record file holds raw native-endian iirdsp_real samples of C
+ * channels (interleaved by default, -p for planar). Records are read
+ * whole into one of a few slot buffers with many chunked reads in flight.
+ * A completed record goes straight to a worker thread for
+ * iirdsp_filtfilt_multi() in place, and the result is written back with
+ * chunked writes in flight. The main thread only drives the ring, so
+ * reads of later records and writes of earlier ones overlap filtering.
+ *
+ * The slot buffers are registered with the ring (fixed-buffer reads and
+ * writes) when RLIMIT_MEMLOCK allows, and files are opened with O_DIRECT
+ * when the filesystem accepts it; otherwise the tool falls back to plain
+ * reads and writes and buffered I/O. The ring is driven through the raw
+ * system calls, so liburing is not needed.
+ *
+ * Usage: iirdsp_archive [options] record...
+ *   -c channels   Channels per record (default 1)
+ *   -p            Records are planar (channel after channel)
+ *   -o dir        Output directory (default: next to the input, ".filt")
+ *   -k kind       lowpass, highpass, bandpass or notch (default bandpass)
+ *   -n order      Butterworth order (default 4)
+ *   -1 f1 -2 f2   Cutoffs, or notch frequency and Q (default 0.5, 40)
+ *   -r fs         Sample rate (default 500)
+ *   -s slots      Records resident at once (default workers + 2)
+ *   -w workers    Filtering threads (default: online CPUs)
+ *   -q depth      I/O requests in flight (default 64)
+ *   -C kib        Request size in KiB (default 1024)
+ *   -B            Buffered I/O (no O_DIRECT)
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include "iirdsp.h"
+#include "registry.h"
+
+#define ALIGN 4096
+
+enum { OP_READ = 1, OP_WRITE = 2, OP_EVENT = 3 };
+enum { SLOT_FREE, SLOT_READING, SLOT_FILTERING, SLOT_WRITING };
+
+/**
+ * Minimal io_uring: the mapped submission and completion rings
+ */
+typedef struct {
+    int fd;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    unsigned entries;
+    unsigned tail;           /* Local submission tail, published by uring_enter() */
+    void* ring_mem;
+    size_t ring_bytes;
+    size_t sqe_bytes;
+} uring_t;
+
+/**
+ * An I/O request that must be (re)issued
+ */
+typedef struct {
+    size_t off;
+    size_t len;
+} extent_t;
+
+typedef struct slot {
+    int index;
+    int state;
+    int in_fd;
+    int out_fd;
+    int direct_out;
+    const char* path;
+    char* out_path;
+    size_t size;             /* Record bytes */
+    size_t io_size;          /* Bytes to transfer (aligned up for O_DIRECT) */
+    size_t next_off;         /* Next chunk to issue */
+    extent_t retry[8];       /* Remainders of short transfers */
+    int num_retry;
+    unsigned inflight;
+    int failed;
+    char* buf;
+    struct slot* next;       /* Worker queues */
+} slot_t;
+
+/* Shared with the workers */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
+static slot_t* todo_head;
+static slot_t* todo_tail;
+static slot_t* done_list;
+static int quitting;
+static int event_fd;
+
+static iirdsp_filter_t filter;
+static int channels = 1;
+static iirdsp_layout_t layout = IIRDSP_LAYOUT_INTERLEAVED;
+static size_t capacity;
+
+static int uring_init(uring_t* r, unsigned entries)
+{
+    struct io_uring_params p;
+    size_t sq_bytes;
+    size_t cq_bytes;
+    char* mem;
+
+    memset(&p, 0, sizeof(p));
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) {
+        return -1;
+    }
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        close(r->fd);
+        errno = ENOSYS;
+        return -1;
+    }
+    sq_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->ring_bytes = sq_bytes > cq_bytes ? sq_bytes : cq_bytes;
+    mem = mmap(NULL, r->ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (mem == MAP_FAILED) {
+        close(r->fd);
+        return -1;
+    }
+    r->sqe_bytes = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqe_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        munmap(mem, r->ring_bytes);
+        close(r->fd);
+        return -1;
+    }
+    r->ring_mem = mem;
+    r->sq_head = (unsigned*)(mem + p.sq_off.head);
+    r->sq_tail = (unsigned*)(mem + p.sq_off.tail);
+    r->sq_mask = (unsigned*)(mem + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(mem + p.sq_off.array);
+    r->cq_head = (unsigned*)(mem + p.cq_off.head);
+    r->cq_tail = (unsigned*)(mem + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(mem + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(mem + p.cq_off.cqes);
+    r->entries = p.sq_entries;
+    r->tail = *r->sq_tail;
+    return 0;
+}
+
+static void uring_destroy(uring_t* r)
+{
+    munmap(r->sqes, r->sqe_bytes);
+    munmap(r->ring_mem, r->ring_bytes);
+    close(r->fd);
+}
+
+/* Next free submission entry; the caller keeps requests <= entries */
+static struct io_uring_sqe* uring_sqe(uring_t* r)
+{
+    unsigned idx = r->tail & *r->sq_mask;
+    struct io_uring_sqe* sqe = &r->sqes[idx];
+
+    r->sq_array[idx] = idx;
+    r->tail++;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+/* Publish queued entries and wait for at least wait_for completions */
+static int uring_enter(uring_t* r, unsigned wait_for)
+{
+    int rc;
+
+    __atomic_store_n(r->sq_tail, r->tail, __ATOMIC_RELEASE);
+    do {
+        unsigned pending = r->tail - __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+        rc = (int)syscall(__NR_io_uring_enter, r->fd, pending, wait_for,
+                          wait_for > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    } while (rc < 0 && errno == EINTR);
+    return rc;
+}
+
+static uint64_t tag(int op, int slot)
+{
+    return ((uint64_t)slot << 8) | (uint64_t)op;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void* worker(void* arg)
+{
+    const int max_N = (int)(capacity / sizeof(iirdsp_real) / (size_t)channels);
+    iirdsp_real* work = (iirdsp_real*)malloc(iirdsp_filtfilt_multi_work_size(max_N) * sizeof(iirdsp_real));
+
+    (void)arg;
+    for (;;) {
+        slot_t* s;
+        int N;
+
+        pthread_mutex_lock(&queue_lock);
+        while (todo_head == NULL && !quitting) {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+        }
+        s = todo_head;
+        if (s == NULL) {
+            pthread_mutex_unlock(&queue_lock);
+            break;
+        }
+        todo_head = s->next;
+        if (todo_head == NULL) {
+            todo_tail = NULL;
+        }
+        pthread_mutex_unlock(&queue_lock);
+
+        N = (int)(s->size / sizeof(iirdsp_real) / (size_t)channels);
+        if (N > 0 && iirdsp_filtfilt_multi(&filter, 1, (iirdsp_real*)s->buf, (iirdsp_real*)s->buf, channels, N,
+                                           layout, work) != 0) {
+            s->failed = 1;
+        }
+
+        pthread_mutex_lock(&queue_lock);
+        s->next = done_list;
+        done_list = s;
+        pthread_mutex_unlock(&queue_lock);
+        {
+            uint64_t one = 1;
+            ssize_t w = write(event_fd, &one, sizeof(one));
+            (void)w;
+        }
+    }
+    free(work);
+    return NULL;
+}
+
+/* Hand a fully read record to the workers */
+static void enqueue_filter(slot_t* s)
+{
+    s->state = SLOT_FILTERING;
+    pthread_mutex_lock(&queue_lock);
+    s->next = NULL;
+    if (todo_tail != NULL) {
+        todo_tail->next = s;
+    } else {
+        todo_head = s;
+    }
+    todo_tail = s;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+/**
+ * Close a written record and free its slot
+ *
+ * @return 0, or -1 if the record failed (its output is removed)
+ */
+static int finish_write(slot_t* s)
+{
+    /* O_DIRECT wrote whole blocks; cut the file back to the record size */
+    if (!s->failed && s->direct_out && s->io_size != s->size && ftruncate(s->out_fd, (off_t)s->size) != 0) {
+        s->failed = 1;
+    }
+    close(s->out_fd);
+    s->out_fd = -1;
+    if (s->failed) {
+        unlink(s->out_path);
+    }
+    free(s->out_path);
+    s->state = SLOT_FREE;
+    return s->failed ? -1 : 0;
+}
+
+static char* output_path(const char* in, const char* dir)
+{
+    const char* base = strrchr(in, '/');
+    size_t len;
+    char* out;
+
+    if (dir == NULL) {
+        len = strlen(in) + 6;
+        out = (char*)malloc(len);
+        if (out != NULL) {
+            snprintf(out, len, "%s.filt", in);
+        }
+        return out;
+    }
+    base = base != NULL ? base + 1 : in;
+    len = strlen(dir) + strlen(base) + 2;
+    out = (char*)malloc(len);
+    if (out != NULL) {
+        snprintf(out, len, "%s/%s", dir, base);
+    }
+    return out;
+}
+
+static int open_file(const char* path, int flags, int direct, int* got_direct)
+{
+    int fd = -1;
+
+    if (direct) {
+        fd = open(path, flags | O_DIRECT, 0644);
+    }
+    *got_direct = fd >= 0;
+    if (fd < 0) {
+        fd = open(path, flags, 0644);
+    }
+    return fd;
+}
+
+int main(int argc, char** argv)
+{
+    const char* out_dir = NULL;
+    iirdsp_spec_t spec;
+    int workers = 0;
+    int nslots = 0;
+    unsigned depth = 64;
+    size_t chunk = 1024 * 1024;
+    int direct = 1;
+    int fixed = 0;
+    uring_t ring;
+    slot_t* slots;
+    struct iovec* iov;
+    pthread_t* threads;
+    int next_file;
+    int active = 0;
+    unsigned inflight = 0;
+    size_t bytes_in = 0;
+    size_t bytes_out = 0;
+    int records = 0;
+    int failures = 0;
+    int direct_in_count = 0;
+    uint64_t event_value;
+    double t0;
+    double elapsed;
+    int opt;
+
+    memset(&spec, 0, sizeof(spec));
+    spec.kind = IIRDSP_SPEC_BANDPASS;
+    spec.order = 4;
+    spec.f1 = 0.5;
+    spec.f2 = 40.0;
+    spec.fs = 500.0;
+
+    while ((opt = getopt(argc, argv, "c:po:k:n:1:2:r:s:w:q:C:B")) != -1) {
+        switch (opt) {
+        case 'c':
+            channels = atoi(optarg);
+            break;
+        case 'p':
+            layout = IIRDSP_LAYOUT_PLANAR;
+            break;
+        case 'o':
+            out_dir = optarg;
+            break;
+        case 'k':
+            spec.kind = strcmp(optarg, "lowpass") == 0    ? IIRDSP_SPEC_LOWPASS
+                        : strcmp(optarg, "highpass") == 0 ? IIRDSP_SPEC_HIGHPASS
+                        : strcmp(optarg, "notch") == 0    ? IIRDSP_SPEC_NOTCH
+                        : strcmp(optarg, "bandpass") == 0 ? IIRDSP_SPEC_BANDPASS
+                                                          : -1;
+            break;
+        case 'n':
+            spec.order = atoi(optarg);
+            break;
+        case '1':
+            spec.f1 = atof(optarg);
+            break;
+        case '2':
+            spec.f2 = atof(optarg);
+            break;
+        case 'r':
+            spec.fs = atof(optarg);
+            break;
+        case 's':
+            nslots = atoi(optarg);
+            break;
+        case 'w':
+            workers = atoi(optarg);
+            break;
+        case 'q':
+            depth = (unsigned)atoi(optarg);
+            break;
+        case 'C':
+            chunk = (size_t)atoi(optarg) * 1024;
+            break;
+        case 'B':
+            direct = 0;
+            break;
+        default:
+            fprintf(stderr, "usage: iirdsp_archive [-c channels] [-p] [-o dir] [-k kind] [-n order] "
+                            "[-1 f1] [-2 f2] [-r fs] [-s slots] [-w workers] [-q depth] [-C kib] [-B] "
+                            "record...\n");
+            return 1;
+        }
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "iirdsp_archive: no records given\n");
+        return 1;
+    }
+    if (channels <= 0 || nslots > 0xffff || depth == 0 || chunk == 0 || chunk % ALIGN != 0 ||
+        iirdsp_spec_design(&spec, &filter) != 0) {
+        fprintf(stderr, "iirdsp_archive: invalid arguments\n");
+        return 1;
+    }
+    if (workers <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        workers = cpus > 0 ? (int)cpus : 1;
+    }
+    if (nslots <= 0) {
+        nslots = workers + 2;
+    }
+
+    /* Size the slot buffers for the largest record */
+    for (int i = optind; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && (size_t)st.st_size > capacity) {
+            capacity = (size_t)st.st_size;
+        }
+    }
+    capacity = (capacity + ALIGN - 1) / ALIGN * ALIGN;
+    if (capacity == 0) {
+        capacity = ALIGN;
+    }
+    if (capacity / sizeof(iirdsp_real) / (size_t)channels > 0x7fffffff) {
+        fprintf(stderr, "iirdsp_archive: record too large\n");
+        return 1;
+    }
+
+    if (uring_init(&ring, depth + 1) != 0) {
+        fprintf(stderr, "iirdsp_archive: io_uring unavailable: %s\n", strerror(errno));
+        return 1;
+    }
+    if (depth + 1 > ring.entries) {
+        depth = ring.entries - 1;
+    }
+
+    slots = (slot_t*)calloc((size_t)nslots, sizeof(slot_t));
+    iov = (struct iovec*)calloc((size_t)nslots, sizeof(struct iovec));
+    threads = (pthread_t*)calloc((size_t)workers, sizeof(pthread_t));
+    if (slots == NULL || iov == NULL || threads == NULL) {
+        fprintf(stderr, "iirdsp_archive: out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < nslots; i++) {
+        void* p = NULL;
+        if (posix_memalign(&p, ALIGN, capacity) != 0) {
+            fprintf(stderr, "iirdsp_archive: cannot allocate %d slots of %zu bytes\n", nslots, capacity);
+            return 1;
+        }
+        slots[i].index = i;
+        slots[i].buf = (char*)p;
+        slots[i].in_fd = -1;
+        slots[i].out_fd = -1;
+        iov[i].iov_base = p;
+        iov[i].iov_len = capacity;
+    }
+    fixed = syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, iov, (unsigned)nslots) == 0;
+    if (!fixed) {
+        fprintf(stderr, "iirdsp_archive: buffer registration failed (%s), using plain reads and writes\n",
+                strerror(errno));
+    }
+
+    event_fd = eventfd(0, EFD_CLOEXEC);
+    for (int i = 0; i < workers; i++) {
+        pthread_create(&threads[i], NULL, worker, NULL);
+    }
+
+    /* Keep one read on the eventfd so workers can wake the ring */
+    {
+        struct io_uring_sqe* sqe = uring_sqe(&ring);
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = event_fd;
+        sqe->addr = (uint64_t)(uintptr_t)&event_value;
+        sqe->len = sizeof(event_value);
+        sqe->user_data = tag(OP_EVENT, 0);
+    }
+
+    t0 = now_seconds();
+    next_file = optind;
+    while (next_file < argc || active > 0) {
+        /* Start reading records into free slots */
+        for (int i = 0; i < nslots && next_file < argc; i++) {
+            slot_t* s = &slots[i];
+            struct stat st;
+            const char* why;
+            int got_direct;
+
+            if (s->state != SLOT_FREE) {
+                continue;
+            }
+            s->path = argv[next_file++];
+            s->in_fd = open_file(s->path, O_RDONLY, direct, &got_direct);
+            why = NULL;
+            if (s->in_fd < 0 || fstat(s->in_fd, &st) != 0) {
+                why = strerror(errno);
+            } else if ((size_t)st.st_size % (sizeof(iirdsp_real) * (size_t)channels) != 0) {
+                why = "not a whole number of frames";
+            } else if ((size_t)st.st_size > capacity) {
+                /* The slots were sized from stat() at startup */
+                why = "grew since the slots were sized";
+            }
+            if (why != NULL) {
+                fprintf(stderr, "iirdsp_archive: %s: %s\n", s->path, why);
+                if (s->in_fd >= 0) {
+                    close(s->in_fd);
+                    s->in_fd = -1;
+                }
+                failures++;
+                i--;
+                continue;
+            }
+            direct_in_count += got_direct;
+            s->size = (size_t)st.st_size;
+            s->io_size = got_direct ? (s->size + ALIGN - 1) / ALIGN * ALIGN : s->size;
+            s->next_off = 0;
+            s->num_retry = 0;
+            s->inflight = 0;
+            s->failed = 0;
+            s->state = SLOT_READING;
+            active++;
+            if (s->io_size == 0) {
+                close(s->in_fd);
+                s->in_fd = -1;
+                enqueue_filter(s);
+            }
+        }
+        if (active == 0) {
+            continue;
+        }
+
+        /* Issue chunks up to the queue depth */
+        for (int i = 0; i < nslots && inflight < depth; i++) {
+            slot_t* s = &slots[i];
+            int writing = s->state == SLOT_WRITING;
+
+            if ((s->state != SLOT_READING && !writing) || s->failed) {
+                continue;
+            }
+            while (inflight < depth && (s->num_retry > 0 || s->next_off < s->io_size)) {
+                struct io_uring_sqe* sqe = uring_sqe(&ring);
+                extent_t e;
+
+                if (s->num_retry > 0) {
+                    e = s->retry[--s->num_retry];
+                } else {
+                    e.off = s->next_off;
+                    e.len = s->io_size - s->next_off < chunk ? s->io_size - s->next_off : chunk;
+                    s->next_off += e.len;
+                }
+                sqe->opcode = fixed ? (writing ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED)
+                                    : (writing ? IORING_OP_WRITE : IORING_OP_READ);
+                sqe->fd = writing ? s->out_fd : s->in_fd;
+                sqe->addr = (uint64_t)(uintptr_t)(s->buf + e.off);
+                sqe->len = (unsigned)e.len;
+                sqe->off = e.off;
+                sqe->buf_index = fixed ? (uint16_t)s->index : 0;
+                sqe->user_data = tag(writing ? OP_WRITE : OP_READ, s->index) | ((uint64_t)e.off << 24);
+                s->inflight++;
+                inflight++;
+            }
+        }
+
+        if (uring_enter(&ring, 1) < 0) {
+            fprintf(stderr, "iirdsp_archive: io_uring_enter: %s\n", strerror(errno));
+            break;
+        }
+
+        /* Reap completions */
+        for (;;) {
+            unsigned head = *ring.cq_head;
+            struct io_uring_cqe* cqe;
+            int op;
+            slot_t* s;
+
+            if (head == __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            cqe = &ring.cqes[head & *ring.cq_mask];
+            op = (int)(cqe->user_data & 0xff);
+            s = &slots[(cqe->user_data >> 8) & 0xffff];
+
+            if (op == OP_EVENT) {
+                slot_t* done;
+                struct io_uring_sqe* sqe;
+
+                pthread_mutex_lock(&queue_lock);
+                done = done_list;
+                done_list = NULL;
+                pthread_mutex_unlock(&queue_lock);
+                for (; done != NULL; done = done->next) {
+                    if (done->failed) {
+                        fprintf(stderr, "iirdsp_archive: %s: filtering failed\n", done->path);
+                        failures++;
+                        done->state = SLOT_FREE;
+                        active--;
+                        continue;
+                    }
+                    done->out_path = output_path(done->path, out_dir);
+                    done->out_fd = done->out_path != NULL
+                                       ? open_file(done->out_path, O_WRONLY | O_CREAT | O_TRUNC, direct,
+                                                   &done->direct_out)
+                                       : -1;
+                    if (done->out_fd < 0) {
+                        fprintf(stderr, "iirdsp_archive: %s: %s\n", done->out_path ? done->out_path : done->path,
+                                strerror(errno));
+                        free(done->out_path);
+                        failures++;
+                        done->state = SLOT_FREE;
+                        active--;
+                        continue;
+                    }
+                    /* Zero the padding of the last O_DIRECT block */
+                    done->io_size = done->direct_out ? (done->size + ALIGN - 1) / ALIGN * ALIGN : done->size;
+                    memset(done->buf + done->size, 0, done->io_size - done->size);
+                    done->next_off = 0;
+                    done->num_retry = 0;
+                    done->state = SLOT_WRITING;
+                    if (done->io_size == 0) {
+                        finish_write(done) == 0 ? records++ : failures++;
+                        active--;
+                    }
+                }
+                sqe = uring_sqe(&ring);
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = event_fd;
+                sqe->addr = (uint64_t)(uintptr_t)&event_value;
+                sqe->len = sizeof(event_value);
+                sqe->user_data = tag(OP_EVENT, 0);
+            } else {
+                size_t off = (size_t)(cqe->user_data >> 24);
+                /* Chunks and their reissued remainders both end on a chunk boundary */
+                size_t len = chunk - off % chunk < s->io_size - off ? chunk - off % chunk : s->io_size - off;
+                size_t limit = op == OP_READ ? s->size : s->io_size;
+
+                inflight--;
+                s->inflight--;
+                if (cqe->res < 0) {
+                    fprintf(stderr, "iirdsp_archive: %s: %s\n", op == OP_READ ? s->path : s->out_path,
+                            strerror(-cqe->res));
+                    s->failed = 1;
+                } else if ((size_t)cqe->res < len && off + (size_t)cqe->res < limit) {
+                    /* Short transfer before the end: reissue the rest */
+                    if (cqe->res == 0 || s->num_retry == (int)(sizeof(s->retry) / sizeof(s->retry[0]))) {
+                        fprintf(stderr, "iirdsp_archive: %s: short %s\n", s->path,
+                                op == OP_READ ? "read" : "write");
+                        s->failed = 1;
+                    } else {
+                        s->retry[s->num_retry].off = off + (size_t)cqe->res;
+                        s->retry[s->num_retry].len = len - (size_t)cqe->res;
+                        s->num_retry++;
+                    }
+                } else if (op == OP_READ) {
+                    bytes_in += (size_t)cqe->res < s->size - off ? (size_t)cqe->res : s->size - off;
+                } else {
+                    bytes_out += (size_t)cqe->res < s->size - off ? (size_t)cqe->res : s->size - off;
+                }
+
+                if (s->inflight == 0 && (s->failed || (s->num_retry == 0 && s->next_off >= s->io_size))) {
+                    if (op == OP_READ) {
+                        close(s->in_fd);
+                        s->in_fd = -1;
+                        if (s->failed) {
+                            failures++;
+                            s->state = SLOT_FREE;
+                            active--;
+                        } else {
+                            enqueue_filter(s);
+                        }
+                    } else {
+                        finish_write(s) == 0 ? records++ : failures++;
+                        active--;
+                    }
+                }
+            }
+            __atomic_store_n(ring.cq_head, head + 1, __ATOMIC_RELEASE);
+        }
+    }
+    elapsed = now_seconds() - t0;
+
+    pthread_mutex_lock(&queue_lock);
+    quitting = 1;
+    pthread_cond_broadcast(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    for (int i = 0; i < workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("iirdsp_archive: %d records, %d failed, %d workers, %d slots, depth %u, %s%s\n", records, failures,
+           workers, nslots, depth, fixed ? "registered buffers" : "plain buffers",
+           direct_in_count > 0 ? ", O_DIRECT" : "");
+    printf("  read %.1f MB, wrote %.1f MB in %.2f s: %.1f MB/s in, %.1f MB/s out\n", bytes_in * 1e-6,
+           bytes_out * 1e-6, elapsed, bytes_in * 1e-6 / elapsed, bytes_out * 1e-6 / elapsed);
+
+    uring_destroy(&ring);
+    close(event_fd);
+    for (int i = 0; i < nslots; i++) {
+        free(slots[i].buf);
+    }
+    free(slots);
+    free(iov);
+    free(threads);
+    return failures == 0 ? 0 : 1;
+}
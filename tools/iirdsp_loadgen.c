@@ -0,0 +1,351 @@
+/**
+ * @file iirdsp_loadgen.c
+ * @brief Load generator and reference client for iirdspd
+ *
+ * Opens a number of streams on the daemon, keeps every ring full of
+ * blocks for a fixed time, and reports throughput and block latency
+ * (submit to DONE). With -v every returned block is compared with a
+ * local iirdsp_process_buffer() run of the same input.
+ *
+ * Usage: iirdsp_loadgen [-S socket] [-s streams] [-b block] [-q slots]
+ *                       [-d seconds] [-m] [-v]
+ *   -m  spread streams over three specs instead of one
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <math.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#include "iirdsp.h"
+#include "iirdspd.h"
+
+#ifdef IIRDSP_USE_FLOAT
+#define TOL 1e-4
+#else
+#define TOL 1e-9
+#endif
+
+typedef struct {
+    uint32_t id;
+    iirdspd_ring_t* ring;
+    size_t ring_bytes;
+    uint32_t head;           /* Next slot to submit */
+    uint32_t tail;           /* Next slot to collect */
+    long fed;                /* Samples submitted */
+    double* submitted_at;    /* Per slot */
+    iirdsp_filter_t ref;     /* Local reference for -v */
+    iirdsp_real* ref_out;
+} client_stream_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static iirdsp_real input(uint32_t stream, long n)
+{
+    return (iirdsp_real)(sin(0.013 * (double)n * (1 + stream % 7)) + 0.25 * sin(0.7 * (double)n));
+}
+
+static iirdsp_spec_t spec_for(int k)
+{
+    iirdsp_spec_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.fs = 500.0;
+    switch (k) {
+    case 0:
+        s.kind = IIRDSP_SPEC_BANDPASS;
+        s.order = 4;
+        s.f1 = 0.5;
+        s.f2 = 40.0;
+        break;
+    case 1:
+        s.kind = IIRDSP_SPEC_LOWPASS;
+        s.order = 4;
+        s.f1 = 40.0;
+        break;
+    default:
+        s.kind = IIRDSP_SPEC_NOTCH;
+        s.f1 = 50.0;
+        s.f2 = 30.0;
+        break;
+    }
+    return s;
+}
+
+/**
+ * Wait for the reply to a request, skipping DONE notifications
+ *
+ * @param fd_out Receives a passed file descriptor, or -1
+ */
+static int await_reply(int sock, uint32_t op, iirdspd_reply_t* reply, int* fd_out)
+{
+    for (;;) {
+        struct msghdr msg;
+        struct iovec iov;
+        char control[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr* cm;
+        ssize_t n;
+
+        memset(&msg, 0, sizeof(msg));
+        iov.iov_base = reply;
+        iov.iov_len = sizeof(*reply);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        n = recvmsg(sock, &msg, 0);
+        if (n != (ssize_t)sizeof(*reply)) {
+            return -1;
+        }
+        if (reply->op != op) {
+            continue;
+        }
+        *fd_out = -1;
+        cm = CMSG_FIRSTHDR(&msg);
+        if (cm != NULL && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+            memcpy(fd_out, CMSG_DATA(cm), sizeof(int));
+        }
+        return 0;
+    }
+}
+
+static void send_request(int sock, uint32_t op, uint32_t stream)
+{
+    iirdspd_request_t req;
+
+    memset(&req, 0, sizeof(req));
+    req.op = op;
+    req.stream = stream;
+    send(sock, &req, sizeof(req), MSG_NOSIGNAL);
+}
+
+static int open_stream(int sock, client_stream_t* s, const iirdsp_spec_t* spec, uint32_t slots, uint32_t block)
+{
+    iirdspd_request_t req;
+    iirdspd_reply_t reply;
+    void* mem;
+    int fd;
+
+    memset(&req, 0, sizeof(req));
+    req.op = IIRDSPD_OP_OPEN;
+    req.slots = slots;
+    req.slot_samples = block;
+    req.spec = *spec;
+    if (send(sock, &req, sizeof(req), MSG_NOSIGNAL) != (ssize_t)sizeof(req) ||
+        await_reply(sock, IIRDSPD_OP_OPEN, &reply, &fd) != 0) {
+        return -1;
+    }
+    if (reply.status != 0 || fd < 0) {
+        return reply.status != 0 ? reply.status : -1;
+    }
+
+    s->ring_bytes = iirdspd_ring_bytes(slots, block);
+    mem = mmap(NULL, s->ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return -1;
+    }
+    s->ring = (iirdspd_ring_t*)mem;
+    if (s->ring->magic != IIRDSPD_RING_MAGIC || s->ring->sample_size != sizeof(iirdsp_real)) {
+        fprintf(stderr, "iirdsp_loadgen: ring format or sample size mismatch\n");
+        return -1;
+    }
+    s->id = reply.stream;
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = IIRDSPD_DEFAULT_SOCKET;
+    int nstreams = 64;
+    uint32_t block = 64;
+    uint32_t slots = 8;
+    double duration = 5.0;
+    int mixed = 0;
+    int verify = 0;
+    struct sockaddr_un addr;
+    client_stream_t* streams;
+    long blocks = 0;
+    long mismatches = 0;
+    double latency_sum = 0.0;
+    double latency_max = 0.0;
+    double t0;
+    double elapsed;
+    int sock;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "S:s:b:q:d:mv")) != -1) {
+        switch (opt) {
+        case 'S':
+            path = optarg;
+            break;
+        case 's':
+            nstreams = atoi(optarg);
+            break;
+        case 'b':
+            block = (uint32_t)atoi(optarg);
+            break;
+        case 'q':
+            slots = (uint32_t)atoi(optarg);
+            break;
+        case 'd':
+            duration = atof(optarg);
+            break;
+        case 'm':
+            mixed = 1;
+            break;
+        case 'v':
+            verify = 1;
+            break;
+        default:
+            fprintf(stderr, "usage: iirdsp_loadgen [-S socket] [-s streams] [-b block] [-q slots] "
+                            "[-d seconds] [-m] [-v]\n");
+            return 1;
+        }
+    }
+    if (nstreams <= 0 || block == 0 || slots == 0) {
+        fprintf(stderr, "iirdsp_loadgen: invalid arguments\n");
+        return 1;
+    }
+
+    sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (sock < 0 || connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "iirdsp_loadgen: cannot connect to %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    streams = (client_stream_t*)calloc((size_t)nstreams, sizeof(client_stream_t));
+    for (int k = 0; k < nstreams; k++) {
+        client_stream_t* s = &streams[k];
+        iirdsp_spec_t spec = spec_for(mixed ? k % 3 : 0);
+        int rc = open_stream(sock, s, &spec, slots, block);
+
+        if (rc != 0) {
+            fprintf(stderr, "iirdsp_loadgen: opening stream %d failed (%d)\n", k, rc);
+            return 1;
+        }
+        s->submitted_at = (double*)calloc(slots, sizeof(double));
+        s->ref_out = (iirdsp_real*)malloc(block * sizeof(iirdsp_real));
+        iirdsp_spec_design(&spec, &s->ref);
+    }
+
+    t0 = now_seconds();
+    do {
+        int progress = 0;
+
+        for (int k = 0; k < nstreams; k++) {
+            client_stream_t* s = &streams[k];
+            iirdspd_ring_t* ring = s->ring;
+            int submitted = 0;
+
+            /* Collect finished blocks in order */
+            for (;;) {
+                uint32_t i = s->tail % slots;
+                iirdspd_slot_t* slot = iirdspd_ring_slot(ring, i);
+                double latency;
+
+                if (s->tail == s->head || __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != IIRDSPD_SLOT_DONE) {
+                    break;
+                }
+                latency = now_seconds() - s->submitted_at[i];
+                latency_sum += latency;
+                if (latency > latency_max) {
+                    latency_max = latency;
+                }
+                if (verify) {
+                    const iirdsp_real* y = iirdspd_ring_samples(ring, slots, block, i);
+
+                    for (uint32_t n = 0; n < block; n++) {
+                        s->ref_out[n] = input(s->id, (long)s->tail * block + n);
+                    }
+                    iirdsp_process_buffer(&s->ref, s->ref_out, s->ref_out, (int)block);
+                    for (uint32_t n = 0; n < block; n++) {
+                        mismatches += fabs(y[n] - s->ref_out[n]) > TOL;
+                    }
+                }
+                __atomic_store_n(&slot->state, IIRDSPD_SLOT_FREE, __ATOMIC_RELEASE);
+                s->tail++;
+                blocks++;
+                progress = 1;
+            }
+
+            /* Refill free slots */
+            while (s->head - s->tail < slots) {
+                uint32_t i = s->head % slots;
+                iirdspd_slot_t* slot = iirdspd_ring_slot(ring, i);
+                iirdsp_real* x = iirdspd_ring_samples(ring, slots, block, i);
+
+                for (uint32_t n = 0; n < block; n++) {
+                    x[n] = input(s->id, s->fed + n);
+                }
+                slot->count = block;
+                s->submitted_at[i] = now_seconds();
+                __atomic_store_n(&slot->state, IIRDSPD_SLOT_SUBMITTED, __ATOMIC_SEQ_CST);
+                s->head++;
+                s->fed += block;
+                submitted = 1;
+            }
+            if (submitted && __atomic_load_n(&ring->daemon_idle, __ATOMIC_SEQ_CST)) {
+                send_request(sock, IIRDSPD_OP_KICK, s->id);
+            }
+        }
+
+        /* Nothing came back: sleep until the daemon reports a DONE slot */
+        if (!progress) {
+            int any_done = 0;
+            struct pollfd pfd;
+
+            for (int k = 0; k < nstreams && !any_done; k++) {
+                client_stream_t* s = &streams[k];
+                iirdspd_slot_t* slot = iirdspd_ring_slot(s->ring, s->tail % slots);
+
+                __atomic_store_n(&s->ring->client_waiting, 1, __ATOMIC_SEQ_CST);
+                any_done = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST) == IIRDSPD_SLOT_DONE;
+            }
+            pfd.fd = sock;
+            pfd.events = POLLIN;
+            if (!any_done && poll(&pfd, 1, 100) > 0) {
+                iirdspd_reply_t reply;
+                while (recv(sock, &reply, sizeof(reply), MSG_DONTWAIT) > 0) {
+                }
+            }
+        }
+    } while (now_seconds() - t0 < duration);
+    elapsed = now_seconds() - t0;
+
+    printf("iirdsp_loadgen: %d streams (%s), %u-sample blocks, %u slots\n",
+           nstreams, mixed ? "3 specs" : "1 spec", block, slots);
+    printf("  %ld blocks in %.2f s: %.0f blocks/s, %.2f Msamples/s\n",
+           blocks, elapsed, blocks / elapsed, blocks * (double)block / elapsed * 1e-6);
+    printf("  latency: mean %.1f us, max %.1f us\n",
+           blocks > 0 ? latency_sum / blocks * 1e6 : 0.0, latency_max * 1e6);
+    if (verify) {
+        printf("  verification: %ld mismatching samples\n", mismatches);
+    }
+
+    for (int k = 0; k < nstreams; k++) {
+        send_request(sock, IIRDSPD_OP_CLOSE, streams[k].id);
+        munmap(streams[k].ring, streams[k].ring_bytes);
+        free(streams[k].submitted_at);
+        free(streams[k].ref_out);
+    }
+    close(sock);
+    free(streams);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,520 @@
+/**
+ * @file iirdspd.c
+ * @brief Local filtering daemon
+ *
+ * Clients open streams over a Unix socket (see iirdspd.h) and exchange
+ * sample blocks through per-stream shared-memory rings. Each pass of the
+ * main loop collects every submitted block from every client into one
+ * iirdsp_engine_t (which copies them into its per-stream buffers), runs
+ * it once, and copies the outputs back into the clients' slots. Streams with the same coefficients, from any client,
+ * share SIMD lanes. The daemon only sleeps in poll() when no ring has
+ * work, and clients kick it through the socket only while it sleeps.
+ *
+ * Clients can write anything into their rings, so the daemon never reads
+ * ring geometry or block sizes back from them: slots and slot size are
+ * kept per stream, each block's size is read once and clamped when it is
+ * ingested, and the ring memory is a sealed memfd the client cannot
+ * resize under the daemon's mapping.
+ *
+ * Usage: iirdspd [-S socket] [-n max_streams] [-p max_pending]
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "iirdsp.h"
+#include "engine.h"
+#include "iirdspd.h"
+
+#define MAX_CLIENTS 256
+
+typedef struct {
+    int in_use;
+    int client;
+    iirdspd_ring_t* ring;    /* Only the idle/waiting flags are read back */
+    size_t ring_bytes;
+    iirdspd_slot_t* ctl;     /* Slot control words */
+    iirdsp_real* samples;    /* Slot i at samples + i * slot_samples */
+    uint32_t slots;          /* Geometry as requested, not as in the ring */
+    uint32_t slot_samples;
+    uint32_t* counts;        /* Clamped size of each ingested slot */
+    uint32_t next_ingest;    /* Next slot to hand to the engine */
+    uint32_t next_deliver;   /* Next slot to receive output */
+    uint32_t deliver_off;    /* Samples of that slot already written */
+    int notify;              /* A slot became DONE this pass */
+} stream_t;
+
+typedef struct {
+    int fd;                  /* -1 if unused */
+} client_t;
+
+static iirdsp_engine_t* engine;
+static stream_t* streams;
+static int max_streams = 1024;
+static int max_pending = 8192;
+static client_t clients[MAX_CLIENTS];
+static int listen_fd = -1;
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stop = 1;
+}
+
+/**
+ * Read a submitted slot's sample count once and clamp it to the slot
+ */
+static uint32_t slot_count(const stream_t* s, const iirdspd_slot_t* slot)
+{
+    uint32_t count = __atomic_load_n(&slot->count, __ATOMIC_RELAXED);
+
+    return count == 0 ? 1 : count > s->slot_samples ? s->slot_samples : count;
+}
+
+/**
+ * Engine sink: scatter a stream's output over its in-flight slots
+ */
+static void sink(void* user, uint64_t stream_id, const iirdsp_real* y, int n)
+{
+    stream_t* s = &streams[stream_id];
+
+    (void)user;
+    while (n > 0 && s->next_deliver != s->next_ingest) {
+        uint32_t i = s->next_deliver % s->slots;
+        iirdspd_slot_t* slot = &s->ctl[i];
+        uint32_t count = s->counts[i];
+        uint32_t k = count - s->deliver_off;
+
+        if ((int)k > n) {
+            k = (uint32_t)n;
+        }
+        memcpy(s->samples + (size_t)i * s->slot_samples + s->deliver_off, y, k * sizeof(iirdsp_real));
+        y += k;
+        n -= (int)k;
+        s->deliver_off += k;
+        if (s->deliver_off == count) {
+            __atomic_store_n(&slot->state, IIRDSPD_SLOT_DONE, __ATOMIC_RELEASE);
+            s->next_deliver++;
+            s->deliver_off = 0;
+            s->notify = 1;
+        }
+    }
+}
+
+static void send_reply(int fd, uint32_t op, uint32_t stream, int32_t status, int pass_fd)
+{
+    iirdspd_reply_t reply;
+    struct msghdr msg;
+    struct iovec iov;
+    char control[CMSG_SPACE(sizeof(int))];
+
+    memset(&reply, 0, sizeof(reply));
+    reply.op = op;
+    reply.stream = stream;
+    reply.status = status;
+
+    memset(&msg, 0, sizeof(msg));
+    iov.iov_base = &reply;
+    iov.iov_len = sizeof(reply);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (pass_fd >= 0) {
+        struct cmsghdr* cm;
+
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cm), &pass_fd, sizeof(int));
+    }
+    sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/**
+ * Create an anonymous shared ring and its file descriptor
+ *
+ * The memfd is sealed against resizing before the client gets it, so a
+ * client cannot truncate it and fault the daemon's mapping.
+ */
+static iirdspd_ring_t* create_ring(uint32_t slots, uint32_t slot_samples, size_t* bytes, int* fd_out)
+{
+    size_t size = iirdspd_ring_bytes(slots, slot_samples);
+    iirdspd_ring_t* ring;
+    void* mem;
+    int fd;
+
+    fd = memfd_create("iirdspd-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)size) != 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        close(fd);
+        return NULL;
+    }
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    ring = (iirdspd_ring_t*)mem;
+    ring->magic = IIRDSPD_RING_MAGIC;
+    ring->version = IIRDSPD_VERSION;
+    ring->slots = slots;
+    ring->slot_samples = slot_samples;
+    ring->sample_size = (uint32_t)sizeof(iirdsp_real);
+    *bytes = size;
+    *fd_out = fd;
+    return ring;
+}
+
+static void close_stream(uint32_t id)
+{
+    stream_t* s = &streams[id];
+
+    /* Drops the stream's reference on its coefficient set */
+    iirdsp_engine_close(engine, id);
+    munmap(s->ring, s->ring_bytes);
+    free(s->counts);
+    s->in_use = 0;
+}
+
+static void open_stream(int c, const iirdspd_request_t* req)
+{
+    iirdsp_filter_t f;
+    int status = 0;
+    int set = -1;
+    int fd = -1;
+    uint32_t id;
+    stream_t* s;
+
+    if (req->slots == 0 || req->slots > 4096 || req->slot_samples == 0 ||
+        req->slot_samples > (uint32_t)max_pending) {
+        send_reply(clients[c].fd, IIRDSPD_OP_OPEN, 0, IIRDSPD_EINVAL, -1);
+        return;
+    }
+    for (id = 0; id < (uint32_t)max_streams && streams[id].in_use; id++) {
+    }
+    if (id == (uint32_t)max_streams) {
+        send_reply(clients[c].fd, IIRDSPD_OP_OPEN, 0, IIRDSPD_EFULL, -1);
+        return;
+    }
+    if (iirdsp_spec_design(&req->spec, &f) != 0) {
+        send_reply(clients[c].fd, IIRDSPD_OP_OPEN, 0, IIRDSPD_EDESIGN, -1);
+        return;
+    }
+    /* Identical coefficients come back as the same, shared set */
+    set = iirdsp_engine_add_coeffs(engine, &f);
+    if (set < 0) {
+        send_reply(clients[c].fd, IIRDSPD_OP_OPEN, 0, IIRDSPD_EFULL, -1);
+        return;
+    }
+
+    s = &streams[id];
+    memset(s, 0, sizeof(*s));
+    s->slots = req->slots;
+    s->slot_samples = req->slot_samples;
+    s->counts = (uint32_t*)calloc(s->slots, sizeof(uint32_t));
+    s->ring = s->counts != NULL ? create_ring(s->slots, s->slot_samples, &s->ring_bytes, &fd) : NULL;
+    if (s->ring == NULL) {
+        status = IIRDSPD_ENOMEM;
+    } else if (iirdsp_engine_open(engine, id, set) != 0) {
+        status = IIRDSPD_EFULL;
+    }
+    /* An open stream holds its own reference on the set */
+    iirdsp_engine_release_coeffs(engine, set);
+    if (status != 0) {
+        if (s->ring != NULL) {
+            munmap(s->ring, s->ring_bytes);
+            close(fd);
+        }
+        free(s->counts);
+        send_reply(clients[c].fd, IIRDSPD_OP_OPEN, 0, status, -1);
+        return;
+    }
+    s->ctl = iirdspd_ring_slot(s->ring, 0);
+    s->samples = iirdspd_ring_samples(s->ring, s->slots, s->slot_samples, 0);
+    s->in_use = 1;
+    s->client = c;
+    send_reply(clients[c].fd, IIRDSPD_OP_OPEN, id, 0, fd);
+    close(fd);
+}
+
+static void drop_client(int c)
+{
+    for (int id = 0; id < max_streams; id++) {
+        if (streams[id].in_use && streams[id].client == c) {
+            close_stream((uint32_t)id);
+        }
+    }
+    close(clients[c].fd);
+    clients[c].fd = -1;
+}
+
+static void handle_client(int c)
+{
+    iirdspd_request_t req;
+    ssize_t n;
+
+    while ((n = recv(clients[c].fd, &req, sizeof(req), MSG_DONTWAIT)) > 0) {
+        if ((size_t)n != sizeof(req)) {
+            continue;
+        }
+        switch (req.op) {
+        case IIRDSPD_OP_OPEN:
+            open_stream(c, &req);
+            break;
+        case IIRDSPD_OP_CLOSE:
+            if (req.stream < (uint32_t)max_streams && streams[req.stream].in_use &&
+                streams[req.stream].client == c) {
+                close_stream(req.stream);
+                send_reply(clients[c].fd, IIRDSPD_OP_CLOSE, req.stream, 0, -1);
+            } else {
+                send_reply(clients[c].fd, IIRDSPD_OP_CLOSE, req.stream, IIRDSPD_EINVAL, -1);
+            }
+            break;
+        default:
+            break;  /* KICK only wakes the loop */
+        }
+    }
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        drop_client(c);
+    }
+}
+
+/**
+ * Move submitted blocks into the engine, run it, and wake waiting clients
+ *
+ * @return Number of blocks completed
+ */
+static long pump(void)
+{
+    long blocks = 0;
+
+    for (int id = 0; id < max_streams; id++) {
+        stream_t* s = &streams[id];
+
+        if (!s->in_use) {
+            continue;
+        }
+        for (;;) {
+            uint32_t i = s->next_ingest % s->slots;
+            iirdspd_slot_t* slot = &s->ctl[i];
+
+            if (s->next_ingest - s->next_deliver >= s->slots ||
+                __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != IIRDSPD_SLOT_SUBMITTED) {
+                break;
+            }
+            /* The sink delivers against this count, whatever the client
+               writes into the slot afterwards */
+            s->counts[i] = slot_count(s, slot);
+            if (iirdsp_engine_ingest(engine, (uint64_t)id, s->samples + (size_t)i * s->slot_samples,
+                                     (int)s->counts[i]) != 0) {
+                break;  /* Pending buffer full: the rest goes next pass */
+            }
+            s->next_ingest++;
+            blocks++;
+        }
+    }
+    if (blocks == 0) {
+        return 0;
+    }
+    iirdsp_engine_run(engine);
+
+    for (int id = 0; id < max_streams; id++) {
+        stream_t* s = &streams[id];
+
+        if (s->in_use && s->notify) {
+            s->notify = 0;
+            if (__atomic_exchange_n(&s->ring->client_waiting, 0, __ATOMIC_SEQ_CST)) {
+                send_reply(clients[s->client].fd, IIRDSPD_OP_DONE, (uint32_t)id, 0, -1);
+            }
+        }
+    }
+    return blocks;
+}
+
+/**
+ * Publish the idle flag, then check nothing slipped in before it was seen
+ *
+ * @return 1 if it is safe to sleep
+ */
+static int enter_idle(void)
+{
+    int idle = 1;
+
+    for (int id = 0; id < max_streams; id++) {
+        if (streams[id].in_use) {
+            __atomic_store_n(&streams[id].ring->daemon_idle, 1, __ATOMIC_SEQ_CST);
+        }
+    }
+    for (int id = 0; id < max_streams && idle; id++) {
+        stream_t* s = &streams[id];
+
+        if (s->in_use) {
+            iirdspd_slot_t* slot = &s->ctl[s->next_ingest % s->slots];
+            idle = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST) != IIRDSPD_SLOT_SUBMITTED;
+        }
+    }
+    return idle;
+}
+
+static void leave_idle(void)
+{
+    for (int id = 0; id < max_streams; id++) {
+        if (streams[id].in_use) {
+            __atomic_store_n(&streams[id].ring->daemon_idle, 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static int listen_on(const char* path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        close(fd);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 64) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = IIRDSPD_DEFAULT_SOCKET;
+    struct pollfd fds[MAX_CLIENTS + 1];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "S:n:p:")) != -1) {
+        switch (opt) {
+        case 'S':
+            path = optarg;
+            break;
+        case 'n':
+            max_streams = atoi(optarg);
+            break;
+        case 'p':
+            max_pending = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: iirdspd [-S socket] [-n max_streams] [-p max_pending]\n");
+            return 1;
+        }
+    }
+
+    streams = (stream_t*)calloc((size_t)(max_streams > 0 ? max_streams : 1), sizeof(stream_t));
+    engine = iirdsp_engine_create(max_streams, max_pending, sink, NULL);
+    listen_fd = listen_on(path);
+    if (streams == NULL || engine == NULL || listen_fd < 0) {
+        fprintf(stderr, "iirdspd: cannot start on %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    for (int c = 0; c < MAX_CLIENTS; c++) {
+        clients[c].fd = -1;
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    signal(SIGPIPE, SIG_IGN);
+    printf("iirdspd: listening on %s (%d streams, %d pending samples, %s samples)\n",
+           path, max_streams, max_pending, sizeof(iirdsp_real) == 4 ? "float" : "double");
+    fflush(stdout);
+
+    while (!stop) {
+        int nfds = 0;
+        int timeout = 0;
+        int ready;
+
+        /* Keep pumping while clients keep the rings busy */
+        if (pump() == 0) {
+            if (enter_idle()) {
+                timeout = -1;
+            } else {
+                leave_idle();
+            }
+        }
+
+        fds[nfds].fd = listen_fd;
+        fds[nfds].events = POLLIN;
+        nfds++;
+        for (int c = 0; c < MAX_CLIENTS; c++) {
+            if (clients[c].fd >= 0) {
+                fds[nfds].fd = clients[c].fd;
+                fds[nfds].events = POLLIN;
+                nfds++;
+            }
+        }
+        ready = poll(fds, (nfds_t)nfds, timeout);
+        if (timeout < 0) {
+            leave_idle();
+        }
+        if (ready <= 0) {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+            int c;
+
+            for (c = 0; c < MAX_CLIENTS && clients[c].fd >= 0; c++) {
+            }
+            if (fd >= 0 && c < MAX_CLIENTS) {
+                clients[c].fd = fd;
+            } else if (fd >= 0) {
+                close(fd);
+            }
+        }
+        for (int c = 0; c < MAX_CLIENTS; c++) {
+            for (int k = 1; k < nfds; k++) {
+                if (clients[c].fd >= 0 && fds[k].fd == clients[c].fd && fds[k].revents != 0) {
+                    handle_client(c);
+                    break;
+                }
+            }
+        }
+    }
+
+    {
+        iirdsp_engine_stats_t st;
+
+        iirdsp_engine_get_stats(engine, &st);
+        printf("iirdspd: %ld runs, %ld blocks, %ld lane samples, %ld scalar samples\n",
+               st.runs, st.packets, st.lane_samples, st.scalar_samples);
+    }
+    for (int c = 0; c < MAX_CLIENTS; c++) {
+        if (clients[c].fd >= 0) {
+            drop_client(c);
+        }
+    }
+    close(listen_fd);
+    unlink(path);
+    iirdsp_engine_destroy(engine);
+    free(streams);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file iirdspd.h
+ * @brief Wire protocol of the iirdspd filtering daemon
+ *
+ * Control: a SOCK_SEQPACKET Unix socket carrying fixed-size messages.
+ * Data: one shared-memory ring per stream, created by the daemon and
+ * passed to the client as a file descriptor (SCM_RIGHTS) in the reply to
+ * IIRDSPD_OP_OPEN. Samples never cross the socket, but they are not
+ * filtered in the ring either: the daemon copies each submitted block
+ * into the engine's per-stream buffer, where it is batched with other
+ * streams' blocks, and copies the output back into the same slot.
+ *
+ * Ring layout (all offsets from the start of the mapping):
+ *   iirdspd_ring_t header              64 bytes
+ *   iirdspd_slot_t slot[slots]         64 bytes each
+ *   sample[slots][slot_samples]        sample_size bytes each
+ *
+ * Every slot cycles FREE -> SUBMITTED (client filled it) -> DONE (daemon
+ * wrote the output over the input) -> FREE (client consumed it). Both sides walk the
+ * slots in order, so a stream's blocks are filtered in submission order
+ * and the filter state carries across them. State words are accessed
+ * with acquire/release semantics.
+ *
+ * Wakeups: after submitting, a client sends IIRDSPD_OP_KICK only if the
+ * ring's daemon_idle flag is set. A client that wants to sleep until a
+ * block is done sets client_waiting, re-checks the slot, and then blocks
+ * on the socket; the daemon clears the flag and sends an IIRDSPD_OP_DONE
+ * reply. Busy peers therefore exchange no system calls at all.
+ *
+ * The layout is plain C with fixed-width fields so clients in other
+ * languages can implement it; sample_size tells them whether the daemon
+ * was built for float (4) or double (8) samples.
+ *
+ * The ring is a sealed memfd: it cannot be resized. The daemon keeps the
+ * geometry from the OPEN request and ignores the header's slots and
+ * slot_samples, and it reads a slot's count once, when it takes the
+ * block, clamping it to 1..slot_samples.
+ */
+
+#ifndef IIRDSPD_H
+#define IIRDSPD_H
+
+#include <stdint.h>
+#include "registry.h"
+
+#define IIRDSPD_DEFAULT_SOCKET "/tmp/iirdspd.sock"
+#define IIRDSPD_RING_MAGIC 0x676e6972u  /* "ring" */
+#define IIRDSPD_VERSION 1
+
+/**
+ * Message operations
+ */
+enum {
+    IIRDSPD_OP_OPEN = 1,   /* Client: open a stream; reply carries the ring fd */
+    IIRDSPD_OP_KICK = 2,   /* Client: slots submitted; no reply */
+    IIRDSPD_OP_CLOSE = 3,  /* Client: close a stream */
+    IIRDSPD_OP_DONE = 4    /* Daemon: a waiting client's ring has DONE slots */
+};
+
+/**
+ * Slot states
+ */
+enum {
+    IIRDSPD_SLOT_FREE = 0,
+    IIRDSPD_SLOT_SUBMITTED = 1,
+    IIRDSPD_SLOT_DONE = 2
+};
+
+/**
+ * Client-to-daemon message
+ */
+typedef struct {
+    uint32_t op;
+    uint32_t stream;          /* KICK, CLOSE */
+    uint32_t slots;           /* OPEN: ring slots */
+    uint32_t slot_samples;    /* OPEN: capacity of one slot */
+    iirdsp_spec_t spec;       /* OPEN: filter to run */
+} iirdspd_request_t;
+
+/**
+ * Daemon-to-client message
+ */
+typedef struct {
+    uint32_t op;              /* Request being answered, or IIRDSPD_OP_DONE */
+    uint32_t stream;
+    int32_t status;           /* 0, or a negative IIRDSPD_E* code */
+    uint32_t reserved;
+} iirdspd_reply_t;
+
+/**
+ * Error codes in iirdspd_reply_t.status
+ */
+enum {
+    IIRDSPD_EINVAL = -1,      /* Malformed request or bad ring geometry */
+    IIRDSPD_EDESIGN = -2,     /* The spec could not be designed */
+    IIRDSPD_EFULL = -3,       /* Daemon stream or coefficient limit reached */
+    IIRDSPD_ENOMEM = -4       /* Ring allocation failed */
+};
+
+/**
+ * Ring header
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slot_samples;
+    uint32_t sample_size;
+    uint32_t daemon_idle;     /* Set while the daemon sleeps in poll() */
+    uint32_t client_waiting;  /* Set while the client sleeps on the socket */
+    uint32_t reserved[9];
+} iirdspd_ring_t;
+
+/**
+ * Slot control word, one cache line
+ */
+typedef struct {
+    uint32_t state;
+    uint32_t count;           /* Samples in the block */
+    uint32_t reserved[14];
+} iirdspd_slot_t;
+
+/**
+ * Bytes of a ring mapping
+ */
+static inline size_t iirdspd_ring_bytes(uint32_t slots, uint32_t slot_samples)
+{
+    return sizeof(iirdspd_ring_t) + (size_t)slots * sizeof(iirdspd_slot_t) +
+           (size_t)slots * slot_samples * sizeof(iirdsp_real);
+}
+
+static inline iirdspd_slot_t* iirdspd_ring_slot(iirdspd_ring_t* r, uint32_t i)
+{
+    return (iirdspd_slot_t*)(r + 1) + i;
+}
+
+/**
+ * Samples of slot i
+ *
+ * The geometry is passed in rather than read from the header, which the
+ * other side of the ring can write.
+ */
+static inline iirdsp_real* iirdspd_ring_samples(iirdspd_ring_t* r, uint32_t slots, uint32_t slot_samples, uint32_t i)
+{
+    iirdsp_real* base = (iirdsp_real*)(iirdspd_ring_slot(r, slots));
+    return base + (size_t)i * slot_samples;
+}
+
+#endif /* IIRDSPD_H */